@@ -0,0 +1,49 @@
+#include "Aleatorio.h"
+
+// Multiplicador del LCG de PCG32 (O'Neill, 2014)
+static const Aleatorio::Semilla MULTIPLICADOR = 6364136223846793005ULL;
+
+Aleatorio::Aleatorio(Semilla semilla, Semilla flujo)
+{
+	// El incremento tiene que ser impar; cada valor es un flujo distinto
+	estado = 0;
+	incremento = (flujo << 1) | 1;
+	Siguiente();
+	estado += semilla;
+	Siguiente();
+}
+
+unsigned int
+Aleatorio::Siguiente()
+{
+	Semilla anterior = estado;
+	estado = anterior * MULTIPLICADOR + incremento;
+
+	unsigned int xorDesplazado = (unsigned int)(((anterior >> 18) ^ anterior) >> 27);
+	unsigned int rotacion = (unsigned int)(anterior >> 59);
+	return (xorDesplazado >> rotacion) | (xorDesplazado << ((32 - rotacion) & 31));
+}
+
+void
+Aleatorio::Avanzar(Semilla n)
+{
+	// Componemos la transformacion afin estado*m + c consigo misma
+	// elevando al cuadrado (Brown, "Random number generation with arbitrary
+	// strides", 1994)
+	Semilla m = MULTIPLICADOR;
+	Semilla c = incremento;
+	Semilla mAcumulado = 1;
+	Semilla cAcumulado = 0;
+	while ( n > 0 )
+	{
+		if ( n & 1 )
+		{
+			mAcumulado *= m;
+			cAcumulado = cAcumulado * m + c;
+		}
+		c = (m + 1) * c;
+		m *= m;
+		n >>= 1;
+	}
+	estado = mAcumulado * estado + cAcumulado;
+}
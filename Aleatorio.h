@@ -0,0 +1,58 @@
+#pragma once
+
+// Generador de numeros aleatorios con estado propio (PCG32, XSH-RR).
+//
+// Sustituye a rand(): cada generador de contenido recibe su propio Aleatorio,
+// asi que un terreno o un sistema se reproduce a partir de su semilla de 64
+// bits y varios generadores pueden trabajar a la vez en hilos distintos.
+// Con la misma semilla, cada flujo da una secuencia independiente.
+class Aleatorio
+{
+public:
+	typedef unsigned long long Semilla;
+
+private:
+	Semilla estado;
+	Semilla incremento;
+
+public:
+	Aleatorio(Semilla semilla = 0, Semilla flujo = 0);
+
+	// Siguiente entero de 32 bits
+	unsigned int Siguiente();
+
+	// Entero en [0, n), n > 0. Sustituye a rand()%n
+	int Entero(int n)
+	{
+		return (int)(((Semilla)Siguiente() * (unsigned int)n) >> 32);
+	}
+
+	// Real en [0, 1)
+	float Real()
+	{
+		return (Siguiente() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Estado completo, para identificar la secuencia (claves de cache)
+	Semilla GetEstado() const
+	{
+		return estado;
+	}
+
+	Semilla GetIncremento() const
+	{
+		return incremento;
+	}
+
+	// Vuelve a un estado de GetEstado() de la misma secuencia (al sacar de
+	// la cache lo que se genero con este Aleatorio, para acabar igual que
+	// si se hubiera generado)
+	void SetEstado(Semilla e)
+	{
+		estado = e;
+	}
+
+	// Salta n numeros de la secuencia en O(log n), como si se hubiera
+	// llamado n veces a Siguiente()
+	void Avanzar(Semilla n);
+};
@@ -0,0 +1,137 @@
+#include "ArchivoMapeado.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+ArchivoMapeado::ArchivoMapeado(void) : datos(NULL), tamano(0)
+{
+#ifdef _WIN32
+	fichero = INVALID_HANDLE_VALUE;
+	proyeccion = NULL;
+#else
+	fichero = -1;
+#endif
+}
+
+ArchivoMapeado::~ArchivoMapeado(void)
+{
+	Cerrar();
+}
+
+#ifdef _WIN32
+
+bool
+ArchivoMapeado::Abrir(const char *nombre, bool soloLectura)
+{
+	Cerrar();
+
+	fichero = CreateFileA(nombre, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if ( fichero == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	LARGE_INTEGER bytes;
+	if ( !GetFileSizeEx(fichero, &bytes) || bytes.QuadPart == 0 )
+	{
+		Cerrar();
+		return false;
+	}
+	tamano = (size_t)bytes.QuadPart;
+
+	// Con PAGE_WRITECOPY + FILE_MAP_COPY las escrituras van a paginas privadas
+	proyeccion = CreateFileMappingA(fichero, NULL, soloLectura ? PAGE_READONLY : PAGE_WRITECOPY, 0, 0, NULL);
+	if ( proyeccion == NULL )
+	{
+		Cerrar();
+		return false;
+	}
+
+	datos = MapViewOfFile(proyeccion, soloLectura ? FILE_MAP_READ : FILE_MAP_COPY, 0, 0, 0);
+	if ( datos == NULL )
+	{
+		Cerrar();
+		return false;
+	}
+	return true;
+}
+
+void
+ArchivoMapeado::Cerrar()
+{
+	if ( datos != NULL )
+	{
+		UnmapViewOfFile(datos);
+		datos = NULL;
+	}
+	if ( proyeccion != NULL )
+	{
+		CloseHandle(proyeccion);
+		proyeccion = NULL;
+	}
+	if ( fichero != INVALID_HANDLE_VALUE )
+	{
+		CloseHandle(fichero);
+		fichero = INVALID_HANDLE_VALUE;
+	}
+	tamano = 0;
+}
+
+#else
+
+bool
+ArchivoMapeado::Abrir(const char *nombre, bool soloLectura)
+{
+	Cerrar();
+
+	fichero = open(nombre, O_RDONLY);
+	if ( fichero < 0 )
+	{
+		return false;
+	}
+
+	struct stat info;
+	if ( fstat(fichero, &info) != 0 || info.st_size == 0 )
+	{
+		Cerrar();
+		return false;
+	}
+	tamano = (size_t)info.st_size;
+
+	// Con MAP_PRIVATE las escrituras van a paginas privadas
+	void *p = soloLectura ?
+		mmap(NULL, tamano, PROT_READ, MAP_SHARED, fichero, 0) :
+		mmap(NULL, tamano, PROT_READ | PROT_WRITE, MAP_PRIVATE, fichero, 0);
+	if ( p == MAP_FAILED )
+	{
+		Cerrar();
+		return false;
+	}
+	datos = p;
+	return true;
+}
+
+void
+ArchivoMapeado::Cerrar()
+{
+	if ( datos != NULL )
+	{
+		munmap(datos, tamano);
+		datos = NULL;
+	}
+	if ( fichero >= 0 )
+	{
+		close(fichero);
+		fichero = -1;
+	}
+	tamano = 0;
+}
+
+#endif
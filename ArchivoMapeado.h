@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+
+// Fichero proyectado en memoria. Por defecto se abre en modo copia al
+// escribir: se puede modificar lo mapeado (por ejemplo el color de los
+// vertices) sin tocar el fichero en disco, y las paginas que no se escriben
+// se comparten con la cache del sistema. Los ficheros muy grandes conviene
+// abrirlos de solo lectura, que no reserva memoria para las copias.
+class ArchivoMapeado
+{
+private:
+	void *datos;
+	size_t tamano;
+
+#ifdef _WIN32
+	void *fichero;
+	void *proyeccion;
+#else
+	int fichero;
+#endif
+
+	// No se copia
+	ArchivoMapeado(const ArchivoMapeado &);
+	ArchivoMapeado &operator=(const ArchivoMapeado &);
+
+public:
+	ArchivoMapeado(void);
+	virtual ~ArchivoMapeado(void);
+
+	// Proyecta el fichero entero. Devuelve false si no existe o esta vacio
+	bool Abrir(const char *nombre, bool soloLectura = false);
+	void Cerrar();
+
+	void *GetDatos()
+	{
+		return datos;
+	}
+
+	size_t GetTamano() const
+	{
+		return tamano;
+	}
+};
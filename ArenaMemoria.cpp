@@ -0,0 +1,102 @@
+#include "ArenaMemoria.h"
+
+#include <stdint.h>
+
+const size_t ArenaMemoria::CABECERA = (sizeof(ArenaMemoria::Bloque) + 15) & ~(size_t)15;
+
+// Bytes que hay que saltar desde p para alinearlo
+static size_t
+Relleno(const char *p, size_t alineacion)
+{
+	return (size_t)(0 - (uintptr_t)p) & (alineacion-1);
+}
+
+ArenaMemoria::ArenaMemoria(size_t tamBloque) : bloque(NULL), tamBloque(tamBloque),
+	bytesReservados(0), numReservas(0), bytesSistema(0), numReservasSistema(0)
+{
+}
+
+ArenaMemoria::~ArenaMemoria(void)
+{
+	LiberarBloques();
+}
+
+ArenaMemoria::Bloque *
+ArenaMemoria::NuevoBloque(size_t tamano)
+{
+	Bloque *b = (Bloque *)new char[CABECERA + tamano];
+	b->anterior = NULL;
+	b->tamano = tamano;
+	b->usado = 0;
+
+	bytesSistema += CABECERA + tamano;
+	numReservasSistema++;
+	return b;
+}
+
+void
+ArenaMemoria::LiberarBloques()
+{
+	while ( bloque != NULL )
+	{
+		Bloque *anterior = bloque->anterior;
+		delete [] (char *)bloque;
+		bloque = anterior;
+	}
+}
+
+void *
+ArenaMemoria::Reservar(size_t bytes, size_t alineacion)
+{
+	bytesReservados += bytes;
+	numReservas++;
+
+	if ( bloque != NULL )
+	{
+		char *datos = (char *)bloque + CABECERA;
+		size_t inicio = bloque->usado + Relleno(datos + bloque->usado, alineacion);
+		if ( inicio + bytes <= bloque->tamano )
+		{
+			bloque->usado = inicio + bytes;
+			return datos + inicio;
+		}
+	}
+
+	// No cabe: bloque nuevo, con sitio para la alineacion
+	size_t tamano = bytes + alineacion;
+	if ( tamano < tamBloque )
+	{
+		tamano = tamBloque;
+	}
+	Bloque *b = NuevoBloque(tamano);
+	b->anterior = bloque;
+	bloque = b;
+
+	char *datos = (char *)b + CABECERA;
+	size_t inicio = Relleno(datos, alineacion);
+	b->usado = inicio + bytes;
+	return datos + inicio;
+}
+
+void
+ArenaMemoria::Vaciar()
+{
+	if ( bloque != NULL && bloque->anterior != NULL )
+	{
+		// Un solo bloque con sitio para todo lo que habia
+		size_t total = 0;
+		for ( Bloque *b = bloque ; b != NULL ; b = b->anterior )
+		{
+			total += b->tamano;
+		}
+		LiberarBloques();
+		bloque = NuevoBloque(total);
+	}
+	else if ( bloque != NULL )
+	{
+		bloque->usado = 0;
+	}
+
+	bytesReservados = 0;
+	numReservas = 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+
+// Memoria por avance de puntero para datos temporales con la misma vida
+// (por ejemplo todo lo que hace falta para generar un planeta). Reservar solo
+// avanza un puntero dentro de un bloque; nada se libera por separado, sino
+// todo junto con Vaciar o al destruir la arena.
+//
+// Vaciar conserva la memoria: si hicieron falta varios bloques se sustituyen
+// por uno solo del tamano total, asi que generar lo mismo otra vez no vuelve
+// a pedir memoria al sistema.
+class ArenaMemoria
+{
+private:
+	struct Bloque
+	{
+		Bloque *anterior;
+		size_t tamano;
+		size_t usado;
+	};
+
+	// Los datos de cada bloque empiezan tras la cabecera
+	static const size_t CABECERA;
+
+	Bloque *bloque;
+	size_t tamBloque;
+
+	// Estadisticas desde el ultimo Vaciar
+	size_t bytesReservados;
+	int numReservas;
+
+	// Estadisticas desde que se creo la arena
+	size_t bytesSistema;
+	int numReservasSistema;
+
+	Bloque *NuevoBloque(size_t tamano);
+	void LiberarBloques();
+
+	// No se copia
+	ArenaMemoria(const ArenaMemoria &);
+	ArenaMemoria &operator=(const ArenaMemoria &);
+
+public:
+	// tamBloque: tamano minimo de cada bloque pedido al sistema
+	ArenaMemoria(size_t tamBloque = 64*1024);
+	virtual ~ArenaMemoria(void);
+
+	// bytes sin inicializar, alineados a alineacion (potencia de 2)
+	void *Reservar(size_t bytes, size_t alineacion = 16);
+
+	template<class T>
+	T *Reservar(size_t n)
+	{
+		return (T *)Reservar(n*sizeof(T));
+	}
+
+	// Da por liberado todo lo reservado
+	void Vaciar();
+
+	// Bytes y reservas pedidos a la arena desde el ultimo Vaciar
+	size_t GetBytesReservados() const
+	{
+		return bytesReservados;
+	}
+
+	int GetNumReservas() const
+	{
+		return numReservas;
+	}
+
+	// Bytes y bloques pedidos al sistema en total
+	size_t GetBytesSistema() const
+	{
+		return bytesSistema;
+	}
+
+	int GetNumReservasSistema() const
+	{
+		return numReservasSistema;
+	}
+};
@@ -10,6 +10,7 @@ AtmosferaNode::AtmosferaNode(scene::ISceneNode *parent, scene::ISceneManager *mg
 		this->setScale(core::vector3df(1.3f,1.3f,1.3f));
 
 		color = video::SColor(0,0,0,0);
+		colorAnterior = color;
 		dcolor = color;
 
 		material.AmbientColor = video::SColor::SColor(255,255,0,0);
@@ -33,86 +34,13 @@ AtmosferaNode::AtmosferaNode(scene::ISceneNode *parent, scene::ISceneManager *mg
 		material.Textures[0] = Juego::GetInstance()->GetVideoDriver()->getTexture("data/aire.jpg");
 		//material.Textures[0] = Juego::GetInstance()->GetVideoDriver()->getTexture("water.jpg");
 
-		NUM_VERTICES = (NUM_MERIDIANOS+1)*(NUM_PARALELOS+1);
-		NUM_INDICES = NUM_MERIDIANOS*NUM_PARALELOS*2*3;
-
-
-
-		float PI = 3.141592f;
-		float EPSILON = 0.001f;
-
-		// Generamos los vrtices
-		vertices = new video::S3DVertex[NUM_VERTICES];
-		int nv = 0;
-		int m=0,p=0;
-		for (float theta = 0.0f ; theta < 2*PI + EPSILON ; theta += (2*PI) / NUM_MERIDIANOS )
-		{
-			p=0;
-			for (float phi = -PI/2; phi < PI/2 + EPSILON; phi += (PI) / NUM_PARALELOS )
-			{
-				vertices[nv] = video::S3DVertex(cos(phi)*cos(theta), sin(phi), cos(phi)*sin(theta), cos(phi)*cos(theta), sin(phi), cos(phi)*sin(theta), video::SColor(0,255,255,255), theta/(2*PI) , phi/PI);
-				nv++;
-				p++;
-			}
-			m++;
-		}
-
-		// Generamos los triangulos
-		indices = new u16[NUM_INDICES];
-		int nTrig = 0 ;
-		for ( int p = 0 ; p < NUM_PARALELOS ; p++ )
-		{
-			for ( int m = 0 ; m < NUM_MERIDIANOS ; m++ )
-			{
-				indices[nTrig*3+0] = m*(NUM_PARALELOS+1) + p ;
-				indices[nTrig*3+1] = m*(NUM_PARALELOS+1) + ((p+1));
-				indices[nTrig*3+2] = ((m+1))*(NUM_PARALELOS+1) + p ;
-				
-				
-				nTrig++;
-
-				indices[nTrig*3+0] = m*(NUM_PARALELOS+1) + ((p+1));
-				indices[nTrig*3+1] = ((m+1))*(NUM_PARALELOS+1) + ((p+1)) ;
-				indices[nTrig*3+2] = ((m+1))*(NUM_PARALELOS+1) + p ;
-				nTrig++;
-			}
-		}
-
-		/*
-		// Para cada triangulo
-		for ( int trig = 0 ; trig < nTrig ; trig++ )
-		{
-			core::triangle3df t = core::triangle3df();
-			t.set(vertices[ indices[trig*3+0] ].Pos,
-				vertices[ indices[trig*3+1] ].Pos,
-				vertices[ indices[trig*3+2] ].Pos);
-
-			// Obtenemos la normal
-			core::vector3df normal = t.getNormal();
-
-			// Sumamos la normal a cada vertice
-			vertices[ indices[trig*3+0] ].Normal += normal ;
-			vertices[ indices[trig*3+1] ].Normal += normal ;
-			vertices[ indices[trig*3+2] ].Normal += normal ;
-		}
-
-		// Normalizamos las normales
-		for ( int i = 0 ; i < NUM_MERIDIANOS*(NUM_PARALELOS+1) ; i++ )
-		{
-			vertices[i].Normal.normalize();
-		}
-		*/
-
-		// Calculamos el bounding box
-		box.reset(vertices[0].Pos);
-		for (s32 i=1; i<NUM_VERTICES; ++i)
-		{
-			box.addInternalPoint(vertices[i].Pos);
-		}
+		// La esfera es la misma para todos los nodos de esta clase
+		malla = MallaEsfera::Obtener(NUM_MERIDIANOS, NUM_PARALELOS, MallaEsfera::UV_NORMALIZADAS, video::SColor(0,255,255,255));
 	}
 
 AtmosferaNode::~AtmosferaNode(void)
 {
+	malla->drop();
 }
 
 void 
@@ -123,6 +51,14 @@ AtmosferaNode::OnPreRender()
 		SceneManager->registerNodeForRendering(this);
 	}
 
+	ISceneNode::OnPreRender();
+}
+
+void
+AtmosferaNode::Actualizar()
+{
+	colorAnterior = color;
+
 	int inc = 1;
 	if ( dcolor.getBlue() != color.getBlue() )
 	{
@@ -172,9 +108,12 @@ AtmosferaNode::OnPreRender()
 		color.setGreen(c);
 	}
 
-	material.EmissiveColor = color ;
+}
 
-	ISceneNode::OnPreRender();
+void
+AtmosferaNode::Interpolar(float alpha)
+{
+	material.EmissiveColor = color.getInterpolated(colorAnterior, alpha);
 }
 
 void 
@@ -183,5 +122,5 @@ AtmosferaNode::render()
 	video::IVideoDriver* driver = SceneManager->getVideoDriver();
 	driver->setMaterial(material);
 	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
-	driver->drawIndexedTriangleList(&vertices[0], NUM_VERTICES, &indices[0], NUM_INDICES/3);
+	malla->Dibujar(driver);
 }
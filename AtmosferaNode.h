@@ -1,23 +1,22 @@
 #pragma once
 #include <irrlicht.h>
 
+#include "MallaEsfera.h"
+
 using namespace irr;
 
 class AtmosferaNode :
 	public irr::scene::ISceneNode
 {
 private:
-	irr::core::aabbox3d<irr::f32> box;
-	irr::video::S3DVertex *vertices;
+	MallaEsfera *malla;
 	irr::video::SMaterial material;
-	irr::u16 *indices ;
 	irr::video::SColor color;
+	irr::video::SColor colorAnterior;
 	irr::video::SColor dcolor;
 
 	static const int NUM_PARALELOS = 15;
 	static const int NUM_MERIDIANOS = 30;
-	int NUM_VERTICES;
-	int NUM_INDICES;
 
 public:
 	AtmosferaNode(irr::scene::ISceneNode* parent, irr::scene::ISceneManager* mgr, irr::s32 id);
@@ -26,9 +25,13 @@ public:
 	virtual void OnPreRender();
 	virtual void render();
 
+	// Un paso de la simulacion: el color se acerca al deseado
+	void Actualizar();
+	void Interpolar(float alpha);
+
 	virtual const irr::core::aabbox3d<irr::f32>& getBoundingBox() const
 	{
-		return box;
+		return malla->GetBoundingBox();
 	}
 
 	virtual irr::s32 getMaterialCount()
@@ -54,6 +57,7 @@ public:
 	void SetColor(video::SColor c)
 	{
 		color = c ;
+		colorAnterior = c ;
 	}
 
 	void SetDesColor(video::SColor c)
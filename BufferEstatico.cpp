@@ -0,0 +1,181 @@
+#include "BufferEstatico.h"
+
+#if defined(_WIN32) && defined(_IRR_COMPILE_WITH_DIRECT3D_9_)
+#define BUFFER_D3D9
+#include <d3d9.h>
+#endif
+
+#include <string.h>
+using namespace irr;
+
+bool BufferEstatico::activo = true;
+int BufferEstatico::subidas = 0;
+int BufferEstatico::bytesSubidos = 0;
+
+BufferEstatico::BufferEstatico(void) : vb(NULL), ib(NULL), capacidadVertices(0), capacidadIndices(0),
+	vertices(NULL), indices(NULL), numVertices(0), numIndices(0), verticesCambiados(true), indicesCambiados(true)
+{
+}
+
+BufferEstatico::~BufferEstatico(void)
+{
+	Liberar();
+}
+
+void
+BufferEstatico::Liberar()
+{
+#ifdef BUFFER_D3D9
+	if ( vb )
+	{
+		vb->Release();
+	}
+	if ( ib )
+	{
+		ib->Release();
+	}
+#endif
+	vb = NULL;
+	ib = NULL;
+	capacidadVertices = 0;
+	capacidadIndices = 0;
+	verticesCambiados = true;
+	indicesCambiados = true;
+}
+
+bool
+BufferEstatico::SubirVertices(void *dispositivo)
+{
+#ifdef BUFFER_D3D9
+	IDirect3DDevice9 *dev = (IDirect3DDevice9 *)dispositivo;
+	UINT bytes = numVertices*sizeof(video::S3DVertex);
+
+	// Solo se crea otro si no caben
+	if ( numVertices > capacidadVertices )
+	{
+		if ( vb )
+		{
+			vb->Release();
+			vb = NULL;
+		}
+		capacidadVertices = 0;
+		if ( FAILED(dev->CreateVertexBuffer(bytes, D3DUSAGE_WRITEONLY, 0, D3DPOOL_MANAGED, &vb, NULL)) )
+		{
+			vb = NULL;
+			return false;
+		}
+		capacidadVertices = numVertices;
+	}
+
+	void *datos;
+	if ( FAILED(vb->Lock(0, bytes, &datos, 0)) )
+	{
+		return false;
+	}
+	memcpy(datos, vertices, bytes);
+	vb->Unlock();
+
+	subidas++;
+	bytesSubidos += bytes;
+	verticesCambiados = false;
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool
+BufferEstatico::SubirIndices(void *dispositivo)
+{
+#ifdef BUFFER_D3D9
+	IDirect3DDevice9 *dev = (IDirect3DDevice9 *)dispositivo;
+	UINT bytes = numIndices*sizeof(u16);
+
+	if ( numIndices > capacidadIndices )
+	{
+		if ( ib )
+		{
+			ib->Release();
+			ib = NULL;
+		}
+		capacidadIndices = 0;
+		if ( FAILED(dev->CreateIndexBuffer(bytes, D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_MANAGED, &ib, NULL)) )
+		{
+			ib = NULL;
+			return false;
+		}
+		capacidadIndices = numIndices;
+	}
+
+	void *datos;
+	if ( FAILED(ib->Lock(0, bytes, &datos, 0)) )
+	{
+		return false;
+	}
+	memcpy(datos, indices, bytes);
+	ib->Unlock();
+
+	subidas++;
+	bytesSubidos += bytes;
+	indicesCambiados = false;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void
+BufferEstatico::Dibujar(video::IVideoDriver *driver, const video::S3DVertex *v, int nv, const u16 *ind, int numTriangulos)
+{
+	if ( nv <= 0 || numTriangulos <= 0 )
+	{
+		return;
+	}
+
+#ifdef BUFFER_D3D9
+	IDirect3DDevice9 *dev = NULL;
+	if ( activo && driver->getDriverType() == video::EDT_DIRECT3D9 )
+	{
+		dev = driver->getExposedVideoData().D3D9.D3DDev9;
+	}
+
+	if ( dev )
+	{
+		// Otros arrays son otra malla
+		if ( v != vertices || nv != numVertices )
+		{
+			vertices = v;
+			numVertices = nv;
+			verticesCambiados = true;
+		}
+		if ( ind != indices || numTriangulos*3 != numIndices )
+		{
+			indices = ind;
+			numIndices = numTriangulos*3;
+			indicesCambiados = true;
+		}
+
+		bool listo = (!verticesCambiados || SubirVertices(dev)) && (!indicesCambiados || SubirIndices(dev));
+		if ( listo )
+		{
+			// Irrlicht aplica el material y el formato de vertice (el de
+			// S3DVertex) al dibujar; un triangulo degenerado de un solo
+			// vertice lo hace sin pintar nada
+			static const u16 degenerado[3] = {0, 0, 0};
+			driver->drawIndexedTriangleList(v, 1, degenerado, 1);
+
+			dev->SetStreamSource(0, vb, 0, sizeof(video::S3DVertex));
+			dev->SetIndices(ib);
+			dev->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, nv, 0, numTriangulos);
+
+			// Irrlicht dibuja con DrawIndexedPrimitiveUP, que no espera
+			// buffers puestos
+			dev->SetStreamSource(0, NULL, 0, 0);
+			dev->SetIndices(NULL);
+			return;
+		}
+	}
+#endif
+
+	driver->drawIndexedTriangleList(v, nv, ind, numTriangulos);
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <irrlicht.h>
+
+struct IDirect3DVertexBuffer9;
+struct IDirect3DIndexBuffer9;
+
+// Copia en la tarjeta de unos vertices e indices que casi nunca cambian.
+// Dibujar manda la malla desde los buffers del driver en lugar de volver a
+// enviar los arrays en cada frame; los arrays siguen siendo del llamante y
+// solo se vuelven a subir cuando se marcan como cambiados (o si se pasan
+// otros arrays u otro numero de vertices).
+//
+// Irrlicht 1.2 no tiene buffers hardware, asi que se crean directamente
+// con el dispositivo de Direct3D 9 que expone el driver. Con otro driver, o
+// compilado sin Direct3D 9, Dibujar hace lo de siempre:
+// drawIndexedTriangleList con los arrays.
+class BufferEstatico
+{
+private:
+	IDirect3DVertexBuffer9 *vb;
+	IDirect3DIndexBuffer9 *ib;
+	int capacidadVertices;
+	int capacidadIndices;
+
+	// Lo ultimo que se subio
+	const irr::video::S3DVertex *vertices;
+	const irr::u16 *indices;
+	int numVertices;
+	int numIndices;
+
+	bool verticesCambiados;
+	bool indicesCambiados;
+
+	static bool activo;
+	static int subidas;
+	static int bytesSubidos;
+
+	bool SubirVertices(void *dispositivo);
+	bool SubirIndices(void *dispositivo);
+
+	// No se copia
+	BufferEstatico(const BufferEstatico &);
+	BufferEstatico &operator=(const BufferEstatico &);
+
+public:
+	BufferEstatico(void);
+	virtual ~BufferEstatico(void);
+
+	// Dibuja numTriangulos triangulos de indices con el material y la
+	// transformacion puestos en el driver
+	void Dibujar(irr::video::IVideoDriver *driver, const irr::video::S3DVertex *vertices, int numVertices,
+		const irr::u16 *indices, int numTriangulos);
+
+	// Hay que volver a subir los vertices o los indices antes del siguiente
+	// Dibujar
+	void MarcarVertices()
+	{
+		verticesCambiados = true;
+	}
+
+	void MarcarIndices()
+	{
+		indicesCambiados = true;
+	}
+
+	// Libera los buffers de la tarjeta (se vuelven a crear al dibujar)
+	void Liberar();
+
+	// Con false todos los BufferEstatico dibujan con los arrays, para
+	// comparar
+	static void SetActivo(bool a)
+	{
+		activo = a;
+	}
+
+	static bool GetActivo()
+	{
+		return activo;
+	}
+
+	// Subidas a la tarjeta y bytes subidos desde ReiniciarContadores
+	static int GetSubidas()
+	{
+		return subidas;
+	}
+
+	static int GetBytesSubidos()
+	{
+		return bytesSubidos;
+	}
+
+	static void ReiniciarContadores()
+	{
+		subidas = 0;
+		bytesSubidos = 0;
+	}
+};
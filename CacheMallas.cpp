@@ -0,0 +1,366 @@
+#include "CacheMallas.h"
+
+#include "Aleatorio.h"
+#include "ArchivoMapeado.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#include <sys/utime.h>
+#else
+#include <sys/stat.h>
+#include <dirent.h>
+#include <utime.h>
+#endif
+
+using namespace irr;
+
+// Formato del fichero (todo alineado a 4 bytes):
+//   CabeceraCache
+//   CabeceraMalla x numMallas
+//   vertices e indices de cada malla, en los desplazamientos de su cabecera
+struct CabeceraCache
+{
+	char magia[4];
+	u32 version;
+	ClaveCache::Valor clave;
+	Aleatorio::Semilla estadoAleatorio;
+	u32 numMallas;
+	u32 tamVertice;
+};
+
+struct CabeceraMalla
+{
+	u32 numVertices;
+	u32 numIndices;
+	u32 desplazamientoVertices;
+	u32 desplazamientoIndices;
+};
+
+static const char MAGIA[4] = { 'G', 'T', 'M', 'C' };
+
+static const ClaveCache::Valor FNV_BASE = 14695981039346656037ULL;
+static const ClaveCache::Valor FNV_PRIMO = 1099511628211ULL;
+
+static char directorioCache[512] = "cache";
+static bool cacheActiva = true;
+static size_t maximoBytes = CacheMallas::MAXIMO_BYTES;
+
+// Un fichero del directorio, para Recortar
+struct EntradaDirectorio
+{
+	std::string nombre;
+	time_t fecha;
+	size_t bytes;
+
+	bool operator<(const EntradaDirectorio &otra) const
+	{
+		return fecha < otra.fecha;
+	}
+};
+
+static bool
+EsEntrada(const char *nombre)
+{
+	size_t largo = strlen(nombre);
+	return largo > 6 && strcmp(nombre + largo - 6, ".malla") == 0;
+}
+
+// Las entradas (*.malla) del directorio de la cache
+static void
+ListarEntradas(std::vector<EntradaDirectorio> &entradas)
+{
+	EntradaDirectorio entrada;
+#ifdef _WIN32
+	char patron[600];
+	snprintf(patron, sizeof(patron), "%s/*.malla", directorioCache);
+	struct _finddata_t datos;
+	intptr_t busqueda = _findfirst(patron, &datos);
+	if ( busqueda == -1 )
+	{
+		return;
+	}
+	do
+	{
+		if ( EsEntrada(datos.name) )
+		{
+			entrada.nombre = std::string(directorioCache) + "/" + datos.name;
+			entrada.fecha = datos.time_write;
+			entrada.bytes = datos.size;
+			entradas.push_back(entrada);
+		}
+	} while ( _findnext(busqueda, &datos) == 0 );
+	_findclose(busqueda);
+#else
+	DIR *dir = opendir(directorioCache);
+	if ( dir == NULL )
+	{
+		return;
+	}
+	struct dirent *d;
+	while ( (d = readdir(dir)) != NULL )
+	{
+		struct stat datos;
+		entrada.nombre = std::string(directorioCache) + "/" + d->d_name;
+		if ( EsEntrada(d->d_name) && stat(entrada.nombre.c_str(), &datos) == 0 )
+		{
+			entrada.fecha = datos.st_mtime;
+			entrada.bytes = (size_t)datos.st_size;
+			entradas.push_back(entrada);
+		}
+	}
+	closedir(dir);
+#endif
+}
+
+static size_t
+Alinear(size_t bytes)
+{
+	return (bytes + 3) & ~(size_t)3;
+}
+
+static void
+NombreFichero(char *nombre, size_t tam, ClaveCache::Valor clave)
+{
+	snprintf(nombre, tam, "%s/%016llx.malla", directorioCache, clave);
+}
+
+ClaveCache::ClaveCache(const char *generador, int version) : valor(FNV_BASE)
+{
+	Anadir(generador, strlen(generador));
+	Anadir(version);
+	Anadir(CacheMallas::VERSION);
+}
+
+void
+ClaveCache::Anadir(const void *datos, size_t bytes)
+{
+	const unsigned char *p = (const unsigned char *)datos;
+	for ( size_t i = 0 ; i < bytes ; ++i )
+	{
+		valor = (valor ^ p[i]) * FNV_PRIMO;
+	}
+}
+
+void
+ClaveCache::Anadir(int n)
+{
+	Anadir(&n, sizeof(n));
+}
+
+void
+ClaveCache::Anadir(const Aleatorio &aleatorio)
+{
+	Aleatorio::Semilla estado = aleatorio.GetEstado();
+	Aleatorio::Semilla incremento = aleatorio.GetIncremento();
+	Anadir(&estado, sizeof(estado));
+	Anadir(&incremento, sizeof(incremento));
+}
+
+void
+CacheMallas::SetDirectorio(const char *directorio)
+{
+	snprintf(directorioCache, sizeof(directorioCache), "%s", directorio);
+}
+
+void
+CacheMallas::SetActiva(bool activa)
+{
+	cacheActiva = activa;
+}
+
+bool
+CacheMallas::GetActiva()
+{
+	return cacheActiva;
+}
+
+void
+CacheMallas::SetMaximoBytes(size_t bytes)
+{
+	maximoBytes = bytes;
+}
+
+size_t
+CacheMallas::GetMaximoBytes()
+{
+	return maximoBytes;
+}
+
+// Recortar, sin borrar conservar (la entrada que se acaba de guardar)
+static int
+RecortarDirectorio(const char *conservar)
+{
+	std::vector<EntradaDirectorio> entradas;
+	ListarEntradas(entradas);
+
+	size_t total = 0;
+	for ( size_t i = 0 ; i < entradas.size() ; ++i )
+	{
+		total += entradas[i].bytes;
+	}
+
+	// De la usada hace mas tiempo a la mas reciente. Las que esten abiertas
+	// (en Windows no se pueden borrar) se saltan.
+	std::stable_sort(entradas.begin(), entradas.end());
+	int borradas = 0;
+	for ( size_t i = 0 ; i < entradas.size() && total > maximoBytes ; ++i )
+	{
+		if ( (conservar == NULL || entradas[i].nombre != conservar) && remove(entradas[i].nombre.c_str()) == 0 )
+		{
+			total -= entradas[i].bytes;
+			borradas++;
+		}
+	}
+	return borradas;
+}
+
+int
+CacheMallas::Recortar()
+{
+	return RecortarDirectorio(NULL);
+}
+
+ArchivoMapeado *
+CacheMallas::Cargar(const ClaveCache &clave, Malla *mallas, int numMallas, Aleatorio::Semilla &estadoAleatorio)
+{
+	if ( !cacheActiva )
+	{
+		return NULL;
+	}
+
+	char nombre[600];
+	NombreFichero(nombre, sizeof(nombre), clave.GetValor());
+
+	ArchivoMapeado *archivo = new ArchivoMapeado();
+	if ( !archivo->Abrir(nombre) )
+	{
+		delete archivo;
+		return NULL;
+	}
+
+	// Comprobamos la cabecera y que todo cabe en el fichero antes de usar
+	// ningun puntero
+	char *datos = (char *)archivo->GetDatos();
+	size_t tamano = archivo->GetTamano();
+	size_t tamCabeceras = sizeof(CabeceraCache) + numMallas*sizeof(CabeceraMalla);
+
+	const CabeceraCache *cabecera = (const CabeceraCache *)datos;
+	bool valido = tamano >= tamCabeceras &&
+		memcmp(cabecera->magia, MAGIA, sizeof(MAGIA)) == 0 &&
+		cabecera->version == (u32)VERSION &&
+		cabecera->clave == clave.GetValor() &&
+		cabecera->numMallas == (u32)numMallas &&
+		cabecera->tamVertice == sizeof(video::S3DVertex);
+
+	const CabeceraMalla *cabeceras = (const CabeceraMalla *)(datos + sizeof(CabeceraCache));
+	for ( int i = 0 ; valido && i < numMallas ; ++i )
+	{
+		const CabeceraMalla &c = cabeceras[i];
+		valido = c.desplazamientoVertices % 4 == 0 && c.desplazamientoIndices % 4 == 0 &&
+			c.desplazamientoVertices + (size_t)c.numVertices*sizeof(video::S3DVertex) <= tamano &&
+			c.desplazamientoIndices + (size_t)c.numIndices*sizeof(u16) <= tamano;
+		if ( valido )
+		{
+			mallas[i].vertices = (video::S3DVertex *)(datos + c.desplazamientoVertices);
+			mallas[i].indices = (u16 *)(datos + c.desplazamientoIndices);
+			mallas[i].numVertices = c.numVertices;
+			mallas[i].numIndices = c.numIndices;
+		}
+	}
+
+	if ( !valido )
+	{
+		delete archivo;
+		return NULL;
+	}
+	estadoAleatorio = cabecera->estadoAleatorio;
+
+	// La fecha del fichero es la de su ultimo uso, para Recortar
+#ifdef _WIN32
+	_utime(nombre, NULL);
+#else
+	utime(nombre, NULL);
+#endif
+	return archivo;
+}
+
+bool
+CacheMallas::Guardar(const ClaveCache &clave, const Malla *mallas, int numMallas, Aleatorio::Semilla estadoAleatorio)
+{
+	if ( !cacheActiva )
+	{
+		return false;
+	}
+
+#ifdef _WIN32
+	_mkdir(directorioCache);
+#else
+	mkdir(directorioCache, 0777);
+#endif
+
+	char nombre[600];
+	char temporal[610];
+	NombreFichero(nombre, sizeof(nombre), clave.GetValor());
+	snprintf(temporal, sizeof(temporal), "%s.tmp", nombre);
+
+	FILE *f = fopen(temporal, "wb");
+	if ( f == NULL )
+	{
+		return false;
+	}
+
+	CabeceraCache cabecera;
+	memcpy(cabecera.magia, MAGIA, sizeof(MAGIA));
+	cabecera.version = VERSION;
+	cabecera.clave = clave.GetValor();
+	cabecera.estadoAleatorio = estadoAleatorio;
+	cabecera.numMallas = numMallas;
+	cabecera.tamVertice = sizeof(video::S3DVertex);
+	bool ok = fwrite(&cabecera, sizeof(cabecera), 1, f) == 1;
+
+	// Colocamos los datos detras de todas las cabeceras
+	size_t desplazamiento = sizeof(CabeceraCache) + numMallas*sizeof(CabeceraMalla);
+	for ( int i = 0 ; ok && i < numMallas ; ++i )
+	{
+		CabeceraMalla c;
+		c.numVertices = mallas[i].numVertices;
+		c.numIndices = mallas[i].numIndices;
+		c.desplazamientoVertices = (u32)desplazamiento;
+		desplazamiento = Alinear(desplazamiento + mallas[i].numVertices*sizeof(video::S3DVertex));
+		c.desplazamientoIndices = (u32)desplazamiento;
+		desplazamiento = Alinear(desplazamiento + mallas[i].numIndices*sizeof(u16));
+		ok = fwrite(&c, sizeof(c), 1, f) == 1;
+	}
+
+	const char relleno[4] = { 0, 0, 0, 0 };
+	for ( int i = 0 ; ok && i < numMallas ; ++i )
+	{
+		size_t bytesVertices = mallas[i].numVertices*sizeof(video::S3DVertex);
+		size_t bytesIndices = mallas[i].numIndices*sizeof(u16);
+		ok = fwrite(mallas[i].vertices, 1, bytesVertices, f) == bytesVertices &&
+			fwrite(relleno, 1, Alinear(bytesVertices) - bytesVertices, f) == Alinear(bytesVertices) - bytesVertices &&
+			fwrite(mallas[i].indices, 1, bytesIndices, f) == bytesIndices &&
+			fwrite(relleno, 1, Alinear(bytesIndices) - bytesIndices, f) == Alinear(bytesIndices) - bytesIndices;
+	}
+
+	ok = fclose(f) == 0 && ok;
+
+	// En Windows rename no sobrescribe
+	remove(nombre);
+	if ( !ok || rename(temporal, nombre) != 0 )
+	{
+		remove(temporal);
+		return false;
+	}
+	RecortarDirectorio(nombre);
+	return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <irrlicht.h>
+
+#include "Aleatorio.h"
+
+#include <stddef.h>
+class ArchivoMapeado;
+
+// Clave de una entrada de la cache: hash FNV-1a de 64 bits de todo lo que
+// determina la malla (tipo y version del generador, estado del Aleatorio y
+// parametros). Si cambia cualquiera de ellos cambia el fichero.
+class ClaveCache
+{
+public:
+	typedef unsigned long long Valor;
+
+private:
+	Valor valor;
+
+public:
+	ClaveCache(const char *generador, int version);
+
+	void Anadir(const void *datos, size_t bytes);
+	void Anadir(int n);
+	void Anadir(const Aleatorio &aleatorio);
+
+	Valor GetValor() const
+	{
+		return valor;
+	}
+};
+
+// Cache en disco de mallas ya generadas (vertices con posicion, normal,
+// color y uv, e indices), un fichero por clave en el directorio de la cache.
+//
+// Los ficheros se leen proyectandolos en memoria: Cargar apunta las mallas
+// directamente al fichero mapeado, sin copiar ni generar nada. Las paginas
+// se mapean en modo copia al escribir, asi que se pueden modificar.
+//
+// Cada entrada guarda tambien el estado del Aleatorio tras generar: quien
+// saca una malla de la cache deja su Aleatorio como si la hubiera generado,
+// y lo que genere despues con el sale igual con la cache que sin ella.
+//
+// El directorio no pasa de GetMaximoBytes(): al guardar se borran las
+// entradas usadas hace mas tiempo (Cargar actualiza la fecha del fichero)
+// hasta que todo cabe.
+class CacheMallas
+{
+public:
+	struct Malla
+	{
+		irr::video::S3DVertex *vertices;
+		irr::u16 *indices;
+		int numVertices;
+		int numIndices;
+	};
+
+	// Sube al cambiar el formato del fichero
+	static const int VERSION = 2;
+
+	// Tamano del directorio por defecto: 256 MB
+	static const size_t MAXIMO_BYTES = 256u << 20;
+
+	// Directorio de la cache ("cache" por defecto). Se crea al guardar.
+	static void SetDirectorio(const char *directorio);
+	static void SetActiva(bool activa);
+	static bool GetActiva();
+	static void SetMaximoBytes(size_t bytes);
+	static size_t GetMaximoBytes();
+
+	// Busca la entrada de la clave. Si existe y tiene numMallas mallas,
+	// rellena mallas con punteros al fichero mapeado y estadoAleatorio con
+	// el guardado, y devuelve el archivo, que el llamante tiene que borrar
+	// cuando deje de usar las mallas. Si no, devuelve NULL.
+	static ArchivoMapeado *Cargar(const ClaveCache &clave, Malla *mallas, int numMallas,
+		Aleatorio::Semilla &estadoAleatorio);
+
+	// Escribe la entrada de la clave (en un temporal que luego se renombra,
+	// para que nunca se lea un fichero a medias). estadoAleatorio es el
+	// GetEstado() del Aleatorio despues de generar las mallas.
+	static bool Guardar(const ClaveCache &clave, const Malla *mallas, int numMallas,
+		Aleatorio::Semilla estadoAleatorio);
+
+	// Borra las entradas menos usadas hasta que el directorio no pasa de
+	// GetMaximoBytes() (Guardar ya lo hace). Devuelve las borradas.
+	static int Recortar();
+};
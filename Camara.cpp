@@ -13,6 +13,10 @@ Camara::Camara()
 	nodo->setTarget(dtarget); 
 	nodo->setPosition(dpos);
 
+	pos = posAnterior = dpos;
+	target = targetAnterior = dtarget;
+	tickAnterior = Juego::GetInstance()->GetTicks();
+
 }
 
 Camara::~Camara(void)
@@ -32,14 +36,25 @@ Camara::FocusOn(core::vector3df target, core::vector3df pos)
 void
 Camara::Update()
 {
-	core::vector3df actualPos = nodo->getPosition();
-	actualPos = actualPos.getInterpolated(dpos, 0.99f);
-	nodo->setPosition(actualPos);
-
-	core::vector3df actualTarget = nodo->getTarget();
-	actualTarget = actualTarget.getInterpolated(dtarget, 0.90f);
-	nodo->setTarget(actualTarget);
+	// Partida la actualiza mas de una vez por paso: lo anterior es lo que
+	// habia al empezar el paso
+	u32 tick = Juego::GetInstance()->GetTicks();
+	if ( tick != tickAnterior )
+	{
+		posAnterior = pos;
+		targetAnterior = target;
+		tickAnterior = tick;
+	}
+
+	pos = pos.getInterpolated(dpos, 0.99f);
+	target = target.getInterpolated(dtarget, 0.90f);
+}
 
+void
+Camara::Interpolar(float alpha)
+{
+	nodo->setPosition(pos.getInterpolated(posAnterior, alpha));
+	nodo->setTarget(target.getInterpolated(targetAnterior, alpha));
 	nodo->setUpVector(core::vector3df(1,0,0));
 }
 
@@ -13,10 +13,18 @@ private:
 	core::vector3df dtarget;
 	core::vector3df dpos;
 
+	// Posicion y objetivo en el ultimo paso y al empezarlo
+	core::vector3df pos;
+	core::vector3df target;
+	core::vector3df posAnterior;
+	core::vector3df targetAnterior;
+	u32 tickAnterior;
+
 public:
 	Camara();
 	virtual ~Camara(void);
 
 	void FocusOn(core::vector3df target, core::vector3df pos);
 	void Update();
+	void Interpolar(float alpha);
 };
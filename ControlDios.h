@@ -0,0 +1,27 @@
+#pragma once
+
+class Simulacion;
+class Dios;
+
+// Lo que un dios hace en un paso
+struct OrdenesDios
+{
+	// Disparos de calor, agua y meteorito
+	bool disparar[3];
+
+	// +1 sube, -1 baja, 0 se queda
+	int mover;
+};
+
+// Quien maneja a un dios: el teclado (ControlTeclado) o un programa
+// (ControlIA) cuando se simulan partidas sin jugador
+class ControlDios
+{
+public:
+	virtual ~ControlDios(void)
+	{
+	}
+
+	// Se llama una vez por paso; ordenes llega sin ninguna orden
+	virtual void Decidir(Simulacion &simulacion, Dios &dios, OrdenesDios &ordenes) = 0;
+};
@@ -0,0 +1,159 @@
+#include "ControlIA.h"
+
+#include "Simulacion.h"
+#include "Planeta.h"
+#include "Dios.h"
+
+#include <math.h>
+using namespace irr;
+
+const float ControlIA::AHORRO_METEORITO = 70.0f;
+
+ControlIA::ControlIA(Aleatorio::Semilla semilla, Aleatorio::Semilla flujo) :
+	aleatorio(semilla, flujo), objetivo(NULL), ticksObjetivo(0), desvio(0.0f)
+{
+}
+
+ControlIA::~ControlIA(void)
+{
+}
+
+void
+ControlIA::ElegirObjetivo(Simulacion &simulacion, Dios &dios)
+{
+	list<Planeta *> &planetas = simulacion.GetPlanetas();
+
+	// Primero los que no nos adoran, y si no hay, los nuestros
+	int candidatos = 0;
+	for ( list<Planeta *>::iterator p = planetas.begin() ; p != planetas.end() ; ++p )
+	{
+		if ( (*p)->GetDiosAdorado() != &dios )
+		{
+			candidatos++;
+		}
+	}
+
+	int elegido = aleatorio.Entero(candidatos > 0 ? candidatos : (int)planetas.size());
+	for ( list<Planeta *>::iterator p = planetas.begin() ; p != planetas.end() ; ++p )
+	{
+		if ( candidatos > 0 && (*p)->GetDiosAdorado() == &dios )
+		{
+			continue;
+		}
+		if ( elegido-- == 0 )
+		{
+			objetivo = *p;
+			break;
+		}
+	}
+
+	ticksObjetivo = TICKS_OBJETIVO;
+	desvio = (aleatorio.Real() - 0.5f) * 2.0f;
+}
+
+bool
+ControlIA::EsEnemigo(Planeta *planeta, Dios &dios)
+{
+	return planeta != NULL && planeta->GetDiosAdorado() != NULL && planeta->GetDiosAdorado() != &dios;
+}
+
+// Un planeta del otro dios al azar; false si no tiene ninguno
+bool
+ControlIA::ElegirEnemigo(Simulacion &simulacion, Dios &dios)
+{
+	list<Planeta *> &planetas = simulacion.GetPlanetas();
+
+	int enemigos = 0;
+	for ( list<Planeta *>::iterator p = planetas.begin() ; p != planetas.end() ; ++p )
+	{
+		if ( EsEnemigo(*p, dios) )
+		{
+			enemigos++;
+		}
+	}
+	if ( enemigos == 0 )
+	{
+		return false;
+	}
+
+	int elegido = aleatorio.Entero(enemigos);
+	for ( list<Planeta *>::iterator p = planetas.begin() ; p != planetas.end() ; ++p )
+	{
+		if ( EsEnemigo(*p, dios) && elegido-- == 0 )
+		{
+			objetivo = *p;
+			break;
+		}
+	}
+	ticksObjetivo = TICKS_OBJETIVO;
+	desvio = 0.0f;
+	return true;
+}
+
+void
+ControlIA::Decidir(Simulacion &simulacion, Dios &dios, OrdenesDios &ordenes)
+{
+	// Con todo el poder de meteorito el objetivo es un planeta del otro dios
+	bool mega = dios.GetPoder()[2] >= 100.0f && !simulacion.GetEnSecuencia();
+	if ( mega && !EsEnemigo(objetivo, dios) )
+	{
+		mega = ElegirEnemigo(simulacion, dios);
+	}
+
+	if ( --ticksObjetivo < 1 || objetivo == NULL )
+	{
+		if ( mega )
+		{
+			ElegirEnemigo(simulacion, dios);
+		}
+		else
+		{
+			ElegirObjetivo(simulacion, dios);
+		}
+	}
+
+	// Nos ponemos a su altura
+	float dx = objetivo->GetPosicion().X + desvio - dios.GetPosicion().X ;
+	if ( dx > 0.2f )
+	{
+		ordenes.mover = 1 ;
+	}
+	else if ( dx < -0.2f )
+	{
+		ordenes.mover = -1 ;
+	}
+
+	if ( fabs(dx) > 1.0f )
+	{
+		return;
+	}
+
+	if ( mega )
+	{
+		ordenes.disparar[2] = true;
+		return;
+	}
+
+	// Lo que mas le falta, si algo le falta: el impacto sube agua o calor
+	// en poder/100
+	float faltaAgua = 0.5f - objetivo->GetAgua();
+	float faltaCalor = 0.5f - objetivo->GetCalor();
+	int tipo = faltaAgua > faltaCalor ? 1 : 0 ;
+	float falta = tipo == 1 ? faltaAgua : faltaCalor ;
+	if ( falta < 0.03f )
+	{
+		return;
+	}
+	if ( dios.GetPoder()[2] > AHORRO_METEORITO )
+	{
+		return;
+	}
+
+	// Disparamos cuando lo deja entre 0.5 y 0.5+falta: pasarse mas de lo
+	// que faltaba ya no gana devotos
+	float impacto = dios.GetPoder()[tipo] / 100.0f;
+	if ( impacto >= falta && impacto < 2.0f*falta )
+	{
+		ordenes.disparar[tipo] = true;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ControlDios.h"
+#include "Aleatorio.h"
+
+class Planeta;
+
+// Un dios sin jugador para las partidas simuladas. Elige un planeta que no
+// le adore (o uno suyo si ya los tiene todos), se pone a su altura y le
+// dispara agua o calor cuando le falta y tiene poder para acercarlo a 0.5,
+// que es lo que gana devotos. El poder de meteorito lo guarda: cuando llega
+// a 100 busca un planeta del otro dios y le lanza el mega meteorito, que lo
+// deja sin devotos. El Aleatorio hace que dos partidas con distinta semilla
+// no se jueguen igual.
+class ControlIA : public ControlDios
+{
+private:
+	Aleatorio aleatorio;
+	Planeta *objetivo;
+	int ticksObjetivo;
+	float desvio;
+
+	// Pasos que se mantiene un objetivo
+	static const int TICKS_OBJETIVO = 300;
+
+	// Cada disparo de agua o calor divide el poder de meteorito por 1.2:
+	// pasado AHORRO_METEORITO ya no se dispara hasta lanzar el meteorito
+	static const float AHORRO_METEORITO;
+
+	void ElegirObjetivo(Simulacion &simulacion, Dios &dios);
+	bool ElegirEnemigo(Simulacion &simulacion, Dios &dios);
+	static bool EsEnemigo(Planeta *planeta, Dios &dios);
+
+public:
+	ControlIA(Aleatorio::Semilla semilla, Aleatorio::Semilla flujo);
+	virtual ~ControlIA(void);
+
+	virtual void Decidir(Simulacion &simulacion, Dios &dios, OrdenesDios &ordenes);
+};
@@ -0,0 +1,51 @@
+#include "ControlTeclado.h"
+
+#include "Juego.h"
+#include "Teclado.h"
+
+using namespace irr;
+
+ControlTeclado::ControlTeclado(bool izquierda) : izquierda(izquierda)
+{
+}
+
+ControlTeclado::~ControlTeclado(void)
+{
+}
+
+void
+ControlTeclado::Decidir(Simulacion &simulacion, Dios &dios, OrdenesDios &ordenes)
+{
+	Teclado *teclado = Juego::GetInstance()->GetTeclado();
+
+	if ( izquierda )
+	{
+		ordenes.disparar[0] = teclado->KeyDown(irr::KEY_KEY_Z);
+		ordenes.disparar[1] = teclado->KeyDown(irr::KEY_KEY_X);
+		ordenes.disparar[2] = teclado->KeyDown(irr::KEY_KEY_C);
+
+		if ( teclado->Key(irr::KEY_KEY_Q) )
+		{
+			ordenes.mover = 1 ;
+		}
+		else if ( teclado->Key(irr::KEY_KEY_A) )
+		{
+			ordenes.mover = -1 ;
+		}
+	}
+	else
+	{
+		ordenes.disparar[0] = teclado->KeyDown(irr::KEY_NUMPAD1);
+		ordenes.disparar[1] = teclado->KeyDown(irr::KEY_NUMPAD2);
+		ordenes.disparar[2] = teclado->KeyDown(irr::KEY_NUMPAD3);
+
+		if ( teclado->Key(irr::KEY_UP) )
+		{
+			ordenes.mover = 1 ;
+		}
+		else if ( teclado->Key(irr::KEY_DOWN) )
+		{
+			ordenes.mover = -1 ;
+		}
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ControlDios.h"
+
+// Un jugador en el teclado de Juego: el dios izquierdo dispara con Z, X y C
+// y se mueve con Q y A; el derecho con 1, 2 y 3 del teclado numerico y las
+// flechas
+class ControlTeclado : public ControlDios
+{
+private:
+	bool izquierda;
+
+public:
+	ControlTeclado(bool izquierda);
+	virtual ~ControlTeclado(void);
+
+	virtual void Decidir(Simulacion &simulacion, Dios &dios, OrdenesDios &ordenes);
+};
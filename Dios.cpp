@@ -1,33 +1,17 @@
 #include "Dios.h"
 
-#include "Partida.h"
-#include "Juego.h"
-#include "Teclado.h"
+#include "Simulacion.h"
+#include "ControlDios.h"
+#include "VistasPartida.h"
 
 using namespace irr;
 
-Dios::Dios(Partida *partida, float z, bool izquierda)
-	: diosIzquierdo(izquierda),partida(partida)
+Dios::Dios(Simulacion *simulacion, float z, bool izquierda, ControlDios *control, FabricaVistas *vistas)
+	: simulacion(simulacion),control(control),diosIzquierdo(izquierda)
 {
-	//nodo = Juego::GetInstance()->GetSceneManager()->addSphereSceneNode(1);
-	video::SMaterial material;
-	material.Texture1 = Juego::GetInstance()->GetVideoDriver()->getTexture("data/faerie2.bmp");
-	material.Lighting = true;
-
-	scene::IAnimatedMesh* faerie = Juego::GetInstance()->GetSceneManager()->getMesh("data/faerie.md2");
-
-	nodo = Juego::GetInstance()->GetSceneManager()->addAnimatedMeshSceneNode(faerie);
-	nodo->setPosition(core::vector3df(0, 0, z));
-	float sc=0.15f;
-	nodo->setScale(core::vector3df(sc, sc, sc));
-	if(izquierda)
-		nodo->setRotation(core::vector3df(0.0, -90.0f, -90.0));
-	else
-		nodo->setRotation(core::vector3df(0.0, 90.0f, -90.0));
-	nodo->getMaterial(0) = material;
-	//nodo->setMD2Animation(scene::EMAT_STAND);
-	nodo->setFrameLoop(1, 300);
-	nodo->setAnimationSpeed(80);
+	pos = core::vector3df(0, 0, z);
+	posAnterior = pos;
+	nodo = vistas ? vistas->CrearDios(pos, izquierda) : NULL;
 
 	if ( diosIzquierdo )
 	{
@@ -45,99 +29,62 @@ Dios::Dios(Partida *partida, float z, bool izquierda)
 
 Dios::~Dios(void)
 {
+	delete nodo;
 }
 
 void
 Dios::Update()
 {
-	Teclado *teclado = Juego::GetInstance()->GetTeclado();
 	AddPoder(0.01f);
 
-	core::vector3df pos = nodo->getPosition();
+	posAnterior = pos;
 
-	if ( diosIzquierdo )
+	OrdenesDios ordenes;
+	ordenes.disparar[0] = ordenes.disparar[1] = ordenes.disparar[2] = false;
+	ordenes.mover = 0;
+	if ( control )
 	{
-		if ( teclado->KeyDown(irr::EKEY_CODE::KEY_KEY_Z) )
-		{
-			if(poder[0]>0)
-			{
-				this->partida->CrearDisparo(pos,poder[0],1,this);
-				poder[0]=0;
-				poder[1]=poder[1]/1.2;
-				poder[2]=poder[2]/1.2;
-			}
-		}
-		else if ( teclado->KeyDown(irr::EKEY_CODE::KEY_KEY_X) )
-		{
-			if(poder[0]>0)
-			{
-				this->partida->CrearDisparo(pos,poder[1],2,this);
-				poder[1]=0;
-				poder[0]=poder[0]/1.2;
-				poder[2]=poder[2]/1.2;
-			}
-		}
-		if ( teclado->KeyDown(irr::EKEY_CODE::KEY_KEY_C) )
-		{
-			if(poder[0]>0)
-			{
-				this->partida->CrearDisparo(pos,poder[2],3,this);
-				poder[2]=0;
-				poder[0]=poder[0]/1.2;
-				poder[1]=poder[1]/1.2;
-			}
-		}
+		control->Decidir(*simulacion, *this, ordenes);
+	}
 
-		if ( teclado->Key(irr::EKEY_CODE::KEY_KEY_Q) )
-		{
-			pos.X += 0.2f ;
-		}
-		else if ( teclado->Key(irr::EKEY_CODE::KEY_KEY_A) )
+	if ( ordenes.disparar[0] )
+	{
+		if(poder[0]>0)
 		{
-			pos.X -= 0.2f ;
+			this->simulacion->CrearDisparo(pos,poder[0],1,this);
+			poder[0]=0;
+			poder[1]=poder[1]/1.2;
+			poder[2]=poder[2]/1.2;
 		}
 	}
-	else
+	else if ( ordenes.disparar[1] )
 	{
-		if ( teclado->KeyDown(irr::EKEY_CODE::KEY_NUMPAD1) )
-		{
-			if(poder[0]>0)
-			{
-				this->partida->CrearDisparo(pos,poder[0],1,this);
-				poder[0]=0;
-				poder[1]=poder[1]/1.2;
-				poder[2]=poder[2]/1.2;
-			}
-		}
-		if ( teclado->KeyDown(irr::EKEY_CODE::KEY_NUMPAD2) )
+		if(poder[0]>0)
 		{
-			if(poder[0]>0)
-			{
-				this->partida->CrearDisparo(pos,poder[1],2,this);
-				poder[1]=0;
-				poder[0]=poder[0]/1.2;
-				poder[2]=poder[2]/1.2;
-			}
+			this->simulacion->CrearDisparo(pos,poder[1],2,this);
+			poder[1]=0;
+			poder[0]=poder[0]/1.2;
+			poder[2]=poder[2]/1.2;
 		}
-		if ( teclado->KeyDown(irr::EKEY_CODE::KEY_NUMPAD3) )
+	}
+	if ( ordenes.disparar[2] )
+	{
+		if(poder[0]>0)
 		{
-			if(poder[0]>0)
-			{
-				this->partida->CrearDisparo(pos,poder[2],3,this);
-				poder[2]=0;
-				poder[0]=poder[0]/1.2;
-				poder[1]=poder[1]/1.2;
-			}
+			this->simulacion->CrearDisparo(pos,poder[2],3,this);
+			poder[2]=0;
+			poder[0]=poder[0]/1.2;
+			poder[1]=poder[1]/1.2;
 		}
+	}
 
-		if ( teclado->Key(irr::EKEY_CODE::KEY_UP) )
-		{
-			pos.X += 0.2f ;
-		}
-		else if ( teclado->Key(irr::EKEY_CODE::KEY_DOWN) )
-		{
-			pos.X -= 0.2f ;
-		}
+	if ( ordenes.mover > 0 )
+	{
+		pos.X += 0.2f ;
+	}
+	else if ( ordenes.mover < 0 )
+	{
+		pos.X -= 0.2f ;
 	}
 
 	// Comprobamos que no nos salimos de la pantalla
@@ -149,8 +96,15 @@ Dios::Update()
 	{
 		pos.X = 25.0f ;
 	}
+}
 
-	nodo->setPosition(pos);
+void
+Dios::Interpolar(float alpha)
+{
+	if ( nodo )
+	{
+		nodo->SetPosicion(pos.getInterpolated(posAnterior, alpha));
+	}
 }
 
 void
@@ -3,21 +3,29 @@
 #include <irrlicht.h>
 using namespace irr;
 
-class Partida;
+class Simulacion;
+class ControlDios;
+class VistaDios;
+class FabricaVistas;
 
 class Dios
 {
 private:
-	scene::IAnimatedMeshSceneNode *nodo;
-	Partida *partida;
+	// NULL sin graficos
+	VistaDios *nodo;
+	core::vector3df pos;
+	core::vector3df posAnterior;
+	Simulacion *simulacion;
+	ControlDios *control;
 	bool diosIzquierdo;
 	video::SColor color;
 	video::SColor colorAtmosfera;
 	float poder[3];
 
 public:
-	Dios(Partida *partida, float z, bool izquierda);
-	Dios();
+	// control decide en cada paso que hace el dios (no es del dios); vistas
+	// puede ser NULL
+	Dios(Simulacion *simulacion, float z, bool izquierda, ControlDios *control, FabricaVistas *vistas);
 	virtual ~Dios(void);
 
 	video::SColor GetColorAtmosfera()
@@ -26,6 +34,7 @@ public:
 	}
 
 	void Update();
+	void Interpolar(float alpha);
 	void AddPoder(float p);
 	float* GetPoder();
 	bool EsDiosIzquierdo()
@@ -35,7 +44,7 @@ public:
 
 	core::vector3df GetPosicion()
 	{
-		return nodo->getPosition();
+		return pos;
 	}
 
 };
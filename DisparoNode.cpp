@@ -1,16 +1,21 @@
 #include "DisparoNode.h"
 
 #include "Juego.h"
+#include "PoolNodosDisparo.h"
 
 using namespace irr;
 
-DisparoNode::DisparoNode(scene::ISceneNode *parent, scene::ISceneManager *mgr, s32 id, float radio,core::vector3df pos,int tipo) 
-		: scene::ISceneNode(parent, mgr, id), radio(radio),tipo(tipo)
+DisparoNode::DisparoNode(scene::ISceneNode *parent, scene::ISceneManager *mgr, s32 id, int tipo, PoolNodosDisparo *pool) 
+		: scene::ISceneNode(parent, mgr, id), bill(NULL), radio(1.0f), tipo(tipo), pool(pool), explotando(false),
+		finExplosion(0)
 {
+	// Todo cuelga del nodo, que esta en el origen, para esconderlo y quitarlo
+	// de la escena de una vez. Los tamanos dependen del radio y se ponen en
+	// Reiniciar.
 	if(tipo==3)
 	{
 		irr::video::IVideoDriver *video=Juego::GetInstance()->GetVideoDriver();
-		luz=mgr->addSphereSceneNode(radio/30,10,this);
+		luz=mgr->addSphereSceneNode(1.0f,10,this);
 		luz->setMaterialTexture(0, video->getTexture("data/roca.bmp"));
 		luz->setMaterialFlag(video::EMF_LIGHTING, false);
 		scene::ISceneNodeAnimator* anim = 
@@ -20,12 +25,12 @@ DisparoNode::DisparoNode(scene::ISceneNode *parent, scene::ISceneManager *mgr, s
 		anim->drop();
 	}
 	else
-		luz = mgr->addLightSceneNode(0, core::vector3df(0,0,0), 
+		luz = mgr->addLightSceneNode(this, core::vector3df(0,0,0), 
 			video::SColorf(1.0f, 0.2f, 0.2f, 0.0f), 10.0f);
 
 	if(tipo!=3)
 	{
-		bill = mgr->addBillboardSceneNode(luz, core::dimension2d<f32>(radio/2, radio/2));
+		bill = mgr->addBillboardSceneNode(luz, core::dimension2d<f32>(1.0f, 1.0f));
 		bill->setMaterialFlag(video::EMF_LIGHTING, false);
 		bill->setMaterialType(video::EMT_TRANSPARENT_ADD_COLOR);
 		if(tipo==1)
@@ -37,21 +42,13 @@ DisparoNode::DisparoNode(scene::ISceneNode *parent, scene::ISceneManager *mgr, s
 		ps = 
 			mgr->addParticleSystemSceneNode(false, luz);
 
-		if(tipo!=3)
-			ps->setParticleSize(core::dimension2d<f32>(radio/3, radio/3));
-		else
-			ps->setParticleSize(core::dimension2d<f32>(radio/5, radio/5));
-
-		// create and set emitter
-		scene::IParticleEmitter* em;
+		// create emitter; se pone al mostrar el nodo y se quita al esconderlo
 			em = ps->createBoxEmitter(
 				core::aabbox3d<f32>(-1, 0.1f,0.1f, 1.1f, 0, 0),		//3 cord de origen, 3 de tamao
 				core::vector3df(0.0f,0.0f,0.0f),					//Cord direccion
 				10,40,												//Min y max particulas segundo
 				video::SColor(0,255,255,255), video::SColor(0,255,255,255),
 				400,700);
-		ps->setEmitter(em);
-		em->drop();
 
 		// create and set affector
 		scene::IParticleAffector* paf = ps->createFadeOutParticleAffector();
@@ -68,47 +65,73 @@ DisparoNode::DisparoNode(scene::ISceneNode *parent, scene::ISceneManager *mgr, s
 			ps->setMaterialTexture(0, Juego::GetInstance()->GetVideoDriver()->getTexture("data/meteor.bmp"));
 		ps->setMaterialType(video::EMT_TRANSPARENT_VERTEX_ALPHA);
 
-	core::vector3df v;
-	v.Z=-pos.Z;
-
-	luz->setPosition(v);
+	Esconder();
+}
 
+DisparoNode::~DisparoNode(void)
+{
+	em->drop();
+}
 
-	scene::ISceneNodeAnimator* anim = 
-		Juego::GetInstance()->GetSceneManager()->createFlyStraightAnimator(pos,v,2000);
-//Juego::GetInstance()->GetSceneManager()->createFlyCircleAnimator(core::vector3df(0,0,0),10);
+void
+DisparoNode::Reiniciar(float radio, core::vector3df pos)
+{
+	this->radio = radio;
+	explotando = false;
 
-	scene::ISceneNodeAnimator* anim2 = 
-		Juego::GetInstance()->GetSceneManager()->createDeleteAnimator(2000);
+	if(tipo==3)
+	{
+		luz->setScale(core::vector3df(radio/30, radio/30, radio/30));
+		ps->setParticleSize(core::dimension2d<f32>(radio/5, radio/5));
+	}
+	else
+	{
+		bill->setSize(core::dimension2d<f32>(radio/2, radio/2));
+		ps->setParticleSize(core::dimension2d<f32>(radio/3, radio/3));
+	}
+	ps->setEmitter(em);
 
-	//luz->addAnimator(anim);
-	//luz->addAnimator(anim2);
-	anim->drop();
-	anim2->drop();
+	luz->setPosition(pos);
+	luz->setVisible(true);
 }
 
-DisparoNode::~DisparoNode(void)
+void
+DisparoNode::Esconder()
 {
+	// Escondida la luz no ilumina y las particulas no se animan; las que
+	// queden ya habran caducado cuando se vuelva a mostrar
+	ps->setEmitter(NULL);
+	luz->setVisible(false);
 }
+
 void 
 DisparoNode::Destruir(bool mega)
 {
 	if(!mega)
 	{
-		scene::ISceneNodeAnimator* anim2 = 
-			Juego::GetInstance()->GetSceneManager()->createDeleteAnimator(1000);
-		luz->addAnimator(anim2);
-		anim2->drop();
+		finExplosion = Juego::GetInstance()->GetDevice()->getTimer()->getTime() + 1000;
 	}
 	else
 	{
 		ps->setParticleSize(core::dimension2d<f32>(radio/1.5, radio/1.5));
 		//luz->setScale(core::vector3df(sc,sc,sc));
-		scene::ISceneNodeAnimator* anim2 = 
-			Juego::GetInstance()->GetSceneManager()->createDeleteAnimator(2500);
-		luz->addAnimator(anim2);
-		anim2->drop();
+		finExplosion = Juego::GetInstance()->GetDevice()->getTimer()->getTime() + 2500;
+	}
+	explotando = true;
+}
+
+void
+DisparoNode::OnPostRender(u32 timeMs)
+{
+	if ( explotando && timeMs >= finExplosion )
+	{
+		// Solo se apunta en el pool: la escena esta recorriendo sus nodos
+		explotando = false;
+		Esconder();
+		pool->Devolver(this);
 	}
+
+	ISceneNode::OnPostRender(timeMs);
 }
 
 void 
@@ -1,20 +1,38 @@
 #pragma once
 #include <irrlicht.h>
 using namespace irr;
+
+class PoolNodosDisparo;
+
+// Lo que se ve de un disparo. Los crea y los guarda PoolNodosDisparo: el
+// mismo nodo sirve a muchos disparos de su tipo, cambiando el radio y la
+// posicion con Reiniciar.
 class DisparoNode :
 	public scene::ISceneNode
 {
 private:
 	core::aabbox3d<irr::f32> box;
-	scene::ISceneNode *bill,*luz;
+	scene::ISceneNode *luz;
+	scene::IBillboardSceneNode *bill;
 	scene::IParticleSystemSceneNode* ps;
+	scene::IParticleEmitter *em;
 	float radio;
 	int tipo;
+
+	PoolNodosDisparo *pool;
+
+	// Explotando hasta finExplosion (en el tiempo del timer del device)
+	bool explotando;
+	u32 finExplosion;
+
+	void Esconder();
+
 public:
-	DisparoNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s32 id, float radio,core::vector3df pos,int tipo);
+	DisparoNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s32 id, int tipo, PoolNodosDisparo *pool);
 	virtual ~DisparoNode(void);
 
 	virtual void render();
+	virtual void OnPostRender(u32 timeMs);
 
 	virtual const core::aabbox3d<irr::f32>& getBoundingBox() const
 	{
@@ -24,5 +42,14 @@ public:
 	{
 		luz->setPosition(pos);
 	}
+	int GetTipo() const
+	{
+		return tipo;
+	}
+
+	// Lo vuelve a mostrar para un disparo nuevo
+	void Reiniciar(float radio, core::vector3df pos);
+
+	// Explota y, al acabar, vuelve al pool
 	void Destruir(bool mega);
 };
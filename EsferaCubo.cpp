@@ -0,0 +1,493 @@
+#include "EsferaCubo.h"
+
+#include "GeneradorPlaneta.h"
+
+#include <math.h>
+using namespace irr;
+
+const float EsferaCubo::RANGO_MINIMO = 2.5f;
+const float EsferaCubo::INICIO_MORPH = 0.7f;
+
+// Distancia entre vertices opuestos de una cara del cubo ya en la esfera
+static const float DIAGONAL_CARA = 1.633f;
+
+static f32
+Acotar(f32 v, f32 minimo, f32 maximo)
+{
+	return v < minimo ? minimo : (v > maximo ? maximo : v);
+}
+
+// Distancia del punto p a la caja (0 si esta dentro)
+static f32
+DistanciaCaja(const core::vector3df &p, const core::aabbox3d<f32> &box)
+{
+	core::vector3df cercano(
+		Acotar(p.X, box.MinEdge.X, box.MaxEdge.X),
+		Acotar(p.Y, box.MinEdge.Y, box.MaxEdge.Y),
+		Acotar(p.Z, box.MinEdge.Z, box.MaxEdge.Z));
+	return (f32)p.getDistanceFrom(cercano);
+}
+
+EsferaCubo::EsferaCubo(GeneradorPlaneta *alturas, int niveles, float distanciaLOD) : alturas(alturas),
+	color(255,255,255,255), frame(0), triangulosDibujados(0), nodosConVertices(0), salida(NULL)
+{
+	// La altura IDW es una media de las de los puntos de control
+	radioMaximo = 1.0f;
+	for ( int i = 0 ; i < alturas->GetNumPuntos() ; ++i )
+	{
+		float r = alturas->GetPunto(i).altura/10.0f;
+		radioMaximo = i == 0 ? r : core::max_(radioMaximo, r);
+	}
+
+	this->niveles = core::min_(core::max_(niveles, 1), (int)MAX_NIVELES);
+	celdasCara = (TAM_NODO-1) << (this->niveles-1);
+
+	// Cada nivel tiene la mitad de rango que el anterior, igual que sus
+	// nodos tienen la mitad de lado
+	rango[0] = core::max_(distanciaLOD, RANGO_MINIMO*DIAGONAL_CARA*radioMaximo);
+	for ( int L = 1 ; L < this->niveles ; ++L )
+	{
+		rango[L] = rango[L-1]*0.5f;
+	}
+
+	CrearIndices();
+	for ( int cara = 0 ; cara < 6 ; ++cara )
+	{
+		raices[cara] = CrearNodo(cara, 0, 0, 0);
+	}
+}
+
+EsferaCubo::~EsferaCubo(void)
+{
+	for ( int cara = 0 ; cara < 6 ; ++cara )
+	{
+		BorrarNodo(raices[cara]);
+	}
+	delete alturas;
+}
+
+core::vector3df
+EsferaCubo::Direccion(int cara, int x, int y) const
+{
+	// Las coordenadas de la cara se calculan igual desde las dos caras de una
+	// arista, asi que sus vertices salen identicos en las dos
+	float u = (2*x - celdasCara) / (float)celdasCara;
+	float v = (2*y - celdasCara) / (float)celdasCara;
+
+	// Punto del cubo, con u x v hacia fuera
+	core::vector3df c;
+	switch (cara)
+	{
+	case 0:
+		c.set(1.0f, v, -u);
+		break;
+	case 1:
+		c.set(-1.0f, v, u);
+		break;
+	case 2:
+		c.set(u, 1.0f, -v);
+		break;
+	case 3:
+		c.set(u, -1.0f, v);
+		break;
+	case 4:
+		c.set(u, v, 1.0f);
+		break;
+	default:
+		c.set(-u, v, -1.0f);
+		break;
+	}
+
+	// Proyeccion a la esfera que reparte los vertices mas uniformemente que
+	// normalizar (no los amontona en el centro de las caras)
+	float x2 = c.X*c.X;
+	float y2 = c.Y*c.Y;
+	float z2 = c.Z*c.Z;
+	return core::vector3df(
+		c.X*sqrtf(1.0f - y2/2.0f - z2/2.0f + y2*z2/3.0f),
+		c.Y*sqrtf(1.0f - z2/2.0f - x2/2.0f + z2*x2/3.0f),
+		c.Z*sqrtf(1.0f - x2/2.0f - y2/2.0f + x2*y2/3.0f));
+}
+
+void
+EsferaCubo::CrearIndices()
+{
+	for ( int parte = 0 ; parte < NUM_PARTES ; ++parte )
+	{
+		int paso = parte == MITAD ? 2 : 1;
+		int celdas = TAM_NODO-1;
+		int i0 = 0;
+		int j0 = 0;
+		if ( parte < TODO )
+		{
+			celdas /= 2;
+			i0 = (parte & 1)*celdas;
+			j0 = (parte >> 1)*celdas;
+		}
+
+		int n = 0;
+		u16 *ind = indices[parte];
+		for ( int j = j0 ; j < j0+celdas ; j += paso )
+		{
+			for ( int i = i0 ; i < i0+celdas ; i += paso )
+			{
+				u16 a = (u16)(j*TAM_NODO + i);
+				u16 b = (u16)(j*TAM_NODO + i+paso);
+				u16 c = (u16)((j+paso)*TAM_NODO + i+paso);
+				u16 d = (u16)((j+paso)*TAM_NODO + i);
+
+				// Siempre con la misma diagonal, que es la que sigue la malla
+				// del padre
+				ind[n++] = a;
+				ind[n++] = b;
+				ind[n++] = c;
+				ind[n++] = a;
+				ind[n++] = c;
+				ind[n++] = d;
+			}
+		}
+		numIndices[parte] = n;
+	}
+}
+
+EsferaCubo::Nodo *
+EsferaCubo::CrearNodo(int cara, int nivel, int x0, int y0)
+{
+	Nodo *nodo = new Nodo;
+	nodo->cara = cara;
+	nodo->nivel = nivel;
+	nodo->x0 = x0;
+	nodo->y0 = y0;
+	nodo->lado = celdasCara >> nivel;
+	for ( int q = 0 ; q < 4 ; ++q )
+	{
+		nodo->hijos[q] = NULL;
+	}
+	nodo->posicion = NULL;
+	nodo->normal = NULL;
+	nodo->posicionPadre = NULL;
+	nodo->normalPadre = NULL;
+	nodo->vertices = NULL;
+	nodo->ultimoFrame = frame;
+	nodo->frameInterpolado = -1;
+
+	// La caja sale de los vertices: con el grosor de toda la orografia los
+	// nodos pequenos tendrian cajas mucho mayores que ellos y el rango de su
+	// nivel ya no aseguraria que sus vecinos mas gruesos no esten
+	// interpolando. Entre vertices la superficie se separa poco de la malla;
+	// el margen lo cubre.
+	CalcularVertices(nodo);
+	const int T = TAM_NODO;
+	nodo->box.reset(nodo->posicion[0]);
+	for ( int n = 1 ; n < T*T ; ++n )
+	{
+		nodo->box.addInternalPoint(nodo->posicion[n]);
+	}
+	f32 margen = (f32)nodo->posicion[0].getDistanceFrom(nodo->posicion[1])*0.5f;
+	nodo->box.MinEdge -= core::vector3df(margen, margen, margen);
+	nodo->box.MaxEdge += core::vector3df(margen, margen, margen);
+
+	return nodo;
+}
+
+void
+EsferaCubo::CalcularVertices(Nodo *nodo)
+{
+	const int T = TAM_NODO;
+	const int A = TAM_NODO+2;
+	int paso = nodo->lado / (T-1);
+
+	// Posiciones con un vertice mas alrededor para las normales del borde
+	core::vector3df rejilla[A*A];
+	for ( int j = -1 ; j <= T ; ++j )
+	{
+		for ( int i = -1 ; i <= T ; ++i )
+		{
+			core::vector3df d = Direccion(nodo->cara, nodo->x0 + i*paso, nodo->y0 + j*paso);
+			rejilla[(j+1)*A + i+1] = d * (alturas->GetAltura(d)/10.0f);
+		}
+	}
+
+	nodo->posicion = new core::vector3df[T*T];
+	nodo->normal = new core::vector3df[T*T];
+	nodo->posicionPadre = new core::vector3df[T*T];
+	nodo->normalPadre = new core::vector3df[T*T];
+	nodo->vertices = new video::S3DVertex[T*T];
+	nodosConVertices++;
+
+	for ( int j = 0 ; j < T ; ++j )
+	{
+		for ( int i = 0 ; i < T ; ++i )
+		{
+			const core::vector3df *r = &rejilla[(j+1)*A + i+1];
+			core::vector3df n = (r[1] - r[-1]).crossProduct(r[A] - r[-A]);
+			nodo->posicion[j*T+i] = *r;
+			nodo->normal[j*T+i] = n.normalize();
+		}
+	}
+
+	// En la malla del padre los vertices impares caen a mitad de sus
+	// vecinos pares: en la arista si son impares en un eje y en la diagonal
+	// si lo son en los dos
+	for ( int j = 0 ; j < T ; ++j )
+	{
+		for ( int i = 0 ; i < T ; ++i )
+		{
+			int a = j*T+i;
+			int b = a;
+			if ( (i & 1) && (j & 1) )
+			{
+				a = (j-1)*T + i-1;
+				b = (j+1)*T + i+1;
+			}
+			else if ( i & 1 )
+			{
+				a = j*T + i-1;
+				b = j*T + i+1;
+			}
+			else if ( j & 1 )
+			{
+				a = (j-1)*T + i;
+				b = (j+1)*T + i;
+			}
+
+			nodo->posicionPadre[j*T+i] = (nodo->posicion[a] + nodo->posicion[b])*0.5f;
+			nodo->normalPadre[j*T+i] = (nodo->normal[a] + nodo->normal[b]).normalize();
+
+			video::S3DVertex &v = nodo->vertices[j*T+i];
+			v.Pos = nodo->posicion[j*T+i];
+			v.Normal = nodo->normal[j*T+i];
+			v.Color = color;
+			v.TCoords = core::vector2df(i/(f32)(T-1), j/(f32)(T-1));
+		}
+	}
+	nodo->frameInterpolado = -1;
+}
+
+void
+EsferaCubo::LiberarVertices(Nodo *nodo)
+{
+	if ( nodo->vertices == NULL )
+	{
+		return;
+	}
+
+	delete [] nodo->posicion;
+	delete [] nodo->normal;
+	delete [] nodo->posicionPadre;
+	delete [] nodo->normalPadre;
+	delete [] nodo->vertices;
+	nodo->posicion = NULL;
+	nodo->normal = NULL;
+	nodo->posicionPadre = NULL;
+	nodo->normalPadre = NULL;
+	nodo->vertices = NULL;
+	nodosConVertices--;
+}
+
+void
+EsferaCubo::BorrarNodo(Nodo *nodo)
+{
+	for ( int q = 0 ; q < 4 ; ++q )
+	{
+		if ( nodo->hijos[q] )
+		{
+			BorrarNodo(nodo->hijos[q]);
+		}
+	}
+	LiberarVertices(nodo);
+	delete nodo;
+}
+
+void
+EsferaCubo::Podar(Nodo *nodo)
+{
+	for ( int q = 0 ; q < 4 ; ++q )
+	{
+		Nodo *hijo = nodo->hijos[q];
+		if ( hijo == NULL )
+		{
+			continue;
+		}
+
+		// Si el hijo no se ha visitado, sus hijos tampoco
+		Podar(hijo);
+		if ( frame - hijo->ultimoFrame > FRAMES_DESCARGA )
+		{
+			BorrarNodo(hijo);
+			nodo->hijos[q] = NULL;
+		}
+	}
+
+	if ( nodo->nivel > 0 && frame - nodo->ultimoFrame > FRAMES_DESCARGA )
+	{
+		LiberarVertices(nodo);
+	}
+}
+
+bool
+EsferaCubo::Seleccionar(Nodo *nodo, const core::vector3df &ojo, const core::matrix4 &transformacion,
+	const core::aabbox3d<f32> *vista, video::IVideoDriver *driver)
+{
+	f32 distancia = DistanciaCaja(ojo, nodo->box);
+	if ( distancia > rango[nodo->nivel] )
+	{
+		return false;
+	}
+	nodo->ultimoFrame = frame;
+
+	// Fuera de la vista no se dibuja ni el ni sus hijos
+	if ( vista )
+	{
+		core::aabbox3d<f32> caja = nodo->box;
+		transformacion.transformBoxEx(caja);
+		if ( !caja.intersectsWithBox(*vista) )
+		{
+			return true;
+		}
+	}
+
+	// Los hijos estan dentro de la caja del nodo: si esta ya queda fuera del
+	// rango de los hijos, ninguno lo esta
+	if ( nodo->nivel+1 == niveles || distancia > rango[nodo->nivel+1] )
+	{
+		DibujarParte(nodo, TODO, ojo, driver);
+		return true;
+	}
+
+	int mitad = nodo->lado/2;
+	for ( int q = 0 ; q < 4 ; ++q )
+	{
+		if ( nodo->hijos[q] == NULL )
+		{
+			nodo->hijos[q] = CrearNodo(nodo->cara, nodo->nivel+1, nodo->x0 + (q & 1)*mitad, nodo->y0 + (q >> 1)*mitad);
+		}
+		if ( !Seleccionar(nodo->hijos[q], ojo, transformacion, vista, driver) )
+		{
+			DibujarParte(nodo, (PARTE)q, ojo, driver);
+		}
+	}
+	return true;
+}
+
+void
+EsferaCubo::DibujarParte(Nodo *nodo, PARTE parte, const core::vector3df &ojo, video::IVideoDriver *driver)
+{
+	const int T = TAM_NODO;
+
+	if ( nodo->vertices == NULL )
+	{
+		CalcularVertices(nodo);
+	}
+	nodo->ultimoFrame = frame;
+
+	// Interpolamos cada vertice hacia la malla del padre segun su distancia,
+	// una vez por frame aunque se dibujen varios cuartos
+	if ( nodo->frameInterpolado != frame )
+	{
+		f32 fin = rango[nodo->nivel];
+		f32 inicio = fin*INICIO_MORPH;
+		for ( int n = 0 ; n < T*T ; ++n )
+		{
+			f32 k = Acotar(((f32)nodo->posicion[n].getDistanceFrom(ojo) - inicio) / (fin - inicio), 0.0f, 1.0f);
+			video::S3DVertex &v = nodo->vertices[n];
+			v.Pos = nodo->posicion[n] + (nodo->posicionPadre[n] - nodo->posicion[n])*k;
+			v.Normal = nodo->normal[n] + (nodo->normalPadre[n] - nodo->normal[n])*k;
+			v.Normal.normalize();
+			v.Color = color;
+		}
+		nodo->frameInterpolado = frame;
+	}
+
+	if ( salida )
+	{
+		for ( int i = 0 ; i < numIndices[parte] ; i += 3 )
+		{
+			core::triangle3df t;
+			t.set(nodo->vertices[ indices[parte][i+0] ].Pos,
+				nodo->vertices[ indices[parte][i+1] ].Pos,
+				nodo->vertices[ indices[parte][i+2] ].Pos);
+			salida->push_back(t);
+		}
+	}
+	else
+	{
+		driver->drawIndexedTriangleList(nodo->vertices, T*T, indices[parte], numIndices[parte]/3);
+	}
+	triangulosDibujados += numIndices[parte]/3;
+}
+
+void
+EsferaCubo::Dibujar(video::IVideoDriver *driver, const core::matrix4 &transformacion, scene::ICameraSceneNode *camara)
+{
+	// Posicion de la camara en coordenadas del planeta; sin camara todo se
+	// ve desde lejos
+	core::vector3df ojo(rango[0]*4.0f, 0.0f, 0.0f);
+	core::matrix4 inversa;
+	if ( camara && transformacion.getInverse(inversa) )
+	{
+		ojo = camara->getAbsolutePosition();
+		inversa.transformVect(ojo);
+	}
+
+	core::aabbox3d<f32> vista;
+	if ( camara )
+	{
+		vista = camara->getViewFrustrum()->getBoundingBox();
+	}
+
+	Recorrer(ojo, transformacion, camara ? &vista : NULL, driver);
+}
+
+void
+EsferaCubo::GetTriangulos(const core::vector3df &ojo, core::array<core::triangle3df> &triangulos)
+{
+	salida = &triangulos;
+	Recorrer(ojo, core::matrix4(), NULL, NULL);
+	salida = NULL;
+}
+
+void
+EsferaCubo::Recorrer(const core::vector3df &ojo, const core::matrix4 &transformacion,
+	const core::aabbox3d<f32> *vista, video::IVideoDriver *driver)
+{
+	frame++;
+	triangulosDibujados = 0;
+
+	for ( int cara = 0 ; cara < 6 ; ++cara )
+	{
+		Nodo *raiz = raices[cara];
+		if ( Seleccionar(raiz, ojo, transformacion, vista, driver) )
+		{
+			continue;
+		}
+
+		// Fuera del rango de la raiz: la cara a media resolucion, que es la
+		// malla a la que ya se ha interpolado la raiz
+		core::aabbox3d<f32> caja = raiz->box;
+		transformacion.transformBoxEx(caja);
+		if ( vista == NULL || caja.intersectsWithBox(*vista) )
+		{
+			DibujarParte(raiz, MITAD, ojo, driver);
+		}
+	}
+
+	if ( frame % (FRAMES_DESCARGA/4) == 0 )
+	{
+		for ( int cara = 0 ; cara < 6 ; ++cara )
+		{
+			Podar(raices[cara]);
+		}
+	}
+}
+
+core::aabbox3d<f32>
+EsferaCubo::GetBoundingBox() const
+{
+	core::aabbox3d<f32> box = raices[0]->box;
+	for ( int cara = 1 ; cara < 6 ; ++cara )
+	{
+		box.addInternalBox(raices[cara]->box);
+	}
+	return box;
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <irrlicht.h>
+
+class GeneradorPlaneta;
+
+// Malla de un planeta hecha con un cubo subdividido y proyectado a la
+// esfera. Cada cara es un quadtree de nodos de TAM_NODO x TAM_NODO vertices,
+// y el detalle se elige por distancia a la camara al estilo CDLOD:
+//   - Un nodo del nivel L se dibuja mientras su caja este a menos de
+//     rango[L] del ojo, y cede su sitio (por cuartos) a los hijos que esten
+//     a menos de rango[L+1] = rango[L]/2.
+//   - Al acercarse a rango[L] cada vertice se desplaza hacia donde estaria en
+//     la malla del padre (los impares a la mitad de sus vecinos pares), asi
+//     que al cambiar de nivel no hay saltos ni grietas entre nodos vecinos.
+//     Irrlicht no tiene aqui sombreadores de vertices, asi que la
+//     interpolacion se hace en la CPU sobre los vertices de cada nodo
+//     dibujado.
+//   - Mas alla de rango[0] cada cara se dibuja con la mitad de resolucion:
+//     un planeta lejano son 6 x 32 triangulos.
+// Los vertices de un nodo se calculan al crearlo, porque de ellos sale su
+// caja, y se liberan si pasa FRAMES_DESCARGA frames sin dibujarse. Como todos los nodos
+// tienen TAM_NODO^2 vertices, los indices son de 16 bits sea cual sea la
+// resolucion total.
+class EsferaCubo
+{
+public:
+	// Vertices por lado de cada nodo (potencia de 2 mas 1)
+	static const int TAM_NODO = 9;
+
+	// Niveles de cada quadtree como mucho (el 0 es la cara entera)
+	static const int MAX_NIVELES = 12;
+
+	// Frames que un nodo conserva sus vertices sin dibujarse
+	static const int FRAMES_DESCARGA = 300;
+
+	// rango[L] en diagonales de los nodos del nivel L. Por debajo de 2.5 los
+	// nodos vecinos de niveles distintos podrian no estar ya interpolados en
+	// el borde que comparten.
+	static const float RANGO_MINIMO;
+
+	// Fraccion de rango[L] a partir de la que empieza la interpolacion
+	static const float INICIO_MORPH;
+
+private:
+	struct Nodo
+	{
+		int cara;
+		int nivel;
+		// Esquina y lado en celdas del nivel mas fino
+		int x0;
+		int y0;
+		int lado;
+
+		irr::core::aabbox3d<irr::f32> box;
+		Nodo *hijos[4];
+
+		// Posiciones y normales propias y en la malla del padre, y los
+		// vertices interpolados que se dibujan (NULL hasta que hacen falta)
+		irr::core::vector3df *posicion;
+		irr::core::vector3df *normal;
+		irr::core::vector3df *posicionPadre;
+		irr::core::vector3df *normalPadre;
+		irr::video::S3DVertex *vertices;
+
+		int ultimoFrame;
+		// Frame en el que se interpolaron los vertices por ultima vez
+		int frameInterpolado;
+	};
+
+	// Cuarto de un nodo que se dibuja, o TODO, o MITAD (nodo raiz a la mitad
+	// de resolucion)
+	enum PARTE
+	{
+		CUARTO_0 = 0,
+		CUARTO_1,
+		CUARTO_2,
+		CUARTO_3,
+		TODO,
+		MITAD,
+
+		NUM_PARTES
+	};
+
+	static const int NUM_INDICES_TODO = (TAM_NODO-1)*(TAM_NODO-1)*6;
+
+	GeneradorPlaneta *alturas;
+	float radioMaximo;
+
+	int niveles;
+	int celdasCara;
+	Nodo *raices[6];
+	float rango[MAX_NIVELES];
+
+	// Indices de cada parte (las de cuarto y mitad usan los primeros)
+	irr::u16 indices[NUM_PARTES][NUM_INDICES_TODO];
+	int numIndices[NUM_PARTES];
+
+	irr::video::SColor color;
+	int frame;
+	int triangulosDibujados;
+	int nodosConVertices;
+
+	// Con GetTriangulos, donde van los triangulos en vez de a la tarjeta
+	irr::core::array<irr::core::triangle3df> *salida;
+
+	// Posicion en la esfera unidad de un punto de la rejilla de una cara (en
+	// celdas del nivel mas fino, puede salirse de la cara)
+	irr::core::vector3df Direccion(int cara, int x, int y) const;
+
+	void CrearIndices();
+	Nodo *CrearNodo(int cara, int nivel, int x0, int y0);
+	void CalcularVertices(Nodo *nodo);
+	void LiberarVertices(Nodo *nodo);
+	void BorrarNodo(Nodo *nodo);
+	void Podar(Nodo *nodo);
+
+	// Elige las partes que se dibujan del nodo y sus hijos; false si el nodo
+	// esta fuera de su rango y lo tiene que dibujar el padre
+	bool Seleccionar(Nodo *nodo, const irr::core::vector3df &ojo, const irr::core::matrix4 &transformacion,
+		const irr::core::aabbox3d<irr::f32> *vista, irr::video::IVideoDriver *driver);
+	void DibujarParte(Nodo *nodo, PARTE parte, const irr::core::vector3df &ojo, irr::video::IVideoDriver *driver);
+
+	// Un frame de Dibujar con el ojo ya en coordenadas del planeta; sin vista
+	// no se recorta nada
+	void Recorrer(const irr::core::vector3df &ojo, const irr::core::matrix4 &transformacion,
+		const irr::core::aabbox3d<irr::f32> *vista, irr::video::IVideoDriver *driver);
+
+public:
+	// Se queda con alturas (alturas de la orografia, 10 es el radio 1).
+	// distanciaLOD: rango[0] en unidades del planeta; niveles: niveles de los
+	// quadtrees
+	EsferaCubo(GeneradorPlaneta *alturas, int niveles = 8, float distanciaLOD = 6.0f);
+	virtual ~EsferaCubo(void);
+
+	// transformacion: la del nodo de escena, para pasar la camara a
+	// coordenadas del planeta y las cajas al mundo
+	void Dibujar(irr::video::IVideoDriver *driver, const irr::core::matrix4 &transformacion,
+		irr::scene::ICameraSceneNode *camara);
+
+	// Los triangulos que dibujaria un frame con el ojo en ojo (en
+	// coordenadas del planeta) y sin recortar por la vista, para comprobar
+	// la malla sin tarjeta (genterr -verificar)
+	void GetTriangulos(const irr::core::vector3df &ojo, irr::core::array<irr::core::triangle3df> &triangulos);
+
+	void SetColor(irr::video::SColor c)
+	{
+		color = c;
+	}
+
+	irr::core::aabbox3d<irr::f32> GetBoundingBox() const;
+
+	int GetTriangulosDibujados() const
+	{
+		return triangulosDibujados;
+	}
+
+	int GetNodosConVertices() const
+	{
+		return nodosConVertices;
+	}
+};
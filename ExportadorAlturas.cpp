@@ -0,0 +1,247 @@
+#include "ExportadorAlturas.h"
+
+#include "GeneradorTerreno.h"
+#include "MosaicoAlturas.h"
+
+#include <stdio.h>
+#include <string.h>
+using namespace irr;
+
+// ---------------------------------------------------------------------------
+// Fuentes
+// ---------------------------------------------------------------------------
+
+void
+FuenteAlturas::GetRango(float &minimo, float &maximo) const
+{
+	int W = GetAncho();
+	float *fila = new float[W];
+
+	LeerFila(0, fila);
+	minimo = fila[0];
+	maximo = fila[0];
+	for ( int y = 0 ; y < GetAlto() ; ++y )
+	{
+		LeerFila(y, fila);
+		for ( int x = 0 ; x < W ; ++x )
+		{
+			minimo = core::min_(minimo, fila[x]);
+			maximo = core::max_(maximo, fila[x]);
+		}
+	}
+
+	delete [] fila;
+}
+
+int
+FuenteGenerador::GetAncho() const
+{
+	return generador.GetAncho();
+}
+
+int
+FuenteGenerador::GetAlto() const
+{
+	return generador.GetAlto();
+}
+
+void
+FuenteGenerador::LeerFila(int y, float *fila) const
+{
+	memcpy(fila, &generador.GetAlturas()[y*generador.GetAncho()], generador.GetAncho()*sizeof(float));
+}
+
+int
+FuenteMosaico::GetAncho() const
+{
+	return lector.GetAncho();
+}
+
+int
+FuenteMosaico::GetAlto() const
+{
+	return lector.GetAlto();
+}
+
+void
+FuenteMosaico::LeerFila(int y, float *fila) const
+{
+	lector.LeerVentana(fila, 0, y, lector.GetAncho(), 1);
+}
+
+void
+FuenteMosaico::GetRango(float &minimo, float &maximo) const
+{
+	minimo = lector.GetMinimo(0, 0);
+	maximo = lector.GetMaximo(0, 0);
+	for ( int my = 0 ; my < lector.GetMosaicosY() ; ++my )
+	{
+		for ( int mx = 0 ; mx < lector.GetMosaicosX() ; ++mx )
+		{
+			minimo = core::min_(minimo, lector.GetMinimo(mx, my));
+			maximo = core::max_(maximo, lector.GetMaximo(mx, my));
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+// ExportadorAlturas
+// ---------------------------------------------------------------------------
+
+// Convierte una fila de alturas a muestras de 16 bits
+static void
+Cuantizar(const float *fila, u16 *muestras, int W, float minimo, float maximo)
+{
+	float escala = maximo > minimo ? 65535.0f / (maximo - minimo) : 0.0f;
+	for ( int x = 0 ; x < W ; ++x )
+	{
+		float q = (fila[x] - minimo) * escala;
+		q = core::min_(core::max_(q, 0.0f), 65535.0f);
+		muestras[x] = (u16)(q + 0.5f);
+	}
+}
+
+// Escribe las filas de la fuente en 16 bits con el orden de bytes indicado
+static bool
+EscribirMuestras(FILE *f, const FuenteAlturas &fuente, float minimo, float maximo, bool bigEndian)
+{
+	int W = fuente.GetAncho();
+	float *fila = new float[W];
+	u16 *muestras = new u16[W];
+	unsigned char *bytes = new unsigned char[W*2];
+
+	bool ok = true;
+	for ( int y = 0 ; ok && y < fuente.GetAlto() ; ++y )
+	{
+		fuente.LeerFila(y, fila);
+		Cuantizar(fila, muestras, W, minimo, maximo);
+		for ( int x = 0 ; x < W ; ++x )
+		{
+			unsigned char alto = (unsigned char)(muestras[x] >> 8);
+			unsigned char bajo = (unsigned char)(muestras[x] & 0xFF);
+			bytes[x*2+0] = bigEndian ? alto : bajo;
+			bytes[x*2+1] = bigEndian ? bajo : alto;
+		}
+		ok = fwrite(bytes, 1, W*2, f) == (size_t)W*2;
+	}
+
+	delete [] bytes;
+	delete [] muestras;
+	delete [] fila;
+	return ok;
+}
+
+ExportadorAlturas::FORMATO
+ExportadorAlturas::FormatoDeFichero(const char *fichero)
+{
+	static const char *EXTENSIONES[NUM_FORMATOS] = { ".raw", ".pgm", ".png" };
+
+	size_t n = strlen(fichero);
+	for ( int i = 0 ; i < NUM_FORMATOS ; ++i )
+	{
+		size_t e = strlen(EXTENSIONES[i]);
+		if ( n >= e && strcmp(fichero + n - e, EXTENSIONES[i]) == 0 )
+		{
+			return (FORMATO)i;
+		}
+	}
+	return NUM_FORMATOS;
+}
+
+bool
+ExportadorAlturas::Exportar(const char *fichero, FORMATO formato, const FuenteAlturas &fuente,
+	video::IVideoDriver *driver)
+{
+	switch (formato)
+	{
+	case FORMATO_RAW16:
+		return GuardarRAW16(fichero, fuente);
+	case FORMATO_PGM16:
+		return GuardarPGM16(fichero, fuente);
+	case FORMATO_PNG:
+		return GuardarPNG(fichero, fuente, driver);
+	default:
+		return false;
+	}
+}
+
+bool
+ExportadorAlturas::GuardarRAW16(const char *fichero, const FuenteAlturas &fuente)
+{
+	float minimo, maximo;
+	fuente.GetRango(minimo, maximo);
+
+	FILE *f = fopen(fichero, "wb");
+	if ( f == NULL )
+	{
+		return false;
+	}
+
+	bool ok = EscribirMuestras(f, fuente, minimo, maximo, false);
+	return fclose(f) == 0 && ok;
+}
+
+bool
+ExportadorAlturas::GuardarPGM16(const char *fichero, const FuenteAlturas &fuente)
+{
+	float minimo, maximo;
+	fuente.GetRango(minimo, maximo);
+
+	FILE *f = fopen(fichero, "wb");
+	if ( f == NULL )
+	{
+		return false;
+	}
+
+	bool ok = fprintf(f, "P5\n# alturas %.9g %.9g\n%d %d\n65535\n",
+		minimo, maximo, fuente.GetAncho(), fuente.GetAlto()) > 0;
+	ok = ok && EscribirMuestras(f, fuente, minimo, maximo, true);
+	return fclose(f) == 0 && ok;
+}
+
+bool
+ExportadorAlturas::GuardarPNG(const char *fichero, const FuenteAlturas &fuente, video::IVideoDriver *driver)
+{
+	if ( driver == NULL )
+	{
+		return false;
+	}
+
+	float minimo, maximo;
+	fuente.GetRango(minimo, maximo);
+
+	int W = fuente.GetAncho();
+	int H = fuente.GetAlto();
+	float *fila = new float[W];
+	u16 *muestras = new u16[W];
+
+	// La imagen se queda con el buffer y lo libera al soltarla
+	u8 *pixeles = new u8[W*H*3];
+	for ( int y = 0 ; y < H ; ++y )
+	{
+		fuente.LeerFila(y, fila);
+		Cuantizar(fila, muestras, W, minimo, maximo);
+		u8 *p = &pixeles[y*W*3];
+		for ( int x = 0 ; x < W ; ++x )
+		{
+			p[x*3+0] = (u8)(muestras[x] >> 8);
+			p[x*3+1] = (u8)(muestras[x] & 0xFF);
+			p[x*3+2] = 0;
+		}
+	}
+
+	delete [] muestras;
+	delete [] fila;
+
+	video::IImage *imagen = driver->createImageFromData(video::ECF_R8G8B8,
+		core::dimension2d<s32>(W, H), pixeles, true);
+	if ( imagen == NULL )
+	{
+		delete [] pixeles;
+		return false;
+	}
+
+	bool ok = driver->writeImageToFile(imagen, fichero);
+	imagen->drop();
+	return ok;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <irrlicht.h>
+
+class GeneradorTerreno;
+class LectorMosaico;
+
+// Origen de las alturas que se exportan. Se leen fila a fila, asi que el
+// exportador nunca tiene una segunda copia del mapa entero.
+class FuenteAlturas
+{
+public:
+	virtual ~FuenteAlturas(void)
+	{
+	}
+
+	virtual int GetAncho() const = 0;
+	virtual int GetAlto() const = 0;
+
+	// Copia en fila las GetAncho() alturas de la fila y
+	virtual void LeerFila(int y, float *fila) const = 0;
+
+	// Rango de alturas. Por defecto recorre todas las filas una vez.
+	virtual void GetRango(float &minimo, float &maximo) const;
+};
+
+class FuenteGenerador : public FuenteAlturas
+{
+private:
+	const GeneradorTerreno &generador;
+
+public:
+	FuenteGenerador(const GeneradorTerreno &generador) : generador(generador)
+	{
+	}
+
+	virtual int GetAncho() const;
+	virtual int GetAlto() const;
+	virtual void LeerFila(int y, float *fila) const;
+};
+
+class FuenteMosaico : public FuenteAlturas
+{
+private:
+	const LectorMosaico &lector;
+
+public:
+	FuenteMosaico(const LectorMosaico &lector) : lector(lector)
+	{
+	}
+
+	virtual int GetAncho() const;
+	virtual int GetAlto() const;
+	virtual void LeerFila(int y, float *fila) const;
+
+	// Sale del indice del fichero, sin leer ninguna altura
+	virtual void GetRango(float &minimo, float &maximo) const;
+};
+
+// Exporta mapas de alturas a formatos de 16 bits. Las alturas se escalan de
+// su rango [minimo, maximo] a [0, 65535].
+//   - RAW16: muestras sin cabecera, little endian
+//   - PGM16: PGM binario (P5) con maximo 65535, big endian como manda el
+//     formato. El rango real va en un comentario "# alturas <min> <max>".
+//   - PNG: a traves de IVideoDriver::writeImageToFile. Irrlicht solo tiene
+//     imagenes de 8 bits por canal, asi que se guarda en RGB con el byte
+//     alto en R y el bajo en G, y la imagen (3 bytes por muestra) si tiene
+//     que estar entera en memoria.
+// RAW16 y PGM16 se escriben fila a fila, tras una pasada para el rango.
+class ExportadorAlturas
+{
+public:
+	enum FORMATO
+	{
+		FORMATO_RAW16 = 0,
+		FORMATO_PGM16,
+		FORMATO_PNG,
+
+		NUM_FORMATOS
+	};
+
+	// Formato segun la extension (.raw, .pgm o .png), o NUM_FORMATOS
+	static FORMATO FormatoDeFichero(const char *fichero);
+
+	// driver solo hace falta para FORMATO_PNG
+	static bool Exportar(const char *fichero, FORMATO formato, const FuenteAlturas &fuente,
+		irr::video::IVideoDriver *driver = NULL);
+
+	static bool GuardarRAW16(const char *fichero, const FuenteAlturas &fuente);
+	static bool GuardarPGM16(const char *fichero, const FuenteAlturas &fuente);
+	static bool GuardarPNG(const char *fichero, const FuenteAlturas &fuente, irr::video::IVideoDriver *driver);
+};
@@ -1,19 +1,18 @@
 #pragma once
 #include <irrlicht.h>
+
+#include "MallaEsfera.h"
 using namespace irr;
 
 class FondoEspacialNode :
 	public irr::scene::ISceneNode
 {
 private:
-	irr::core::aabbox3d<irr::f32> box;
-	irr::video::S3DVertex *vertices;
+	MallaEsfera *malla;
 	irr::video::SMaterial material;
-	irr::u16 *indices ;
 
 	static const int NUM_PARALELOS = 15;
 	static const int NUM_MERIDIANOS = 30;
-	int NUM_VERTICES;
 
 public:
 	FondoEspacialNode(irr::scene::ISceneNode* parent, irr::scene::ISceneManager* mgr, irr::s32 id);
@@ -24,7 +23,7 @@ public:
 
 	virtual const irr::core::aabbox3d<irr::f32>& getBoundingBox() const
 	{
-		return box;
+		return malla->GetBoundingBox();
 	}
 
 	virtual irr::s32 getMaterialCount()
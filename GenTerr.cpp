@@ -0,0 +1,548 @@
+// Generador de terrenos por lotes, sin ventana ni dispositivo de Irrlicht.
+//
+// Uso: genterr [-semilla N] [-tam N] [-bultos N] [-mapas N] [-hilos N]
+//              [-operador arcotangente|paraboloide|potencial]
+//              [-simd escalar|sse2|avx2] [-mosaico u16|f32] [-exportar raw|pgm]
+//              [-importar FICHERO MIN MAX] [-planeta PUNTOS [-vecinos K]]
+//              [-salida DIR]
+//        genterr -verificar
+//
+// Genera "mapas" terrenos de tam x tam con el mismo algoritmo que SolNode,
+// empezando por la semilla de 64 bits indicada (un mapa por semilla), y
+// guarda las alturas de cada uno como floats de 32 bits en
+// DIR/terreno_<semilla>.r32. Con -mosaico se guardan en cambio en el formato
+// por mosaicos de MosaicoAlturas (DIR/terreno_<semilla>.mosaico), que puede
+// abrir SolNode directamente. -exportar escribe ademas cada mapa en 16 bits
+// (DIR/terreno_<semilla>.raw o .pgm) con ExportadorAlturas.
+// -importar parte de un mapa .raw o .pgm (ImportadorAlturas) con alturas de
+// MIN a MAX, remuestreado a tam x tam, y le suma los bultos como detalle.
+// -planeta genera en cambio la orografia de un planeta con PUNTOS puntos de
+// control (GeneradorPlaneta), en proyeccion equirectangular, sobre los K
+// puntos mas cercanos a cada vertice (0 = todos); se guarda como
+// DIR/planeta_<semilla>.*
+// Con -hilos los bultos de cada mapa se acumulan en paralelo (0 = todos los
+// nucleos); el resultado es el mismo que con un hilo.
+// -simd limita las instrucciones vectoriales de los operadores (por defecto
+// las mejores de la CPU) y -verificar compara cada version vectorial con la
+// escalar y comprueba que el error esta dentro de las cotas, y que la malla
+// de EsferaCubo no tiene grietas entre niveles de detalle.
+// Al acabar muestra el rendimiento en mapas por segundo y por nucleo.
+
+#include "GeneradorTerreno.h"
+#include "MosaicoAlturas.h"
+#include "ExportadorAlturas.h"
+#include "ImportadorAlturas.h"
+#include "GeneradorPlaneta.h"
+#include "ArenaMemoria.h"
+#include "EsferaCubo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <map>
+
+using namespace irr;
+using namespace std::chrono;
+
+static double
+Segundos(steady_clock::time_point desde)
+{
+	return duration_cast<duration<double> >(steady_clock::now() - desde).count();
+}
+
+static const char *NOMBRES_OPERADOR[NUM_OPERADORES] = { "arcotangente", "paraboloide", "potencial" };
+static const char *NOMBRES_SIMD[3] = { "escalar", "sse2", "avx2" };
+static const char *NOMBRES_MUESTRA[NUM_TIPOS_MUESTRA] = { "u16", "f32" };
+static const char *NOMBRES_EXPORTAR[2] = { "raw", "pgm" };
+
+// Lado de los mosaicos con -mosaico (el de los parches de SolNode)
+static const int TAM_MOSAICO = 128;
+
+static void
+Uso()
+{
+	printf("Uso: genterr [-semilla N] [-tam N] [-bultos N] [-mapas N] [-hilos N]\n");
+	printf("             [-operador arcotangente|paraboloide|potencial]\n");
+	printf("             [-simd escalar|sse2|avx2] [-mosaico u16|f32] [-exportar raw|pgm]\n");
+	printf("             [-importar FICHERO MIN MAX] [-planeta PUNTOS [-vecinos K]]\n");
+	printf("             [-salida DIR]\n");
+	printf("       genterr -verificar\n");
+}
+
+static int
+BuscarNombre(const char *nombre, const char **nombres, int n)
+{
+	for ( int i = 0 ; i < n ; ++i )
+	{
+		if ( strcmp(nombre, nombres[i]) == 0 )
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Distancia del punto p al segmento ab
+static float
+DistanciaSegmento(const core::vector3df &p, const core::vector3df &a, const core::vector3df &b)
+{
+	core::vector3df ab = b - a;
+	f32 l2 = ab.dotProduct(ab);
+	f32 t = l2 > 0.0f ? (p - a).dotProduct(ab) / l2 : 0.0f;
+	t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+	return (f32)p.getDistanceFrom(a + ab*t);
+}
+
+// Arista de la malla por sus extremos, en cualquier orden
+struct Arista
+{
+	core::vector3df a;
+	core::vector3df b;
+
+	static bool Menor(const core::vector3df &p, const core::vector3df &q)
+	{
+		if ( p.X != q.X ) return p.X < q.X;
+		if ( p.Y != q.Y ) return p.Y < q.Y;
+		return p.Z < q.Z;
+	}
+
+	Arista(const core::vector3df &p, const core::vector3df &q) : a(Menor(p, q) ? p : q), b(Menor(p, q) ? q : p)
+	{
+	}
+
+	bool operator<(const Arista &o) const
+	{
+		if ( Menor(a, o.a) ) return true;
+		if ( Menor(o.a, a) ) return false;
+		return Menor(b, o.b);
+	}
+};
+
+// Mira la malla de EsferaCubo desde varias distancias. Las aristas que
+// no comparten dos triangulos son las del borde entre nodos de distinto
+// nivel, y cada una tiene que estar sobre otra de esas aristas o contenerla;
+// si no, hay una grieta
+static bool
+VerificarEsferaCubo()
+{
+	const int PUNTOS = 50;
+	const float COTA = 1e-5f;
+	const float distancias[] = { 100.0f, 10.0f, 4.0f, 2.0f, 1.5f, 1.3f };
+	const int NUM_DISTANCIAS = sizeof(distancias)/sizeof(distancias[0]);
+
+	GeneradorPlaneta *orografia = new GeneradorPlaneta(PUNTOS);
+	Aleatorio aleatorio(7);
+	orografia->Sortear(aleatorio, PUNTOS);
+	EsferaCubo cubo(orografia);
+
+	core::vector3df direccion(1.0f, 0.6f, 0.3f);
+	direccion.normalize();
+
+	bool ok = true;
+	core::array<core::triangle3df> triangulos;
+	for ( int d = 0 ; d < NUM_DISTANCIAS ; ++d )
+	{
+		triangulos.set_used(0);
+		cubo.GetTriangulos(direccion*distancias[d], triangulos);
+
+		std::map<Arista, int> cuenta;
+		for ( u32 t = 0 ; t < triangulos.size() ; ++t )
+		{
+			const core::triangle3df &tri = triangulos[t];
+			cuenta[Arista(tri.pointA, tri.pointB)]++;
+			cuenta[Arista(tri.pointB, tri.pointC)]++;
+			cuenta[Arista(tri.pointC, tri.pointA)]++;
+		}
+
+		core::array<Arista *> sueltas;
+		bool cerrada = true;
+		for ( std::map<Arista, int>::iterator i = cuenta.begin() ; i != cuenta.end() ; ++i )
+		{
+			if ( i->second == 1 )
+			{
+				sueltas.push_back(const_cast<Arista *>(&i->first));
+			}
+			else if ( i->second > 2 )
+			{
+				cerrada = false;
+			}
+		}
+
+		float maxError = 0.0f;
+		for ( u32 i = 0 ; i < sueltas.size() ; ++i )
+		{
+			const Arista &e = *sueltas[i];
+			float mejor = -1.0f;
+			for ( u32 j = 0 ; j < sueltas.size() ; ++j )
+			{
+				if ( i == j )
+				{
+					continue;
+				}
+				const Arista &f = *sueltas[j];
+				float dentro = core::max_(DistanciaSegmento(e.a, f.a, f.b), DistanciaSegmento(e.b, f.a, f.b));
+				float contiene = core::max_(DistanciaSegmento(f.a, e.a, e.b), DistanciaSegmento(f.b, e.a, e.b));
+				float error = core::min_(dentro, contiene);
+				if ( mejor < 0.0f || error < mejor )
+				{
+					mejor = error;
+				}
+			}
+			if ( !(mejor >= 0.0f && mejor <= maxError) )
+			{
+				maxError = mejor < 0.0f ? 1.0f : mejor;
+			}
+		}
+
+		bool sinGrietas = cerrada && maxError <= COTA;
+		ok = ok && sinGrietas;
+		printf("EsferaCubo a %5.2f: %6d triangulos, %5d aristas sueltas, error maximo %.3g (cota %.3g) %s\n",
+			distancias[d], (int)triangulos.size(), (int)sueltas.size(), maxError, COTA, sinGrietas ? "ok" : "FALLO");
+	}
+	return ok;
+}
+
+// Aplica muchos bultos sueltos con cada version vectorial y con la escalar
+// y compara el error maximo con las cotas de OperadoresTerreno
+static bool
+Verificar()
+{
+	const int W = 203;
+	const int PRUEBAS = 2000;
+	const float cotas[NUM_OPERADORES] = {
+		OperadoresTerreno::ERROR_ARCOTANGENTE,
+		OperadoresTerreno::ERROR_PARABOLOIDE,
+		OperadoresTerreno::ERROR_POTENCIAL };
+	// El potencial se mide en error relativo
+	const bool relativo[NUM_OPERADORES] = { false, false, true };
+
+	float referencia[W];
+	float vectorial[W];
+	bool ok = true;
+
+	OperadoresTerreno::NIVEL maximo = OperadoresTerreno::Detectar();
+	printf("CPU: %s\n", OperadoresTerreno::NombreNivel(maximo));
+
+	for ( int n = OperadoresTerreno::NIVEL_SSE2 ; n <= maximo ; ++n )
+	{
+		OperadoresTerreno::NIVEL nivel = (OperadoresTerreno::NIVEL)n;
+		for ( int op = 0 ; op < NUM_OPERADORES ; ++op )
+		{
+			GeneradorTerreno generador(W, W);
+			OperadoresTerreno::FuncionFila escalar = OperadoresTerreno::GetFuncion((TIPO_OPERADOR)op, OperadoresTerreno::NIVEL_ESCALAR);
+			OperadoresTerreno::FuncionFila simd = OperadoresTerreno::GetFuncion((TIPO_OPERADOR)op, nivel);
+
+			Aleatorio aleatorio(op+1);
+			float maxError = 0.0f;
+			for ( int i = 0 ; i < PRUEBAS ; ++i )
+			{
+				BultoTerreno b = generador.SortearBulto(aleatorio, (TIPO_OPERADOR)op);
+				float y = (float)aleatorio.Entero(W);
+
+				memset(referencia, 0, sizeof(referencia));
+				memset(vectorial, 0, sizeof(vectorial));
+				escalar(referencia, W, y, b);
+				simd(vectorial, W, y, b);
+
+				for ( int x = 0 ; x < W ; ++x )
+				{
+					float error = fabs(vectorial[x] - referencia[x]);
+					if ( relativo[op] && referencia[x] != 0.0f )
+					{
+						error /= fabs(referencia[x]);
+					}
+					if ( !(error <= maxError) )
+					{
+						maxError = error;
+					}
+				}
+			}
+
+			bool dentro = maxError <= cotas[op];
+			ok = ok && dentro;
+			printf("%-8s %-13s error maximo %.3g (cota %.3g) %s\n",
+				OperadoresTerreno::NombreNivel(nivel), NOMBRES_OPERADOR[op],
+				maxError, cotas[op], dentro ? "ok" : "FALLO");
+		}
+	}
+
+	// Saltar con Avanzar tiene que dar lo mismo que sacar los numeros uno a uno
+	Aleatorio paso(1234, 7);
+	Aleatorio salto(1234, 7);
+	for ( int i = 0 ; i < 1000 ; ++i )
+	{
+		paso.Siguiente();
+	}
+	salto.Avanzar(1000);
+	bool avanzarOk = paso.Siguiente() == salto.Siguiente();
+	ok = ok && avanzarOk;
+	printf("Aleatorio::Avanzar %s\n", avanzarOk ? "ok" : "FALLO");
+
+	// Las busquedas en el arbol de GeneradorPlaneta tienen que dar lo mismo
+	// que recorrer todos los puntos (en IDW_RADIO cambia el orden de la suma)
+	GeneradorPlaneta planeta(2000);
+	Aleatorio aleatorioPlaneta(99);
+	planeta.Sortear(aleatorioPlaneta, 2000);
+	for ( int modo = GeneradorPlaneta::IDW_VECINOS ; modo < GeneradorPlaneta::NUM_MODOS_IDW ; ++modo )
+	{
+		planeta.SetModo((GeneradorPlaneta::MODO_IDW)modo, 16, 0.1f);
+		float maxError = 0.0f;
+		for ( int i = 0 ; i < PRUEBAS ; ++i )
+		{
+			core::vector3df p(aleatorioPlaneta.Real()*2-1, aleatorioPlaneta.Real()*2-1, aleatorioPlaneta.Real()*2-1);
+			p.normalize();
+			float error = fabs(planeta.GetAltura(p) - planeta.GetAlturaDirecta(p));
+			if ( !(error <= maxError) )
+			{
+				maxError = error;
+			}
+		}
+		bool arbolOk = maxError <= 1e-4f;
+		ok = ok && arbolOk;
+		printf("GeneradorPlaneta %-7s error maximo %.3g %s\n", modo == GeneradorPlaneta::IDW_VECINOS ? "vecinos" : "radio",
+			maxError, arbolOk ? "ok" : "FALLO");
+	}
+
+	ok = VerificarEsferaCubo() && ok;
+
+	return ok;
+}
+
+// Orografia de un planeta en proyeccion equirectangular: la fila 0 es el
+// polo norte y la columna 0 y la ultima el meridiano 0
+static void
+GenerarPlaneta(Aleatorio &aleatorio, int numPuntos, int vecinos, ArenaMemoria &arena, GeneradorTerreno &destino)
+{
+	const float PI = 3.141592f;
+
+	arena.Vaciar();
+	GeneradorPlaneta planeta(numPuntos, arena);
+	planeta.Sortear(aleatorio, numPuntos);
+	if ( vecinos > 0 )
+	{
+		planeta.SetModo(GeneradorPlaneta::IDW_VECINOS, vecinos);
+	}
+
+	int W = destino.GetAncho();
+	int H = destino.GetAlto();
+	float *alturas = destino.GetAlturas();
+	for ( int y = 0 ; y < H ; ++y )
+	{
+		float latitud = PI/2 - PI*y/(H-1);
+		for ( int x = 0 ; x < W ; ++x )
+		{
+			float longitud = 2*PI*x/(W-1);
+			core::vector3df p(cos(latitud)*cos(longitud), sin(latitud), cos(latitud)*sin(longitud));
+			alturas[y*W+x] = planeta.GetAltura(p);
+		}
+	}
+}
+
+static bool
+GuardarAlturas(const char *fichero, const GeneradorTerreno &generador)
+{
+	FILE *f = fopen(fichero, "wb");
+	if ( f == NULL )
+	{
+		return false;
+	}
+
+	size_t n = generador.GetAncho()*generador.GetAlto();
+	bool ok = fwrite(generador.GetAlturas(), sizeof(float), n, f) == n;
+	fclose(f);
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	Aleatorio::Semilla semilla = 1;
+	int tam = 100;
+	int bultos = 10;
+	int mapas = 1;
+	int hilos = 1;
+	TIPO_OPERADOR operador = OPERADOR_ARCOTANGENTE;
+	const char *salida = ".";
+	int muestra = -1;
+	int exportar = -1;
+	const char *importar = NULL;
+	float importarMinimo = 0.0f;
+	float importarMaximo = 1.0f;
+	int planeta = 0;
+	int vecinos = 0;
+
+	for ( int i = 1 ; i < argc ; ++i )
+	{
+		if ( i+1 < argc && strcmp(argv[i], "-semilla") == 0 )
+		{
+			semilla = strtoull(argv[++i], NULL, 10);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-tam") == 0 )
+		{
+			tam = atoi(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-bultos") == 0 )
+		{
+			bultos = atoi(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-mapas") == 0 )
+		{
+			mapas = atoi(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-hilos") == 0 )
+		{
+			hilos = atoi(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-operador") == 0 )
+		{
+			int op = BuscarNombre(argv[++i], NOMBRES_OPERADOR, NUM_OPERADORES);
+			if ( op < 0 )
+			{
+				Uso();
+				return 1;
+			}
+			operador = (TIPO_OPERADOR)op;
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-simd") == 0 )
+		{
+			int nivel = BuscarNombre(argv[++i], NOMBRES_SIMD, 3);
+			if ( nivel < 0 )
+			{
+				Uso();
+				return 1;
+			}
+			OperadoresTerreno::SetNivel((OperadoresTerreno::NIVEL)nivel);
+		}
+		else if ( strcmp(argv[i], "-verificar") == 0 )
+		{
+			return Verificar() ? 0 : 1;
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-mosaico") == 0 )
+		{
+			muestra = BuscarNombre(argv[++i], NOMBRES_MUESTRA, NUM_TIPOS_MUESTRA);
+			if ( muestra < 0 )
+			{
+				Uso();
+				return 1;
+			}
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-exportar") == 0 )
+		{
+			exportar = BuscarNombre(argv[++i], NOMBRES_EXPORTAR, 2);
+			if ( exportar < 0 )
+			{
+				Uso();
+				return 1;
+			}
+		}
+		else if ( i+3 < argc && strcmp(argv[i], "-importar") == 0 )
+		{
+			importar = argv[++i];
+			importarMinimo = (float)atof(argv[++i]);
+			importarMaximo = (float)atof(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-planeta") == 0 )
+		{
+			planeta = atoi(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-vecinos") == 0 )
+		{
+			vecinos = atoi(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-salida") == 0 )
+		{
+			salida = argv[++i];
+		}
+		else
+		{
+			Uso();
+			return 1;
+		}
+	}
+
+	if ( tam < 2 || bultos < 0 || mapas < 1 || planeta < 0 || vecinos < 0 )
+	{
+		printf("Parametros fuera de rango\n");
+		return 1;
+	}
+
+	GeneradorTerreno generador(tam, tam);
+	generador.SetNumHilos(hilos);
+
+	const char *prefijo = planeta > 0 ? "planeta" : "terreno";
+	ArenaMemoria arena;
+	char fichero[1024];
+	double segundosGenerando = 0.0;
+	steady_clock::time_point inicio = steady_clock::now();
+
+	for ( int m = 0 ; m < mapas ; ++m )
+	{
+		steady_clock::time_point t0 = steady_clock::now();
+		Aleatorio aleatorio(semilla + m);
+		if ( planeta > 0 )
+		{
+			GenerarPlaneta(aleatorio, planeta, vecinos, arena, generador);
+		}
+		else if ( importar == NULL )
+		{
+			generador.Generar(aleatorio, bultos, operador);
+		}
+		else
+		{
+			if ( !ImportadorAlturas::Cargar(importar, importarMinimo, importarMaximo, generador) )
+			{
+				printf("No se pudo importar %s\n", importar);
+				return 1;
+			}
+			generador.AnadirBultos(aleatorio, bultos, operador);
+		}
+		segundosGenerando += Segundos(t0);
+
+		bool ok;
+		if ( muestra < 0 )
+		{
+			sprintf(fichero, "%s/%s_%llu.r32", salida, prefijo, semilla + m);
+			ok = GuardarAlturas(fichero, generador);
+		}
+		else
+		{
+			sprintf(fichero, "%s/%s_%llu.mosaico", salida, prefijo, semilla + m);
+			ok = EscritorMosaico::Guardar(fichero, generador, TAM_MOSAICO, (TIPO_MUESTRA)muestra);
+		}
+		if ( ok && exportar >= 0 )
+		{
+			sprintf(fichero, "%s/%s_%llu.%s", salida, prefijo, semilla + m, NOMBRES_EXPORTAR[exportar]);
+			ok = ExportadorAlturas::Exportar(fichero, ExportadorAlturas::FormatoDeFichero(fichero),
+				FuenteGenerador(generador));
+		}
+		if ( !ok )
+		{
+			printf("No se pudo escribir %s\n", fichero);
+			return 1;
+		}
+	}
+
+	double segundos = Segundos(inicio);
+
+	int nucleos = generador.GetNumHilos();
+	if ( planeta > 0 )
+	{
+		printf("%d planetas de %dx%d con %d puntos de control, %d vecinos\n", mapas, tam, tam, planeta, vecinos);
+		printf("Memoria: %u bytes por planeta, %d reservas del sistema en total\n",
+			(unsigned int)arena.GetBytesReservados(), arena.GetNumReservasSistema());
+	}
+	else
+	{
+		printf("%d mapas de %dx%d con %d bultos (%s), %d hilos, %s\n", mapas, tam, tam, bultos,
+			NOMBRES_OPERADOR[operador], nucleos, OperadoresTerreno::NombreNivel(OperadoresTerreno::GetNivel()));
+	}
+	printf("Tiempo total: %.3f s (generando %.3f s)\n", segundos, segundosGenerando);
+	if ( segundosGenerando > 0.0 )
+	{
+		printf("Rendimiento: %.2f mapas/s, %.2f mapas/s por nucleo\n",
+			mapas / segundosGenerando, mapas / segundosGenerando / nucleos);
+	}
+
+	return 0;
+}
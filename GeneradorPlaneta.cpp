@@ -0,0 +1,417 @@
+#include "GeneradorPlaneta.h"
+
+#include "Aleatorio.h"
+#include "ArenaMemoria.h"
+
+#include <algorithm>
+#include <math.h>
+using namespace irr;
+
+// Por debajo de esta distancia al cuadrado un vertice esta encima del punto
+static const float DISTANCIA_MINIMA2 = 1e-12f;
+
+static float
+Coordenada(const core::vector3df &v, int eje)
+{
+	return eje == 0 ? v.X : (eje == 1 ? v.Y : v.Z);
+}
+
+static float
+Distancia2(const core::vector3df &p, const core::vector3df &f)
+{
+	return (p.X-f.X)*(p.X-f.X) + (p.Y-f.Y)*(p.Y-f.Y) + (p.Z-f.Z)*(p.Z-f.Z);
+}
+
+// ---------------------------------------------------------------------------
+// Arbol k-d
+// ---------------------------------------------------------------------------
+
+class ComparadorEje
+{
+private:
+	int eje;
+
+public:
+	ComparadorEje(int eje) : eje(eje)
+	{
+	}
+
+	bool operator()(const GeneradorPlaneta::PuntoControl &a, const GeneradorPlaneta::PuntoControl &b) const
+	{
+		return Coordenada(a.pos, eje) < Coordenada(b.pos, eje);
+	}
+};
+
+// Ordena [a, b) de forma que la mediana quede en (a+b)/2, con los menores en
+// su coordenada eje delante y los mayores detras, y sigue con cada mitad
+static void
+Construir(GeneradorPlaneta::PuntoControl *arbol, int a, int b, int eje)
+{
+	if ( b - a <= 1 )
+	{
+		return;
+	}
+
+	int m = (a + b) / 2;
+	std::nth_element(arbol + a, arbol + m, arbol + b, ComparadorEje(eje));
+	Construir(arbol, a, m, (eje + 1) % 3);
+	Construir(arbol, m + 1, b, (eje + 1) % 3);
+}
+
+// Los puntos mas cercanos encontrados hasta ahora, de menor a mayor distancia
+struct Vecinos
+{
+	int maximo;
+	int n;
+	float d2[GeneradorPlaneta::MAX_VECINOS+1];
+	float altura[GeneradorPlaneta::MAX_VECINOS+1];
+};
+
+static void
+Insertar(Vecinos &v, float d2, float altura)
+{
+	if ( v.n == v.maximo && d2 >= v.d2[v.n-1] )
+	{
+		return;
+	}
+
+	int i = v.n < v.maximo ? v.n++ : v.n-1;
+	while ( i > 0 && v.d2[i-1] > d2 )
+	{
+		v.d2[i] = v.d2[i-1];
+		v.altura[i] = v.altura[i-1];
+		--i;
+	}
+	v.d2[i] = d2;
+	v.altura[i] = altura;
+}
+
+static void
+BuscarVecinos(const GeneradorPlaneta::PuntoControl *arbol, int a, int b, int eje,
+	const core::vector3df &p, Vecinos &v)
+{
+	if ( a >= b )
+	{
+		return;
+	}
+
+	int m = (a + b) / 2;
+	Insertar(v, Distancia2(p, arbol[m].pos), arbol[m].altura);
+
+	// Primero la mitad del lado de p; la otra solo si puede tener algun
+	// punto mas cerca que el peor de los encontrados
+	float delta = Coordenada(p, eje) - Coordenada(arbol[m].pos, eje);
+	int siguiente = (eje + 1) % 3;
+	if ( delta < 0.0f )
+	{
+		BuscarVecinos(arbol, a, m, siguiente, p, v);
+		if ( v.n < v.maximo || delta*delta < v.d2[v.n-1] )
+		{
+			BuscarVecinos(arbol, m + 1, b, siguiente, p, v);
+		}
+	}
+	else
+	{
+		BuscarVecinos(arbol, m + 1, b, siguiente, p, v);
+		if ( v.n < v.maximo || delta*delta < v.d2[v.n-1] )
+		{
+			BuscarVecinos(arbol, a, m, siguiente, p, v);
+		}
+	}
+}
+
+// Sumas de IDW_RADIO
+struct Radio
+{
+	core::vector3df p;
+	float radio2;
+	float inversoRadio2;
+	float suma;
+	float h;
+	bool encima;
+	float alturaEncima;
+};
+
+static void
+Acumular(Radio &r, float d2, float altura)
+{
+	if ( d2 >= r.radio2 )
+	{
+		return;
+	}
+	if ( d2 < DISTANCIA_MINIMA2 )
+	{
+		r.encima = true;
+		r.alturaEncima = altura;
+		return;
+	}
+
+	float w = 1.0f/d2 - r.inversoRadio2;
+	r.suma += w;
+	r.h += w*altura;
+}
+
+static void
+BuscarRadio(const GeneradorPlaneta::PuntoControl *arbol, int a, int b, int eje, Radio &r)
+{
+	if ( a >= b )
+	{
+		return;
+	}
+
+	int m = (a + b) / 2;
+	Acumular(r, Distancia2(r.p, arbol[m].pos), arbol[m].altura);
+
+	float delta = Coordenada(r.p, eje) - Coordenada(arbol[m].pos, eje);
+	int siguiente = (eje + 1) % 3;
+	if ( delta < 0.0f || delta*delta < r.radio2 )
+	{
+		BuscarRadio(arbol, a, m, siguiente, r);
+	}
+	if ( delta >= 0.0f || delta*delta < r.radio2 )
+	{
+		BuscarRadio(arbol, m + 1, b, siguiente, r);
+	}
+}
+
+// ---------------------------------------------------------------------------
+// GeneradorPlaneta
+// ---------------------------------------------------------------------------
+
+GeneradorPlaneta::GeneradorPlaneta(int capacidad) : numPuntos(0), capacidad(capacidad), indexado(true), propios(true),
+	modo(IDW_TODOS), vecinos(8), radio(0.5f)
+{
+	puntos = new PuntoControl[capacidad];
+	arbol = new PuntoControl[capacidad];
+}
+
+GeneradorPlaneta::GeneradorPlaneta(int capacidad, ArenaMemoria &arena) : numPuntos(0), capacidad(capacidad), indexado(true),
+	propios(false), modo(IDW_TODOS), vecinos(8), radio(0.5f)
+{
+	puntos = arena.Reservar<PuntoControl>(capacidad);
+	arbol = arena.Reservar<PuntoControl>(capacidad);
+}
+
+GeneradorPlaneta::~GeneradorPlaneta(void)
+{
+	if ( propios )
+	{
+		delete [] puntos;
+		delete [] arbol;
+	}
+}
+
+void
+GeneradorPlaneta::Sortear(Aleatorio &aleatorio, int numPuntos)
+{
+	float PI = 3.141592f;
+
+	for ( int i = 0 ; i < numPuntos ; i++ )
+	{
+		// Calculamos la altura al azar
+		float h = 10.0f+(((aleatorio.Entero(400)/100.0f)-2.0f)*1.0f);
+
+		// Calculamos las coordeandas cilindricas al azar
+		// TODO: Tener en cuenta que la probabilidad en los polos debe ser menor
+		float theta = aleatorio.Entero((int)(2*PI*1000))/1000.0f ;
+		float phi = aleatorio.Entero((int)(PI*1000))/1000.0f ;
+
+		// Calculamos las coordenadas cartesianas asociadas
+		float x = cos(theta)*sin(phi) ;
+		float y = cos(phi);
+		float z = sin(theta)*sin(phi) ;
+
+		AnadirPunto(core::vector3df(x, y, z), h);
+	}
+	Indexar();
+}
+
+void
+GeneradorPlaneta::AnadirPunto(const core::vector3df &pos, float altura)
+{
+	if ( numPuntos == capacidad )
+	{
+		return;
+	}
+
+	puntos[numPuntos].pos = pos;
+	puntos[numPuntos].altura = altura;
+	numPuntos++;
+	indexado = false;
+}
+
+void
+GeneradorPlaneta::Indexar()
+{
+	std::copy(puntos, puntos + numPuntos, arbol);
+	Construir(arbol, 0, numPuntos, 0);
+	indexado = true;
+}
+
+void
+GeneradorPlaneta::SetModo(MODO_IDW modo, int vecinos, float radio)
+{
+	this->modo = modo;
+	this->vecinos = core::min_(core::max_(vecinos, 1), (int)MAX_VECINOS);
+	this->radio = radio;
+}
+
+float
+GeneradorPlaneta::GetAltura(const core::vector3df &p) const
+{
+	switch (modo)
+	{
+	case IDW_VECINOS:
+		return AlturaVecinos(p, !indexado);
+	case IDW_RADIO:
+		return AlturaRadio(p, !indexado);
+	default:
+		return AlturaTodos(p);
+	}
+}
+
+float
+GeneradorPlaneta::GetAlturaDirecta(const core::vector3df &p) const
+{
+	switch (modo)
+	{
+	case IDW_VECINOS:
+		return AlturaVecinos(p, true);
+	case IDW_RADIO:
+		return AlturaRadio(p, true);
+	default:
+		return AlturaTodos(p);
+	}
+}
+
+float
+GeneradorPlaneta::AlturaTodos(const core::vector3df &p) const
+{
+	// Guardamos la suma de pesos para normalizar
+	float suma = 0.0f ;
+	for ( int i = 0 ; i < numPuntos ; ++i )
+	{
+		float d2 = Distancia2(p, puntos[i].pos);
+		if ( d2 < DISTANCIA_MINIMA2 )
+		{
+			return puntos[i].altura;
+		}
+		suma += 1.0f/d2 ;
+	}
+
+	// Normalizamos con la suma de los pesos (no con la norma euclidea, que
+	// hace que la altura de un punto cercano a dos puntos fijos sea maxima
+	// en el punto equidistante a los dos, formando una especie de montana
+	// redondeada... espera, eso me gusta)
+	float h = 0.0f ;
+	for ( int i = 0 ; i < numPuntos ; ++i )
+	{
+		float w = 1.0f/Distancia2(p, puntos[i].pos);
+		w /= suma;
+		h += puntos[i].altura * w ;
+	}
+	return h;
+}
+
+float
+GeneradorPlaneta::AlturaVecinos(const core::vector3df &p, bool directa) const
+{
+	if ( numPuntos == 0 )
+	{
+		return 0.0f;
+	}
+
+	// Buscamos un vecino mas para saber donde se anula el peso
+	int k = core::min_(vecinos, numPuntos);
+	Vecinos v;
+	v.maximo = k < numPuntos ? k+1 : k;
+	v.n = 0;
+	if ( directa )
+	{
+		for ( int i = 0 ; i < numPuntos ; ++i )
+		{
+			Insertar(v, Distancia2(p, puntos[i].pos), puntos[i].altura);
+		}
+	}
+	else
+	{
+		BuscarVecinos(arbol, 0, numPuntos, 0, p, v);
+	}
+
+	if ( v.d2[0] < DISTANCIA_MINIMA2 )
+	{
+		return v.altura[0];
+	}
+
+	float corte = v.n > k ? 1.0f/v.d2[k] : 0.0f;
+	float suma = 0.0f;
+	float h = 0.0f;
+	for ( int i = 0 ; i < k ; ++i )
+	{
+		float w = 1.0f/v.d2[i] - corte;
+		suma += w;
+		h += w*v.altura[i];
+	}
+
+	// Solo si los k+1 estan a la misma distancia
+	if ( suma <= 0.0f )
+	{
+		return v.altura[0];
+	}
+	return h / suma;
+}
+
+float
+GeneradorPlaneta::AlturaRadio(const core::vector3df &p, bool directa) const
+{
+	Radio r;
+	r.p = p;
+	r.radio2 = radio*radio;
+	r.inversoRadio2 = 1.0f/r.radio2;
+	r.suma = 0.0f;
+	r.h = 0.0f;
+	r.encima = false;
+	r.alturaEncima = 0.0f;
+
+	if ( directa )
+	{
+		for ( int i = 0 ; i < numPuntos ; ++i )
+		{
+			Acumular(r, Distancia2(p, puntos[i].pos), puntos[i].altura);
+		}
+	}
+	else
+	{
+		BuscarRadio(arbol, 0, numPuntos, 0, r);
+	}
+
+	if ( r.encima )
+	{
+		return r.alturaEncima;
+	}
+	if ( r.suma > 0.0f )
+	{
+		return r.h / r.suma;
+	}
+
+	// Ningun punto dentro del radio: el mas cercano
+	if ( numPuntos == 0 )
+	{
+		return 0.0f;
+	}
+	Vecinos v;
+	v.maximo = 1;
+	v.n = 0;
+	if ( directa )
+	{
+		for ( int i = 0 ; i < numPuntos ; ++i )
+		{
+			Insertar(v, Distancia2(p, puntos[i].pos), puntos[i].altura);
+		}
+	}
+	else
+	{
+		BuscarVecinos(arbol, 0, numPuntos, 0, p, v);
+	}
+	return v.altura[0];
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <irrlicht.h>
+
+class Aleatorio;
+class ArenaMemoria;
+
+// Orografia de los planetas: alturas sobre la esfera unidad interpoladas por
+// el inverso del cuadrado de la distancia (IDW) a unos puntos de control.
+//
+// Ademas de la lista de puntos en el orden en que se anadieron se guarda una
+// copia ordenada como arbol k-d implicito (la mediana de cada rango es el
+// nodo y sus mitades los hijos), con la que los modos IDW_VECINOS e
+// IDW_RADIO solo miran los puntos cercanos a cada vertice. Con miles de
+// puntos cada altura cuesta O(log N) en vez de O(N).
+class GeneradorPlaneta
+{
+public:
+	enum MODO_IDW
+	{
+		// Todos los puntos con peso 1/d^2, como la orografia original
+		IDW_TODOS = 0,
+
+		// Los k puntos mas cercanos con peso 1/d^2 - 1/dk^2, siendo dk la
+		// distancia al siguiente: un punto pesa 0 justo al salir de los k
+		// vecinos, asi que la superficie no tiene saltos
+		IDW_VECINOS,
+
+		// Los puntos a menos de radio con peso 1/d^2 - 1/radio^2. Donde no
+		// hay ninguno se usa la altura del mas cercano.
+		IDW_RADIO,
+
+		NUM_MODOS_IDW
+	};
+
+	// Maximo de vecinos de IDW_VECINOS
+	static const int MAX_VECINOS = 32;
+
+	struct PuntoControl
+	{
+		irr::core::vector3df pos;
+		float altura;
+	};
+
+private:
+	// Puntos en el orden en que se anadieron (IDW_TODOS los suma asi)
+	PuntoControl *puntos;
+	// Los mismos puntos ordenados como arbol k-d
+	PuntoControl *arbol;
+	int numPuntos;
+	int capacidad;
+	bool indexado;
+	// Si los arrays son suyos (y no de una arena)
+	bool propios;
+
+	MODO_IDW modo;
+	int vecinos;
+	float radio;
+
+	float AlturaTodos(const irr::core::vector3df &p) const;
+	float AlturaVecinos(const irr::core::vector3df &p, bool directa) const;
+	float AlturaRadio(const irr::core::vector3df &p, bool directa) const;
+
+public:
+	// capacidad: maximo de puntos de control
+	GeneradorPlaneta(int capacidad);
+	// Con los arrays sacados de arena, que tiene que durar mas que el generador
+	GeneradorPlaneta(int capacidad, ArenaMemoria &arena);
+	virtual ~GeneradorPlaneta(void);
+
+	// Anade numPuntos puntos al azar, con alturas de 8 a 12, sacando de
+	// aleatorio los mismos numeros que la orografia original de PlanetaNode
+	void Sortear(Aleatorio &aleatorio, int numPuntos);
+
+	// pos debe estar en la esfera unidad
+	void AnadirPunto(const irr::core::vector3df &pos, float altura);
+
+	// Reconstruye el arbol tras anadir puntos. Sin el, GetAltura recorre
+	// todos los puntos como GetAlturaDirecta.
+	void Indexar();
+
+	// vecinos se limita a [1, MAX_VECINOS]
+	void SetModo(MODO_IDW modo, int vecinos = 8, float radio = 0.5f);
+
+	MODO_IDW GetModo() const
+	{
+		return modo;
+	}
+
+	int GetNumPuntos() const
+	{
+		return numPuntos;
+	}
+
+	const PuntoControl &GetPunto(int i) const
+	{
+		return puntos[i];
+	}
+
+	// Altura en el punto p de la esfera unidad
+	float GetAltura(const irr::core::vector3df &p) const;
+
+	// Lo mismo recorriendo todos los puntos en vez del arbol, para comprobar
+	// el arbol y medir lo que se gana con el
+	float GetAlturaDirecta(const irr::core::vector3df &p) const;
+};
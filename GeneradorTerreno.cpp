@@ -0,0 +1,358 @@
+#include "GeneradorTerreno.h"
+
+#include "PoolHilos.h"
+
+#include <cmath>
+
+#include <stdlib.h>
+#include <string.h>
+using namespace std;
+using namespace irr;
+
+const float GeneradorTerreno::PASO = 0.01f;
+
+GeneradorTerreno::GeneradorTerreno(int W, int H) : W(W), H(H), pool(NULL)
+{
+	alturas = new float[W*H];
+	memset(alturas, 0, sizeof(float)*W*H);
+}
+
+GeneradorTerreno::~GeneradorTerreno(void)
+{
+	delete [] alturas;
+	delete pool;
+}
+
+void
+GeneradorTerreno::SetNumHilos(int numHilos)
+{
+	delete pool;
+	pool = NULL;
+
+	if ( numHilos != 1 )
+	{
+		pool = new PoolHilos(numHilos);
+	}
+}
+
+int
+GeneradorTerreno::GetNumHilos() const
+{
+	return pool ? pool->GetNumHilos() : 1;
+}
+
+void
+GeneradorTerreno::Generar(Aleatorio &aleatorio, int numBultos, TIPO_OPERADOR operador)
+{
+	memset(alturas, 0, sizeof(float)*W*H);
+	AplicarBultos(aleatorio, operador, numBultos);
+	Resituar();
+}
+
+void
+GeneradorTerreno::AnadirBultos(Aleatorio &aleatorio, int numBultos, TIPO_OPERADOR operador)
+{
+	AplicarBultos(aleatorio, operador, numBultos);
+}
+
+void
+GeneradorTerreno::SortearBultos(Aleatorio &aleatorio, TIPO_OPERADOR operador, BultoTerreno *bultos, int numBultos) const
+{
+	for ( int i = 0 ; i < numBultos ; ++i )
+	{
+		switch (operador)
+		{
+		case OPERADOR_PARABOLOIDE:
+			bultos[i].mag = aleatorio.Entero(100) / 4000.0f ;
+			bultos[i].param = (aleatorio.Entero(50000000) + 1000000) / 100.0f ;
+			break;
+		case OPERADOR_POTENCIAL:
+			bultos[i].mag = (aleatorio.Entero(100) - 50)/500.0f ;
+			bultos[i].param = (aleatorio.Entero(20) +10 ) /100.0f ;
+			break;
+		default:
+			{
+				bultos[i].mag = (aleatorio.Entero(200) +300) / 4000.0f ;
+				float rad = (aleatorio.Entero(1000) + 1000) / 150.0f ;
+				bultos[i].param = 1/rad ;
+			}
+			break;
+		}
+
+		bultos[i].x0 = aleatorio.Entero(W) + 0.5f ;
+		bultos[i].y0 = aleatorio.Entero(H) + 0.5f ;
+	}
+}
+
+void
+GeneradorTerreno::AplicarBultos(Aleatorio &aleatorio, TIPO_OPERADOR operador, int numBultos)
+{
+	// Sacamos los parametros de todos los bultos antes de repartir el trabajo,
+	// para que la secuencia aleatoria no dependa del numero de hilos
+	BultoTerreno *bultos = new BultoTerreno[numBultos];
+	SortearBultos(aleatorio, operador, bultos, numBultos);
+
+	OperadoresTerreno::FuncionFila funcion = OperadoresTerreno::GetFuncion(operador);
+
+	if ( pool == NULL )
+	{
+		AplicarBultos(funcion, bultos, numBultos, 0, H);
+	}
+	else
+	{
+		// Varias bandas por hilo para repartir mejor la carga
+		int numBandas = pool->GetNumHilos()*4;
+		if ( numBandas > H )
+		{
+			numBandas = H;
+		}
+
+		Banda banda;
+		banda.generador = this;
+		banda.operador = funcion;
+		banda.bultos = bultos;
+		banda.numBultos = numBultos;
+		banda.filasPorBanda = (H + numBandas - 1) / numBandas;
+
+		pool->Ejecutar(TareaBanda, &banda, (H + banda.filasPorBanda - 1) / banda.filasPorBanda);
+	}
+
+	delete [] bultos;
+}
+
+void
+GeneradorTerreno::TareaBanda(void *datos, int banda)
+{
+	Banda *b = (Banda *)datos;
+	int y0 = banda*b->filasPorBanda;
+	int y1 = y0 + b->filasPorBanda;
+	if ( y1 > b->generador->H )
+	{
+		y1 = b->generador->H;
+	}
+
+	b->generador->AplicarBultos(b->operador, b->bultos, b->numBultos, y0, y1);
+}
+
+void
+GeneradorTerreno::AplicarBultos(OperadoresTerreno::FuncionFila operador, const BultoTerreno *bultos, int numBultos, int y0, int y1) const
+{
+	for ( int i = 0 ; i < numBultos ; ++i )
+	{
+		for ( int y = y0 ; y < y1 ; ++y )
+		{
+			operador(&alturas[y*W], W, (float)y, bultos[i]);
+		}
+	}
+}
+
+void
+GeneradorTerreno::Resituar()
+{
+	float mean = 0.0f ;
+	for ( int i = 0 ; i < W*H ; ++i )
+	{
+		mean += alturas[i];
+	}
+	mean /= W*H ;
+
+	for ( int i = 0 ; i < W*H ; ++i )
+	{
+		alturas[i] -= mean ;
+	}
+}
+
+// Los triangulos de cada celda son los de GenerarIndices:
+//   T1 = (x,y) (x+1,y+1) (x,y+1)
+//   T2 = (x,y) (x+1,y)   (x+1,y+1)
+// con la normal invertida, como se calculaba con triangle3df en SolNode.
+
+void
+GeneradorTerreno::NormalTriangulo1(const float *celda, int pasoFila, core::vector3df &n)
+{
+	float h00 = celda[0];
+	float h01 = celda[pasoFila];
+	float h11 = celda[pasoFila+1];
+
+	n.X += PASO*(h01-h11);
+	n.Y += PASO*PASO;
+	n.Z += PASO*(h00-h01);
+}
+
+void
+GeneradorTerreno::NormalTriangulo2(const float *celda, int pasoFila, core::vector3df &n)
+{
+	float h00 = celda[0];
+	float h10 = celda[1];
+	float h11 = celda[pasoFila+1];
+
+	n.X += PASO*(h00-h10);
+	n.Y += PASO*PASO;
+	n.Z += PASO*(h10-h11);
+}
+
+core::vector3df
+GeneradorTerreno::Normal(const float *h, int pasoFila, int x, int y, int W, int H)
+{
+	core::vector3df n(0,0,0);
+
+	// Celda (x,y): el vertice es el primero de los dos triangulos
+	if ( x < W-1 && y < H-1 )
+	{
+		NormalTriangulo1(h, pasoFila, n);
+		NormalTriangulo2(h, pasoFila, n);
+	}
+	// Celda (x-1,y): solo T2
+	if ( x > 0 && y < H-1 )
+	{
+		NormalTriangulo2(h-1, pasoFila, n);
+	}
+	// Celda (x,y-1): solo T1
+	if ( x < W-1 && y > 0 )
+	{
+		NormalTriangulo1(h-pasoFila, pasoFila, n);
+	}
+	// Celda (x-1,y-1): los dos triangulos
+	if ( x > 0 && y > 0 )
+	{
+		NormalTriangulo1(h-pasoFila-1, pasoFila, n);
+		NormalTriangulo2(h-pasoFila-1, pasoFila, n);
+	}
+
+	return n.normalize();
+}
+
+core::vector3df
+GeneradorTerreno::GetNormal(int x, int y) const
+{
+	return Normal(&alturas[y*W+x], W, x, y, W, H);
+}
+
+void
+GeneradorTerreno::ConstruirVertices(video::S3DVertex *vertices) const
+{
+	ConstruirVertices(vertices, 0, 0, W, H);
+}
+
+void
+GeneradorTerreno::ConstruirVertices(video::S3DVertex *vertices, int x0, int y0, int ancho, int alto) const
+{
+	ConstruirVertices(vertices, &alturas[y0*W+x0], W, W, H, x0, y0, ancho, alto);
+}
+
+void
+GeneradorTerreno::ConstruirVertices(video::S3DVertex *vertices, const float *alturas, int pasoFila,
+	int W, int H, int x0, int y0, int ancho, int alto)
+{
+	for ( int j = 0 ; j < alto ; ++j )
+	{
+		int y = y0 + j;
+		for ( int i = 0 ; i < ancho ; ++i )
+		{
+			int x = x0 + i;
+			const float *h = &alturas[j*pasoFila+i];
+			core::vector3df n = Normal(h, pasoFila, x, y, W, H);
+
+			// El valor alpha mapea la hierba
+			vertices[j*ancho+i] = video::S3DVertex(
+				(x-W/2)*PASO, *h, (y-H/2)*PASO,
+				n.X, n.Y, n.Z,
+				video::SColor(255*n.Y, 255, 255, 255),
+				x/10.0, y/10.0);
+		}
+	}
+}
+
+int
+GeneradorTerreno::GenerarIndices(u16 *indices, int W, int H)
+{
+	int nTrig = 0 ;
+	for ( int x = 0 ; x < W-1 ; ++x )
+	{
+		for ( int y = 0 ; y < H-1 ; ++y )
+		{
+			indices[nTrig*3+0] = (y  )*W + (x  );
+			indices[nTrig*3+1] = (y+1)*W + (x+1);
+			indices[nTrig*3+2] = (y+1)*W + (x  );
+
+			nTrig++;
+
+			indices[nTrig*3+0] = (y  )*W + (x  );
+			indices[nTrig*3+1] = (y  )*W + (x+1);
+			indices[nTrig*3+2] = (y+1)*W + (x+1);
+
+			nTrig++;
+		}
+	}
+	return nTrig;
+}
+
+int
+GeneradorTerreno::GenerarIndicesLOD(u16 *indices, int W, int H, int paso, const int pasoVecino[NUM_BORDES])
+{
+	int cx = W-1;
+	int cy = H-1;
+
+	// Paso con el que se recorre cada borde
+	int pasoBorde[NUM_BORDES];
+	for ( int b = 0 ; b < NUM_BORDES ; ++b )
+	{
+		pasoBorde[b] = core::max_(paso, pasoVecino[b]);
+	}
+
+	int nTrig = 0 ;
+	for ( int x = 0 ; x < cx ; x += paso )
+	{
+		for ( int y = 0 ; y < cy ; y += paso )
+		{
+			// Esquinas de la celda: a=(x,y) b=(x+1,y) c=(x,y+1) d=(x+1,y+1)
+			int vx[4] = { x, x+paso, x, x+paso };
+			int vy[4] = { y, y, y+paso, y+paso };
+			u16 v[4];
+
+			for ( int i = 0 ; i < 4 ; ++i )
+			{
+				// Los vertices de un borde con vecino mas grueso se pegan
+				// al vertice del vecino que tienen por debajo
+				int px = vx[i];
+				int py = vy[i];
+				if ( px == 0 )
+				{
+					py = py / pasoBorde[BORDE_IZQUIERDO] * pasoBorde[BORDE_IZQUIERDO];
+				}
+				else if ( px == cx )
+				{
+					py = py / pasoBorde[BORDE_DERECHO] * pasoBorde[BORDE_DERECHO];
+				}
+				if ( vy[i] == 0 )
+				{
+					px = px / pasoBorde[BORDE_INFERIOR] * pasoBorde[BORDE_INFERIOR];
+				}
+				else if ( vy[i] == cy )
+				{
+					px = px / pasoBorde[BORDE_SUPERIOR] * pasoBorde[BORDE_SUPERIOR];
+				}
+				v[i] = py*W + px;
+			}
+
+			// Mismos triangulos que GenerarIndices; los que se quedan sin
+			// area al pegar los bordes no se dibujan
+			if ( v[0] != v[3] && v[3] != v[2] && v[2] != v[0] )
+			{
+				indices[nTrig*3+0] = v[0];
+				indices[nTrig*3+1] = v[3];
+				indices[nTrig*3+2] = v[2];
+				nTrig++;
+			}
+
+			if ( v[0] != v[1] && v[1] != v[3] && v[3] != v[0] )
+			{
+				indices[nTrig*3+0] = v[0];
+				indices[nTrig*3+1] = v[1];
+				indices[nTrig*3+2] = v[3];
+				nTrig++;
+			}
+		}
+	}
+	return nTrig;
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <irrlicht.h>
+
+#include "OperadoresTerreno.h"
+#include "Aleatorio.h"
+
+class PoolHilos;
+
+// Generador del terreno del sol, independiente de SolNode y de cualquier
+// dispositivo de Irrlicht (solo se usan los tipos de cabecera).
+//
+// El terreno se genera sobre una rejilla compacta de alturas (un float por
+// vertice). Las normales y el alpha de la hierba no se guardan: se calculan
+// a partir de las alturas al construir los S3DVertex de la malla.
+class GeneradorTerreno
+{
+private:
+	// Trabajo de una banda de filas
+	struct Banda
+	{
+		const GeneradorTerreno *generador;
+		OperadoresTerreno::FuncionFila operador;
+		const BultoTerreno *bultos;
+		int numBultos;
+		int filasPorBanda;
+	};
+
+	int W;
+	int H;
+	float *alturas;
+	PoolHilos *pool;
+
+	void SortearBultos(Aleatorio &aleatorio, TIPO_OPERADOR operador, BultoTerreno *bultos, int numBultos) const;
+	void AplicarBultos(Aleatorio &aleatorio, TIPO_OPERADOR operador, int numBultos);
+	void AplicarBultos(OperadoresTerreno::FuncionFila operador, const BultoTerreno *bultos, int numBultos, int y0, int y1) const;
+	static void TareaBanda(void *datos, int banda);
+	void Resituar();
+
+	// Suma a n la normal (sin normalizar) de cada triangulo de la celda cuya
+	// primera altura es celda, en una rejilla de pasoFila floats por fila
+	static void NormalTriangulo1(const float *celda, int pasoFila, irr::core::vector3df &n);
+	static void NormalTriangulo2(const float *celda, int pasoFila, irr::core::vector3df &n);
+
+	// Normal del vertice (x,y) de una rejilla de W x H; h apunta a su altura
+	static irr::core::vector3df Normal(const float *h, int pasoFila, int x, int y, int W, int H);
+
+public:
+	// Sube cada vez que cambia el terreno que sale de Generar o de
+	// ConstruirVertices con la misma semilla (invalida la cache de mallas)
+	static const int VERSION = 1;
+
+	// Separacion entre vertices de la rejilla
+	static const float PASO;
+
+	// Maximo de vertices direccionables con indices de 16 bits
+	static const int MAX_VERTICES = 65536;
+
+	GeneradorTerreno(int W, int H);
+	virtual ~GeneradorTerreno(void);
+
+	// Sortea los parametros de un bulto como lo hace Generar
+	BultoTerreno SortearBulto(Aleatorio &aleatorio, TIPO_OPERADOR operador) const
+	{
+		BultoTerreno b;
+		SortearBultos(aleatorio, operador, &b, 1);
+		return b;
+	}
+
+	// Numero de hilos para acumular los bultos (<= 0 utiliza todos los
+	// nucleos). Las filas se reparten en bandas y cada banda aplica todos los
+	// bultos en el mismo orden, asi que el resultado es identico al secuencial.
+	void SetNumHilos(int numHilos);
+	int GetNumHilos() const;
+
+	// Genera las alturas con numBultos bultos del operador indicado y las
+	// centra en 0. Los operadores se evaluan con la version de
+	// OperadoresTerreno que corresponda a la CPU.
+	// Los bultos se sortean con el Aleatorio que se pasa, asi que el terreno
+	// solo depende de su semilla y su flujo.
+	void Generar(Aleatorio &aleatorio, int numBultos, TIPO_OPERADOR operador = OPERADOR_ARCOTANGENTE);
+
+	// Suma numBultos bultos a las alturas que ya hay, sin ponerlas a 0 ni
+	// centrarlas (para dar detalle a un mapa importado)
+	void AnadirBultos(Aleatorio &aleatorio, int numBultos, TIPO_OPERADOR operador = OPERADOR_ARCOTANGENTE);
+
+	int GetAncho() const
+	{
+		return W;
+	}
+
+	int GetAlto() const
+	{
+		return H;
+	}
+
+	const float *GetAlturas() const
+	{
+		return alturas;
+	}
+
+	// Para rellenar la rejilla desde fuera (ImportadorAlturas)
+	float *GetAlturas()
+	{
+		return alturas;
+	}
+
+	float GetAltura(int x, int y) const
+	{
+		return alturas[y*W+x];
+	}
+
+	// Normal del vertice (x,y): suma de las normales de los triangulos que
+	// lo comparten, normalizada
+	irr::core::vector3df GetNormal(int x, int y) const;
+
+	// Expande la rejilla a W*H vertices (posicion, normal, alpha y uv)
+	void ConstruirVertices(irr::video::S3DVertex *vertices) const;
+
+	// Expande solo el rectangulo de ancho x alto vertices que empieza en
+	// (x0,y0). Posiciones, normales y uv son las de la rejilla completa, asi
+	// que los bordes de rectangulos vecinos coinciden exactamente.
+	void ConstruirVertices(irr::video::S3DVertex *vertices, int x0, int y0, int ancho, int alto) const;
+
+	// Lo mismo sobre alturas que no estan en un generador (por ejemplo las
+	// de un LectorMosaico): alturas apunta a la altura (x0,y0) de una
+	// rejilla de W x H, con pasoFila floats entre filas, y tiene que incluir
+	// las filas y columnas vecinas del rectangulo que existan en la rejilla.
+	static void ConstruirVertices(irr::video::S3DVertex *vertices, const float *alturas, int pasoFila,
+		int W, int H, int x0, int y0, int ancho, int alto);
+
+	static int NumIndices(int W, int H)
+	{
+		return (W-1)*(H-1)*2*3;
+	}
+
+	// Rellena NumIndices(W,H) indices y devuelve el numero de triangulos
+	static int GenerarIndices(irr::u16 *indices, int W, int H);
+
+	// Bordes de un parche para GenerarIndicesLOD
+	enum BORDE
+	{
+		BORDE_IZQUIERDO = 0,	// x = 0
+		BORDE_DERECHO,			// x = W-1
+		BORDE_INFERIOR,			// y = 0
+		BORDE_SUPERIOR,			// y = H-1
+		NUM_BORDES
+	};
+
+	// Indices de un parche de W x H vertices usando solo uno de cada paso
+	// vertices (paso potencia de 2 que divide W-1 y H-1). pasoVecino[borde]
+	// es el paso del parche vecino por ese lado (o paso si no hay vecino):
+	// si es mayor, los vertices de ese borde se pegan a los del vecino y no
+	// quedan grietas. Como mucho rellena NumIndices(W,H) indices; devuelve el
+	// numero de triangulos.
+	static int GenerarIndicesLOD(irr::u16 *indices, int W, int H, int paso, const int pasoVecino[NUM_BORDES]);
+};
@@ -0,0 +1,409 @@
+#include "Gravedad.h"
+
+#include <math.h>
+#include <string.h>
+using namespace irr;
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define GRAVEDAD_X86
+#include <emmintrin.h>
+#endif
+
+const float Gravedad::G = 1e-4f;
+const float Gravedad::DIST2_MINIMA = 1e-2f;
+const float Gravedad::ERROR_SSE2 = 2e-6f;
+const float Gravedad::THETA = 0.5f;
+const float Gravedad::ERROR_ARBOL = 0.02f;
+
+Gravedad::Gravedad(void)
+	: num(0), capacidad(0), x(NULL), y(NULL), z(NULL), gm(NULL),
+	vectorial(GetVectorialDisponible()), theta(THETA), umbralArbol(UMBRAL_ARBOL), nodos(NULL), numNodos(0), capacidadNodos(0),
+	orden(NULL), ordenTmp(NULL), capacidadOrden(0)
+{
+}
+
+Gravedad::~Gravedad(void)
+{
+	delete[] x;
+	delete[] y;
+	delete[] z;
+	delete[] gm;
+	delete[] nodos;
+	delete[] orden;
+	delete[] ordenTmp;
+}
+
+void
+Gravedad::AnadirAtractor(core::vector3df pos, float masa)
+{
+	if ( num == capacidad )
+	{
+		int nuevaCapacidad = capacidad > 0 ? capacidad*2 : 8;
+		float *columnas[4] = { x, y, z, gm };
+		for ( int c = 0 ; c < 4 ; ++c )
+		{
+			float *nueva = new float[nuevaCapacidad];
+			if ( num > 0 )
+			{
+				memcpy(nueva, columnas[c], num*sizeof(float));
+			}
+			delete[] columnas[c];
+			columnas[c] = nueva;
+		}
+		x = columnas[0];
+		y = columnas[1];
+		z = columnas[2];
+		gm = columnas[3];
+		capacidad = nuevaCapacidad;
+	}
+
+	x[num] = pos.X;
+	y[num] = pos.Y;
+	z[num] = pos.Z;
+	gm[num] = G * masa;
+	num++;
+}
+
+bool
+Gravedad::GetVectorialDisponible()
+{
+#ifdef GRAVEDAD_X86
+	// SSE2 esta en todos los x86 de 64 bits y en los de 32 de los ultimos
+	// veinte anos
+	return true;
+#else
+	return false;
+#endif
+}
+
+void
+Gravedad::Calcular(const float *px, const float *py, const float *pz, int n,
+	float *ax, float *ay, float *az)
+{
+	if ( num >= umbralArbol )
+	{
+		CalcularArbol(px, py, pz, n, ax, ay, az);
+	}
+	else if ( vectorial )
+	{
+		CalcularSSE2(px, py, pz, n, ax, ay, az);
+	}
+	else
+	{
+		CalcularEscalar(px, py, pz, n, ax, ay, az);
+	}
+}
+
+void
+Gravedad::CalcularEscalar(const float *px, const float *py, const float *pz, int n,
+	float *ax, float *ay, float *az) const
+{
+	for ( int i = 0 ; i < n ; ++i )
+	{
+		float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+		for ( int a = 0 ; a < num ; ++a )
+		{
+			float dx = x[a] - px[i];
+			float dy = y[a] - py[i];
+			float dz = z[a] - pz[i];
+			float d2 = dx*dx + dy*dy + dz*dz;
+			if ( d2 < DIST2_MINIMA )
+			{
+				d2 = DIST2_MINIMA;
+			}
+			float d = sqrtf(d2);
+
+			// (dx,dy,dz)/d es la direccion y gm/d2 el modulo
+			float k = gm[a] / (d2*d);
+			sx += dx*k;
+			sy += dy*k;
+			sz += dz*k;
+		}
+		ax[i] = sx;
+		ay[i] = sy;
+		az[i] = sz;
+	}
+}
+
+// -------------------------------------------------------------------
+// Barnes-Hut
+// -------------------------------------------------------------------
+
+int
+Gravedad::NuevoNodo(float cx, float cz, float mitad)
+{
+	if ( numNodos == capacidadNodos )
+	{
+		int nuevaCapacidad = capacidadNodos > 0 ? capacidadNodos*2 : 64;
+		NodoArbol *nuevos = new NodoArbol[nuevaCapacidad];
+		if ( numNodos > 0 )
+		{
+			memcpy(nuevos, nodos, numNodos*sizeof(NodoArbol));
+		}
+		delete[] nodos;
+		nodos = nuevos;
+		capacidadNodos = nuevaCapacidad;
+	}
+
+	NodoArbol &nodo = nodos[numNodos];
+	nodo.cx = cx;
+	nodo.cz = cz;
+	nodo.mitad = mitad;
+	nodo.hijos = -1;
+	nodo.primero = 0;
+	nodo.cuantos = 0;
+	return numNodos++;
+}
+
+// Reparte orden[primero, primero+cuantos) entre los cuatro cuadrantes del
+// nodo y calcula su masa y su centro de masas
+void
+Gravedad::Subdividir(int nodo, int primero, int cuantos, int profundidad)
+{
+	nodos[nodo].primero = primero;
+	nodos[nodo].cuantos = cuantos;
+
+	if ( cuantos > MAX_HOJA && profundidad < MAX_PROFUNDIDAD )
+	{
+		float cx = nodos[nodo].cx;
+		float cz = nodos[nodo].cz;
+		float mitad = nodos[nodo].mitad / 2;
+
+		// Cuadrante: bit 0 si x >= cx, bit 1 si z >= cz
+		int inicio[5] = { 0, 0, 0, 0, 0 };
+		for ( int k = primero ; k < primero+cuantos ; ++k )
+		{
+			int a = orden[k];
+			inicio[(x[a] >= cx ? 1 : 0) + (z[a] >= cz ? 2 : 0) + 1]++;
+		}
+		for ( int c = 1 ; c < 5 ; ++c )
+		{
+			inicio[c] += inicio[c-1];
+		}
+		int pos[4] = { inicio[0], inicio[1], inicio[2], inicio[3] };
+		for ( int k = primero ; k < primero+cuantos ; ++k )
+		{
+			int a = orden[k];
+			ordenTmp[primero + pos[(x[a] >= cx ? 1 : 0) + (z[a] >= cz ? 2 : 0)]++] = a;
+		}
+		memcpy(orden+primero, ordenTmp+primero, cuantos*sizeof(int));
+
+		// Los hijos van seguidos; NuevoNodo puede mover el array
+		int hijos = NuevoNodo(cx - mitad, cz - mitad, mitad);
+		NuevoNodo(cx + mitad, cz - mitad, mitad);
+		NuevoNodo(cx - mitad, cz + mitad, mitad);
+		NuevoNodo(cx + mitad, cz + mitad, mitad);
+		nodos[nodo].hijos = hijos;
+
+		float masa = 0.0f, mx = 0.0f, my = 0.0f, mz = 0.0f;
+		for ( int c = 0 ; c < 4 ; ++c )
+		{
+			Subdividir(hijos + c, primero + inicio[c], inicio[c+1] - inicio[c], profundidad + 1);
+			const NodoArbol &hijo = nodos[hijos + c];
+			masa += hijo.gm;
+			mx += hijo.mx * hijo.gm;
+			my += hijo.my * hijo.gm;
+			mz += hijo.mz * hijo.gm;
+		}
+		NodoArbol &n = nodos[nodo];
+		n.gm = masa;
+		n.mx = masa > 0.0f ? mx / masa : cx;
+		n.my = masa > 0.0f ? my / masa : 0.0f;
+		n.mz = masa > 0.0f ? mz / masa : cz;
+	}
+	else
+	{
+		float masa = 0.0f, mx = 0.0f, my = 0.0f, mz = 0.0f;
+		for ( int k = primero ; k < primero+cuantos ; ++k )
+		{
+			int a = orden[k];
+			masa += gm[a];
+			mx += x[a] * gm[a];
+			my += y[a] * gm[a];
+			mz += z[a] * gm[a];
+		}
+		NodoArbol &n = nodos[nodo];
+		n.gm = masa;
+		n.mx = masa > 0.0f ? mx / masa : n.cx;
+		n.my = masa > 0.0f ? my / masa : 0.0f;
+		n.mz = masa > 0.0f ? mz / masa : n.cz;
+	}
+}
+
+void
+Gravedad::ConstruirArbol()
+{
+	if ( capacidadOrden < num )
+	{
+		delete[] orden;
+		delete[] ordenTmp;
+		capacidadOrden = capacidad;
+		orden = new int[capacidadOrden];
+		ordenTmp = new int[capacidadOrden];
+	}
+
+	float minX = x[0], maxX = x[0], minZ = z[0], maxZ = z[0];
+	for ( int a = 0 ; a < num ; ++a )
+	{
+		orden[a] = a;
+		minX = x[a] < minX ? x[a] : minX;
+		maxX = x[a] > maxX ? x[a] : maxX;
+		minZ = z[a] < minZ ? z[a] : minZ;
+		maxZ = z[a] > maxZ ? z[a] : maxZ;
+	}
+	float lado = maxX - minX > maxZ - minZ ? maxX - minX : maxZ - minZ;
+
+	numNodos = 0;
+	// Un poco mas grande para que el borde superior caiga dentro
+	int raiz = NuevoNodo((minX + maxX) / 2, (minZ + maxZ) / 2, lado * 0.5f * 1.0001f + 1e-3f);
+	Subdividir(raiz, 0, num, 0);
+}
+
+void
+Gravedad::CalcularArbol(const float *px, const float *py, const float *pz, int n,
+	float *ax, float *ay, float *az)
+{
+	if ( num == 0 )
+	{
+		memset(ax, 0, n*sizeof(float));
+		memset(ay, 0, n*sizeof(float));
+		memset(az, 0, n*sizeof(float));
+		return;
+	}
+
+	ConstruirArbol();
+
+	float theta2 = theta*theta;
+	int pila[4*MAX_PROFUNDIDAD + 4];
+	for ( int i = 0 ; i < n ; ++i )
+	{
+		float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+		int cima = 0;
+		pila[cima++] = 0;
+		while ( cima > 0 )
+		{
+			const NodoArbol &nodo = nodos[pila[--cima]];
+			if ( nodo.cuantos == 0 )
+			{
+				continue;
+			}
+
+			float dx = nodo.mx - px[i];
+			float dy = nodo.my - py[i];
+			float dz = nodo.mz - pz[i];
+			float d2 = dx*dx + dy*dy + dz*dz;
+			float lado = 2*nodo.mitad;
+
+			if ( nodo.hijos >= 0 && lado*lado < theta2*d2 )
+			{
+				// Lejos: el nodo entero en su centro de masas
+				float k = nodo.gm / (d2*sqrtf(d2));
+				sx += dx*k;
+				sy += dy*k;
+				sz += dz*k;
+			}
+			else if ( nodo.hijos >= 0 )
+			{
+				for ( int c = 3 ; c >= 0 ; --c )
+				{
+					pila[cima++] = nodo.hijos + c;
+				}
+			}
+			else
+			{
+				// Hoja: sus atractores uno a uno, como en CalcularEscalar
+				for ( int k = nodo.primero ; k < nodo.primero+nodo.cuantos ; ++k )
+				{
+					int a = orden[k];
+					float ex = x[a] - px[i];
+					float ey = y[a] - py[i];
+					float ez = z[a] - pz[i];
+					float e2 = ex*ex + ey*ey + ez*ez;
+					if ( e2 < DIST2_MINIMA )
+					{
+						e2 = DIST2_MINIMA;
+					}
+					float f = gm[a] / (e2*sqrtf(e2));
+					sx += ex*f;
+					sy += ey*f;
+					sz += ez*f;
+				}
+			}
+		}
+		ax[i] = sx;
+		ay[i] = sy;
+		az[i] = sz;
+	}
+}
+
+// -------------------------------------------------------------------
+// Version SSE2
+// -------------------------------------------------------------------
+
+#ifdef GRAVEDAD_X86
+
+// 1/sqrt(x) con la estimacion de 12 bits y un paso de Newton
+static inline __m128
+Rsqrt(__m128 x)
+{
+	__m128 r = _mm_rsqrt_ps(x);
+	__m128 xr2 = _mm_mul_ps(_mm_mul_ps(x, r), r);
+	return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), _mm_sub_ps(_mm_set1_ps(3.0f), xr2));
+}
+
+void
+Gravedad::CalcularSSE2(const float *px, const float *py, const float *pz, int n,
+	float *ax, float *ay, float *az) const
+{
+	__m128 minimo = _mm_set1_ps(DIST2_MINIMA);
+
+	int i = 0;
+	for ( ; i+4 <= n ; i += 4 )
+	{
+		__m128 vx = _mm_loadu_ps(px+i);
+		__m128 vy = _mm_loadu_ps(py+i);
+		__m128 vz = _mm_loadu_ps(pz+i);
+		__m128 sx = _mm_setzero_ps();
+		__m128 sy = _mm_setzero_ps();
+		__m128 sz = _mm_setzero_ps();
+
+		for ( int a = 0 ; a < num ; ++a )
+		{
+			__m128 dx = _mm_sub_ps(_mm_set1_ps(x[a]), vx);
+			__m128 dy = _mm_sub_ps(_mm_set1_ps(y[a]), vy);
+			__m128 dz = _mm_sub_ps(_mm_set1_ps(z[a]), vz);
+			__m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			d2 = _mm_max_ps(d2, minimo);
+
+			// gm / d^3 = gm * r^3, con r = 1/d
+			__m128 r = Rsqrt(d2);
+			__m128 k = _mm_mul_ps(_mm_set1_ps(gm[a]), _mm_mul_ps(_mm_mul_ps(r, r), r));
+			sx = _mm_add_ps(sx, _mm_mul_ps(dx, k));
+			sy = _mm_add_ps(sy, _mm_mul_ps(dy, k));
+			sz = _mm_add_ps(sz, _mm_mul_ps(dz, k));
+		}
+
+		_mm_storeu_ps(ax+i, sx);
+		_mm_storeu_ps(ay+i, sy);
+		_mm_storeu_ps(az+i, sz);
+	}
+
+	// Los que no llenan un grupo de cuatro
+	if ( i < n )
+	{
+		CalcularEscalar(px+i, py+i, pz+i, n-i, ax+i, ay+i, az+i);
+	}
+}
+
+#else
+
+// Sin SSE2 la version vectorial es la escalar (SetVectorial no la activa,
+// pero la funcion tiene que existir)
+void
+Gravedad::CalcularSSE2(const float *px, const float *py, const float *pz, int n,
+	float *ax, float *ay, float *az) const
+{
+	CalcularEscalar(px, py, pz, n, ax, ay, az);
+}
+
+#endif
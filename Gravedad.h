@@ -0,0 +1,159 @@
+#pragma once
+
+#include <irrlicht.h>
+
+// Aceleracion de muchos puntos (los disparos) hacia unos pocos atractores
+// (el sol y los planetas), con la ley del inverso del cuadrado:
+//
+//   a = G * masa / d^2, en la direccion del atractor
+//
+// Todos los puntos se calculan de una vez, por columnas. La version
+// escalar es la de referencia (con sqrt); la SSE2 trata cuatro puntos a la
+// vez y saca 1/d con una sola rsqrt (con un paso de Newton) por pareja,
+// y de ahi d^-3 sin dividir. Su error respecto a la escalar es como mucho
+// ERROR_SSE2 veces la suma de los modulos de cada atraccion (lo comprueba
+// simulador -verificar).
+//
+// Con muchos atractores (a partir de GetUmbralArbol) se usa en cambio un
+// arbol de Barnes-Hut: un quadtree en el plano XZ, donde se juega, en el
+// que cada nodo guarda la masa de sus atractores y su centro de masas. Un
+// grupo de atractores lo bastante lejano (lado del nodo / distancia <
+// theta) cuenta como un solo atractor en su centro de masas, asi que cada
+// punto cuesta O(log n) en lugar de O(n). Con theta = 0 se abren todos los
+// nodos y el resultado es el directo, sumado en otro orden.
+class Gravedad
+{
+public:
+	// Con G = 1e-4 un atractor de masa m acelera a un punto a distancia 10
+	// lo mismo que con la formula anterior, 1e-6*m a cualquier distancia
+	static const float G;
+
+	// d^2 minima: un punto encima de un atractor no da infinito
+	static const float DIST2_MINIMA;
+
+	static const float ERROR_SSE2;
+
+	// Por debajo de estos atractores se suma directamente: con la version
+	// SSE2 el arbol (con THETA) empieza a compensar hacia los mil
+	// (simulador -barneshut)
+	static const int UMBRAL_ARBOL = 1024;
+
+	static const float THETA;
+
+	// Error del arbol con THETA respecto a la suma directa, con la misma
+	// medida que ERROR_SSE2 (simulador -verificar)
+	static const float ERROR_ARBOL;
+
+private:
+	int num;
+	int capacidad;
+	float *x, *y, *z;
+	// G*masa
+	float *gm;
+
+	// Barnes-Hut
+	struct NodoArbol
+	{
+		// Cuadrado del nodo en XZ
+		float cx, cz, mitad;
+		// Masa (G*masa) y centro de masas de sus atractores
+		float gm, mx, my, mz;
+		// Primer hijo de los cuatro (seguidos), -1 en las hojas
+		int hijos;
+		// Atractores de la hoja en orden[primero, primero+cuantos)
+		int primero, cuantos;
+	};
+
+	// Atractores por hoja como mucho, y profundidad maxima (por si hay
+	// muchos en el mismo sitio)
+	static const int MAX_HOJA = 8;
+	static const int MAX_PROFUNDIDAD = 24;
+
+	bool vectorial;
+	float theta;
+	int umbralArbol;
+	NodoArbol *nodos;
+	int numNodos;
+	int capacidadNodos;
+	int *orden;
+	int *ordenTmp;
+	int capacidadOrden;
+
+	int NuevoNodo(float cx, float cz, float mitad);
+	void Subdividir(int nodo, int primero, int cuantos, int profundidad);
+	void ConstruirArbol();
+
+	// No se copia
+	Gravedad(const Gravedad &);
+	Gravedad &operator=(const Gravedad &);
+
+public:
+	Gravedad(void);
+	virtual ~Gravedad(void);
+
+	void Vaciar()
+	{
+		num = 0;
+	}
+
+	void AnadirAtractor(irr::core::vector3df pos, float masa);
+
+	int GetNumAtractores() const
+	{
+		return num;
+	}
+
+	// Escribe en ax, ay, az la aceleracion de cada uno de los n puntos
+	// (x[i], y[i], z[i]) sumando todos los atractores en el orden en que se
+	// anadieron, o con el arbol si hay muchos. Usa la version SSE2 si esta
+	// activa.
+	void Calcular(const float *px, const float *py, const float *pz, int n,
+		float *ax, float *ay, float *az);
+
+	void CalcularEscalar(const float *px, const float *py, const float *pz, int n,
+		float *ax, float *ay, float *az) const;
+	void CalcularSSE2(const float *px, const float *py, const float *pz, int n,
+		float *ax, float *ay, float *az) const;
+
+	// Con el arbol de Barnes-Hut, haya los atractores que haya
+	void CalcularArbol(const float *px, const float *py, const float *pz, int n,
+		float *ax, float *ay, float *az);
+
+	// Angulo de apertura: 0 es exacto, y cuanto mayor mas rapido y menos
+	// preciso (THETA por defecto)
+	void SetTheta(float t)
+	{
+		theta = t;
+	}
+
+	float GetTheta() const
+	{
+		return theta;
+	}
+
+	// Atractores a partir de los que Calcular usa el arbol (UMBRAL_ARBOL
+	// por defecto)
+	void SetUmbralArbol(int n)
+	{
+		umbralArbol = n;
+	}
+
+	int GetUmbralArbol() const
+	{
+		return umbralArbol;
+	}
+
+	// La version SSE2 esta activa si la CPU la tiene; se puede desactivar
+	// para comparar
+	static bool GetVectorialDisponible();
+
+	void SetVectorial(bool activa)
+	{
+		vectorial = activa && GetVectorialDisponible();
+	}
+
+	bool GetVectorial() const
+	{
+		return vectorial;
+	}
+};
@@ -0,0 +1,357 @@
+#include "ImportadorAlturas.h"
+
+#include "GeneradorTerreno.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+using namespace irr;
+
+// Filas de un mapa de origen, en orden, con valores de 0 a 1
+class OrigenFilas
+{
+public:
+	int ancho;
+	int alto;
+
+	virtual ~OrigenFilas(void)
+	{
+	}
+
+	virtual bool SiguienteFila(float *fila) = 0;
+	virtual bool SaltarFila() = 0;
+};
+
+// Muestras de 8 o 16 bits de un fichero, leidas por bandas de filas
+class OrigenFichero : public OrigenFilas
+{
+private:
+	FILE *f;
+	int bytesMuestra;
+	bool bigEndian;
+	float escala;
+	unsigned char *banda;
+	int filasBanda;
+	int filaBanda;
+
+	const unsigned char *Fila()
+	{
+		if ( filaBanda == filasBanda )
+		{
+			size_t bytesFila = (size_t)ancho*bytesMuestra;
+			filasBanda = (int)(fread(banda, bytesFila, ImportadorAlturas::FILAS_BANDA, f));
+			filaBanda = 0;
+			if ( filasBanda == 0 )
+			{
+				return NULL;
+			}
+		}
+		return &banda[(size_t)(filaBanda++)*ancho*bytesMuestra];
+	}
+
+public:
+	OrigenFichero(FILE *f, int ancho, int alto, int maximo, bool bigEndian) :
+		f(f), bigEndian(bigEndian), filasBanda(0), filaBanda(0)
+	{
+		this->ancho = ancho;
+		this->alto = alto;
+		bytesMuestra = maximo > 255 ? 2 : 1;
+		escala = 1.0f / maximo;
+		banda = new unsigned char[(size_t)ImportadorAlturas::FILAS_BANDA*ancho*bytesMuestra];
+	}
+
+	virtual ~OrigenFichero(void)
+	{
+		delete [] banda;
+	}
+
+	virtual bool SiguienteFila(float *fila)
+	{
+		const unsigned char *p = Fila();
+		if ( p == NULL )
+		{
+			return false;
+		}
+
+		for ( int x = 0 ; x < ancho ; ++x )
+		{
+			int muestra = p[x];
+			if ( bytesMuestra == 2 )
+			{
+				muestra = bigEndian ? (p[x*2] << 8) | p[x*2+1] : p[x*2] | (p[x*2+1] << 8);
+			}
+			fila[x] = muestra*escala;
+		}
+		return true;
+	}
+
+	virtual bool SaltarFila()
+	{
+		return Fila() != NULL;
+	}
+};
+
+class OrigenImagen : public OrigenFilas
+{
+private:
+	video::IImage *imagen;
+	bool empaquetado16;
+	int y;
+
+public:
+	OrigenImagen(video::IImage *imagen, bool empaquetado16) :
+		imagen(imagen), empaquetado16(empaquetado16), y(0)
+	{
+		ancho = imagen->getDimension().Width;
+		alto = imagen->getDimension().Height;
+	}
+
+	virtual bool SiguienteFila(float *fila)
+	{
+		for ( int x = 0 ; x < ancho ; ++x )
+		{
+			video::SColor c = imagen->getPixel(x, y);
+			if ( empaquetado16 )
+			{
+				fila[x] = (c.getRed()*256 + c.getGreen()) / 65535.0f;
+			}
+			else
+			{
+				fila[x] = (c.getRed() + c.getGreen() + c.getBlue()) / (3*255.0f);
+			}
+		}
+		y++;
+		return true;
+	}
+
+	virtual bool SaltarFila()
+	{
+		y++;
+		return true;
+	}
+};
+
+// Rellena la rejilla del destino interpolando el origen. Las filas del
+// origen se leen una sola vez y en orden; solo se guardan dos.
+static bool
+Remuestrear(OrigenFilas &origen, float minimo, float maximo, GeneradorTerreno &destino)
+{
+	int W = destino.GetAncho();
+	int H = destino.GetAlto();
+	float *alturas = destino.GetAlturas();
+
+	float *filaA = new float[origen.ancho];
+	float *filaB = new float[origen.ancho];
+	int kA = -1;
+	int kB = -1;
+	int leidas = 0;
+	bool ok = true;
+
+	for ( int y = 0 ; ok && y < H ; ++y )
+	{
+		float sy = H > 1 ? y*(float)(origen.alto-1)/(H-1) : 0.0f;
+		int k = core::min_((int)sy, origen.alto-1);
+		int k1 = core::min_(k+1, origen.alto-1);
+		float ty = sy - k;
+
+		// filaA pasa a ser la fila k y filaB la k1
+		if ( kA != k )
+		{
+			if ( kB == k )
+			{
+				float *t = filaA;
+				filaA = filaB;
+				filaB = t;
+			}
+			else
+			{
+				while ( ok && leidas < k )
+				{
+					ok = origen.SaltarFila();
+					leidas++;
+				}
+				ok = ok && origen.SiguienteFila(filaA);
+				leidas++;
+			}
+			kA = k;
+			kB = -1;
+		}
+		if ( ok && k1 != k && kB != k1 )
+		{
+			ok = origen.SiguienteFila(filaB);
+			leidas++;
+			kB = k1;
+		}
+		const float *fila1 = k1 == k ? filaA : filaB;
+
+		float *destinoFila = &alturas[y*W];
+		for ( int x = 0 ; ok && x < W ; ++x )
+		{
+			float sx = W > 1 ? x*(float)(origen.ancho-1)/(W-1) : 0.0f;
+			int i = core::min_((int)sx, origen.ancho-1);
+			int i1 = core::min_(i+1, origen.ancho-1);
+			float tx = sx - i;
+
+			float arriba = filaA[i] + (filaA[i1] - filaA[i])*tx;
+			float abajo = fila1[i] + (fila1[i1] - fila1[i])*tx;
+			float v = arriba + (abajo - arriba)*ty;
+			destinoFila[x] = minimo + v*(maximo - minimo);
+		}
+	}
+
+	delete [] filaA;
+	delete [] filaB;
+	return ok;
+}
+
+static bool
+TerminaEn(const char *fichero, const char *extension)
+{
+	size_t n = strlen(fichero);
+	size_t e = strlen(extension);
+	return n >= e && strcmp(fichero + n - e, extension) == 0;
+}
+
+bool
+ImportadorAlturas::Cargar(const char *fichero, float minimo, float maximo, GeneradorTerreno &destino,
+	video::IVideoDriver *driver)
+{
+	if ( TerminaEn(fichero, ".pgm") )
+	{
+		return CargarPGM(fichero, minimo, maximo, destino);
+	}
+
+	if ( TerminaEn(fichero, ".raw") )
+	{
+		// Sin cabecera: suponemos un mapa cuadrado
+		FILE *f = fopen(fichero, "rb");
+		if ( f == NULL )
+		{
+			return false;
+		}
+		fseek(f, 0, SEEK_END);
+		long bytes = ftell(f);
+		fclose(f);
+
+		int lado = (int)(sqrt(bytes/2.0) + 0.5);
+		if ( (long)lado*lado*2 != bytes )
+		{
+			return false;
+		}
+		return CargarRAW16(fichero, lado, lado, false, minimo, maximo, destino);
+	}
+
+	return CargarImagen(driver, fichero, minimo, maximo, destino);
+}
+
+bool
+ImportadorAlturas::CargarRAW16(const char *fichero, int ancho, int alto, bool bigEndian,
+	float minimo, float maximo, GeneradorTerreno &destino)
+{
+	if ( ancho < 1 || alto < 1 )
+	{
+		return false;
+	}
+
+	FILE *f = fopen(fichero, "rb");
+	if ( f == NULL )
+	{
+		return false;
+	}
+
+	OrigenFichero origen(f, ancho, alto, 65535, bigEndian);
+	bool ok = Remuestrear(origen, minimo, maximo, destino);
+	fclose(f);
+	return ok;
+}
+
+// Siguiente numero de la cabecera de un PGM. Los comentarios "# alturas"
+// rellenan el rango.
+static bool
+LeerNumeroPGM(FILE *f, int &n, float &minimo, float &maximo)
+{
+	int c = fgetc(f);
+	while ( c != EOF && (isspace(c) || c == '#') )
+	{
+		if ( c == '#' )
+		{
+			char comentario[256];
+			if ( fgets(comentario, sizeof(comentario), f) == NULL )
+			{
+				return false;
+			}
+			float a, b;
+			if ( sscanf(comentario, " alturas %f %f", &a, &b) == 2 )
+			{
+				minimo = a;
+				maximo = b;
+			}
+		}
+		c = fgetc(f);
+	}
+
+	if ( c == EOF || !isdigit(c) )
+	{
+		return false;
+	}
+
+	n = 0;
+	while ( c != EOF && isdigit(c) )
+	{
+		n = n*10 + (c - '0');
+		c = fgetc(f);
+	}
+
+	// Detras del numero va un solo blanco
+	return c != EOF && isspace(c);
+}
+
+bool
+ImportadorAlturas::CargarPGM(const char *fichero, float minimo, float maximo, GeneradorTerreno &destino)
+{
+	FILE *f = fopen(fichero, "rb");
+	if ( f == NULL )
+	{
+		return false;
+	}
+
+	int ancho, alto, maximoMuestra;
+	bool ok = fgetc(f) == 'P' && fgetc(f) == '5' &&
+		LeerNumeroPGM(f, ancho, minimo, maximo) &&
+		LeerNumeroPGM(f, alto, minimo, maximo) &&
+		LeerNumeroPGM(f, maximoMuestra, minimo, maximo) &&
+		ancho > 0 && alto > 0 && maximoMuestra > 0 && maximoMuestra <= 65535;
+
+	if ( ok )
+	{
+		// PGM de 16 bits siempre es big endian
+		OrigenFichero origen(f, ancho, alto, maximoMuestra, true);
+		ok = Remuestrear(origen, minimo, maximo, destino);
+	}
+
+	fclose(f);
+	return ok;
+}
+
+bool
+ImportadorAlturas::CargarImagen(video::IVideoDriver *driver, const char *fichero,
+	float minimo, float maximo, GeneradorTerreno &destino, bool empaquetado16)
+{
+	if ( driver == NULL )
+	{
+		return false;
+	}
+
+	video::IImage *imagen = driver->createImageFromFile(fichero);
+	if ( imagen == NULL )
+	{
+		return false;
+	}
+
+	OrigenImagen origen(imagen, empaquetado16);
+	bool ok = Remuestrear(origen, minimo, maximo, destino);
+	imagen->drop();
+	return ok;
+}
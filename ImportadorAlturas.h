@@ -0,0 +1,38 @@
+#pragma once
+#include <irrlicht.h>
+
+class GeneradorTerreno;
+
+// Importa mapas de alturas externos a la rejilla de un GeneradorTerreno,
+// remuestreandolos (bilineal) al tamano de la rejilla. Las muestras del
+// fichero, de 0 a su maximo, se convierten a alturas de minimo a maximo.
+//
+// RAW y PGM se leen en bandas de filas y solo se guardan las dos filas del
+// origen que hacen falta para interpolar, asi que nunca estan a la vez el
+// mapa del fichero y la rejilla enteros en memoria.
+class ImportadorAlturas
+{
+public:
+	// Filas del origen que se leen de cada vez
+	static const int FILAS_BANDA = 64;
+
+	// Segun la extension: .raw (RAW16 cuadrado), .pgm, o cualquier imagen
+	// que sepa leer Irrlicht (necesita driver)
+	static bool Cargar(const char *fichero, float minimo, float maximo, GeneradorTerreno &destino,
+		irr::video::IVideoDriver *driver = NULL);
+
+	// Muestras de 16 bits sin cabecera
+	static bool CargarRAW16(const char *fichero, int ancho, int alto, bool bigEndian,
+		float minimo, float maximo, GeneradorTerreno &destino);
+
+	// PGM binario (P5) de 8 o 16 bits. Si trae el comentario "# alturas
+	// <min> <max>" de ExportadorAlturas, se usa ese rango en vez del que se
+	// pasa, y el mapa vuelve con sus alturas originales.
+	static bool CargarPGM(const char *fichero, float minimo, float maximo, GeneradorTerreno &destino);
+
+	// Imagen de Irrlicht (createImageFromFile), que se decodifica entera.
+	// La altura es el gris del pixel; con empaquetado16 es R*256+G, como
+	// guarda los PNG ExportadorAlturas.
+	static bool CargarImagen(irr::video::IVideoDriver *driver, const char *fichero,
+		float minimo, float maximo, GeneradorTerreno &destino, bool empaquetado16 = false);
+};
@@ -5,16 +5,26 @@
 #include "Pantalla.h"
 
 #include "SolNode.h"
+#include "PlanetaNode.h"
+#include "BufferEstatico.h"
+#include "DisparoNode.h"
+#include "PoolNodosDisparo.h"
 #include "Camara.h"
 
 #include <time.h>
 #include <math.h>
+#include <stdlib.h>
 #include <iostream>
+#include <stdio.h>
+#include <thread>
+#include <chrono>
 #include <irrlicht.h>
 
 using namespace irr;
 
 Juego * Juego::singleton = NULL;
+bool Juego::semillaFijada = false;
+Aleatorio::Semilla Juego::semillaFija = 0;
 
 Juego *
 Juego::GetInstance()
@@ -27,9 +37,22 @@ Juego::GetInstance()
 	return singleton;
 }
 
+void
+Juego::SetSemillaSesion(Aleatorio::Semilla s)
+{
+	semillaFijada = true;
+	semillaFija = s;
+}
+
 Juego::Juego(void)
 {
 	pantallaActual = NULL;
+	hzSimulacion = (float)HZ_SIMULACION;
+	escalaTiempo = 1.0f;
+	fpsMaximos = 0.0f;
+	ticks = 0;
+	enBenchmark = false;
+	mallaCubo = false;
 }
 
 Juego::~Juego(void)
@@ -39,7 +62,7 @@ Juego::~Juego(void)
 void
 Juego::Init()
 {
-	srand((unsigned int)time(NULL));
+	semilla = semillaFijada ? semillaFija : (Aleatorio::Semilla)time(NULL);
 
 	video::E_DRIVER_TYPE driverType = video::EDT_DIRECT3D9;
 
@@ -59,13 +82,20 @@ Juego::Init()
 
 	gui = device->getGUIEnvironment();
 
-	//Partida *partida = new Partida();
+	//Partida *partida = new Partida(semilla);
 
+	// Un parche entero (2^7+1 vertices por lado), para que el LOD tenga
+	// niveles: con los 100x100 por defecto ninguno divide sus 99 celdas
+	Aleatorio aleatorio(semilla);
 	SolNode *sol = new SolNode(
 		GetSceneManager()->getRootSceneNode(),
 		GetSceneManager(),
 		-1,
-		1.0);
+		1.0,
+		aleatorio,
+		SolNode::TAM_PARCHE,
+		SolNode::TAM_PARCHE);
+	sol->SetLOD(true);
 
 	GetSceneManager()->addLightSceneNode(NULL, core::vector3df(20.0f, -50.0f, 50.0f), 
 		video::SColorf(1,1,1,1), 2000);
@@ -86,20 +116,217 @@ Juego::Run()
 		return;
 	}
 
+	ITimer *timer = device->getTimer();
+	u32 anterior = timer->getRealTime();
+	f64 acumulado = 0.0;
+
 	while(device->run())
 	{
-		// Actualizamos
-		//pantallaActual->Update();
-		teclado->Update();
+		u32 ahora = timer->getRealTime();
+		acumulado += (ahora - anterior) / 1000.0 * escalaTiempo;
+		anterior = ahora;
+
+		// Actualizamos: los pasos fijos que caben en el tiempo transcurrido
+		f64 paso = 1.0 / hzSimulacion;
+		int maxPasos = (int)(MAX_PASOS_FRAME * core::max_(escalaTiempo, 1.0f));
+		int pasos = 0;
+		while ( acumulado >= paso && pasos < maxPasos )
+		{
+			if ( pantallaActual )
+			{
+				pantallaActual->Update();
+			}
+			// Las pulsaciones solo cuentan en el primer paso que las ve
+			teclado->Update();
+			ticks++;
+			acumulado -= paso;
+			pasos++;
+		}
+		if ( acumulado >= paso )
+		{
+			acumulado = 0.0;
+		}
 
-		// Dibujamos
+		// Dibujamos entre el penultimo y el ultimo paso
+		if ( pantallaActual )
+		{
+			pantallaActual->Interpolar((f32)(acumulado / paso));
+		}
 		GetVideoDriver()->beginScene(true, true, video::SColor(0,0,0,0));
 		GetSceneManager()->drawAll();
 		GetGui()->drawAll();
 		GetVideoDriver()->endScene();
 
+		// Esperamos lo que sobre del frame
+		if ( fpsMaximos > 0.0f )
+		{
+			u32 minimo = (u32)(1000.0f / fpsMaximos);
+			u32 gastado = timer->getRealTime() - ahora;
+			if ( gastado < minimo )
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(minimo - gastado));
+			}
+		}
+	}
+}
+
+// Pixeles en los que algun canal cambia mas de 2 entre las dos imagenes
+static int
+PixelesDistintos(video::IImage *a, video::IImage *b)
+{
+	core::dimension2d<s32> tam = a->getDimension();
+	if ( tam != b->getDimension() )
+	{
+		return tam.Width*tam.Height;
+	}
+
+	int distintos = 0;
+	for ( s32 y = 0 ; y < tam.Height ; y++ )
+	{
+		for ( s32 x = 0 ; x < tam.Width ; x++ )
+		{
+			video::SColor p = a->getPixel(x, y);
+			video::SColor q = b->getPixel(x, y);
+			if ( abs((s32)p.getRed() - (s32)q.getRed()) > 2 || abs((s32)p.getGreen() - (s32)q.getGreen()) > 2 ||
+				abs((s32)p.getBlue() - (s32)q.getBlue()) > 2 )
+			{
+				distintos++;
+			}
+		}
+	}
+	return distintos;
+}
+
+void
+Juego::Benchmark(int frames)
+{
+	if (!device)
+	{
+		return;
+	}
+	enBenchmark = true;
+
+	// Planetas en el plano XZ, delante de la camara, con la malla de -malla
+	const int NUM_PLANETAS = 25;
+	PlanetaNode *planetas[NUM_PLANETAS];
+	Aleatorio aleatorio(semilla);
+	printf("Semilla %llu, %d planetas con la malla %s\n", semilla, NUM_PLANETAS, mallaCubo ? "cubo" : "uv");
+	for ( int i = 0 ; i < NUM_PLANETAS ; i++ )
+	{
+		planetas[i] = new PlanetaNode(GetSceneManager()->getRootSceneNode(), GetSceneManager(), -1,
+			core::vector3df((i%5-2)*5.0f, 0.0f, (i/5-2)*5.0f), aleatorio,
+			NULL, mallaCubo ? PlanetaNode::MALLA_CUBO : PlanetaNode::MALLA_UV);
+		planetas[i]->drop();
+	}
+
+	// El calor baja como en Planeta::Update, y con el el color del terreno
+	float calor = 0.5f;
+	video::SColor colorHierba(255,0,255,0);
+	video::SColor colorNieve(255,128,128,255);
+
+	for ( int modo = 0 ; modo < 2 && device->run() ; modo++ )
+	{
+		BufferEstatico::SetActivo(modo == 1);
+		BufferEstatico::ReiniciarContadores();
+		PlanetaNode::ReiniciarContadoresColor();
+
+		// Los primeros frames suben los buffers
+		u32 inicio = 0;
+		for ( int f = 0 ; f < frames + 10 && device->run() ; f++ )
+		{
+			if ( f == 10 )
+			{
+				inicio = device->getTimer()->getRealTime();
+			}
+
+			calor = core::max_(calor - 0.00005f, 0.0f);
+			for ( int i = 0 ; i < NUM_PLANETAS ; i++ )
+			{
+				planetas[i]->SetColorTerreno(colorHierba.getInterpolated(colorNieve, calor*2.0f));
+			}
+
+			GetVideoDriver()->beginScene(true, true, video::SColor(0,0,0,0));
+			GetSceneManager()->drawAll();
+			GetVideoDriver()->endScene();
+		}
+		u32 tiempo = device->getTimer()->getRealTime() - inicio;
+
+		printf("%s: %.3f ms/frame (%d subidas, %d bytes)\n", modo == 0 ? "inmediato" : "buffers",
+			frames > 0 ? tiempo/(float)frames : 0.0f, BufferEstatico::GetSubidas(), BufferEstatico::GetBytesSubidos());
+		printf("  color del terreno: %.1f vertices escritos y %.1f evitados por frame\n",
+			PlanetaNode::GetEscriturasColor()/(float)(frames + 10),
+			PlanetaNode::GetEscriturasColorEvitadas()/(float)(frames + 10));
+	}
+
+	// Con el tiempo parado los buffers tienen que dibujar lo mismo que el
+	// camino inmediato
+	video::IImage *imagenes[2];
+	device->getTimer()->stop();
+	for ( int modo = 0 ; modo < 2 ; modo++ )
+	{
+		BufferEstatico::SetActivo(modo == 1);
+		GetVideoDriver()->beginScene(true, true, video::SColor(0,0,0,0));
+		GetSceneManager()->drawAll();
+		GetVideoDriver()->endScene();
+		imagenes[modo] = GetVideoDriver()->createScreenShot();
+	}
+	device->getTimer()->start();
+	if ( imagenes[0] && imagenes[1] )
+	{
+		int distintos = PixelesDistintos(imagenes[0], imagenes[1]);
+		printf("imagen: %d pixeles distintos entre inmediato y buffers %s\n", distintos, distintos == 0 ? "ok" : "FALLO");
+	}
+	for ( int modo = 0 ; modo < 2 ; modo++ )
+	{
+		if ( imagenes[modo] )
+		{
+			imagenes[modo]->drop();
+		}
+	}
+	BufferEstatico::SetActivo(true);
+
+	// Disparos: cada frame salen unos cuantos de cada tipo y explotan
+	// enseguida, creando sus nodos o sacandolos del pool
+	const int DISPAROS_POR_FRAME = 6;
+	for ( int modo = 0 ; modo < 2 && device->run() ; modo++ )
+	{
+		PoolNodosDisparo::SetActivo(modo == 1);
+		PoolNodosDisparo::ReiniciarContadores();
+		PoolNodosDisparo *pool = new PoolNodosDisparo(GetSceneManager());
+
+		u32 inicio = device->getTimer()->getRealTime();
+		for ( int f = 0 ; f < frames && device->run() ; f++ )
+		{
+			for ( int d = 0 ; d < DISPAROS_POR_FRAME ; d++ )
+			{
+				core::vector3df pos((d-DISPAROS_POR_FRAME/2)*3.0f, 0.0f, (f%20-10)*1.0f);
+				pool->Obtener(d%3 + 1, 20.0f, pos)->Destruir(false);
+			}
+
+			GetVideoDriver()->beginScene(true, true, video::SColor(0,0,0,0));
+			GetSceneManager()->drawAll();
+			GetVideoDriver()->endScene();
+		}
+		u32 tiempo = device->getTimer()->getRealTime() - inicio;
+
+		// Cuando acaba la explosion mas larga todos los nodos tienen que
+		// estar otra vez libres
+		u32 fin = device->getTimer()->getTime() + 2600;
+		while ( device->getTimer()->getTime() < fin && device->run() )
+		{
+			GetVideoDriver()->beginScene(true, true, video::SColor(0,0,0,0));
+			GetSceneManager()->drawAll();
+			GetVideoDriver()->endScene();
+		}
+		bool libres = pool->GetNumLibres() == pool->GetNumNodos();
 
+		printf("disparos %s: %.3f ms/frame (%d del pool, %d creados, %d nodos, %d libres al acabar) %s\n",
+			modo == 0 ? "sin pool" : "con pool", frames > 0 ? tiempo/(float)frames : 0.0f,
+			PoolNodosDisparo::GetAciertos(), PoolNodosDisparo::GetFallos(), pool->GetNumNodos(), pool->GetNumLibres(),
+			libres ? "ok" : "FALLO");
+		delete pool;
 	}
+	PoolNodosDisparo::SetActivo(true);
 }
 
 irr::IrrlichtDevice * 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Aleatorio.h"
+
 #include <irrlicht.h>
 using namespace irr;
 
@@ -10,23 +12,106 @@ class Juego
 {
 private:
 	static Juego * singleton;
+	static bool semillaFijada;
+	static Aleatorio::Semilla semillaFija;
 	irr::IrrlichtDevice * device;
 	Teclado *teclado;
 	Pantalla *pantallaActual;
 	gui::IGUIEnvironment* gui;
+	Aleatorio::Semilla semilla;
+
+	// Simulacion a paso fijo: hzSimulacion pasos por segundo de juego, y
+	// escalaTiempo segundos de juego por segundo real
+	float hzSimulacion;
+	float escalaTiempo;
+	float fpsMaximos;
+	u32 ticks;
+	bool enBenchmark;
+	bool mallaCubo;
 
 protected:
 	Juego(void);
 	void Init();
 public:
+	// Pasos de la simulacion por segundo si no se cambia
+	static const int HZ_SIMULACION = 60;
+
+	// Pasos de simulacion por frame como mucho (por unidad de escala de
+	// tiempo). Si no da tiempo a mas, el juego se ralentiza en lugar de
+	// acumular retraso.
+	static const int MAX_PASOS_FRAME = 8;
+
 	static Juego * GetInstance();
+
+	// Fija la semilla de la sesion (por defecto la hora), para repetir el
+	// mismo sistema y aprovechar la cache de mallas. Solo tiene efecto
+	// antes de la primera llamada a GetInstance, que crea el sol con ella.
+	static void SetSemillaSesion(Aleatorio::Semilla s);
 	virtual ~Juego(void);
+	// Bucle principal: la pantalla actual avanza a pasos fijos de
+	// 1/hzSimulacion segundos (Pantalla::Update) tantas veces como quepan en
+	// el tiempo transcurrido, y se dibuja una vez por frame interpolando
+	// entre los dos ultimos pasos (Pantalla::Interpolar)
 	void Run();
+
+	void SetFrecuenciaSimulacion(float hz)
+	{
+		hzSimulacion = hz;
+	}
+
+	// > 1 simula mas deprisa que el tiempo real
+	void SetEscalaTiempo(float escala)
+	{
+		escalaTiempo = escala;
+	}
+
+	// Frames por segundo como mucho (0 = sin limite)
+	void SetFPSMaximos(float fps)
+	{
+		fpsMaximos = fps;
+	}
+
+	// Los planetas de Benchmark y de las partidas con el cubo proyectado
+	// (PlanetaNode::MALLA_CUBO) en vez de la esfera UV
+	void SetMallaCubo(bool cubo)
+	{
+		mallaCubo = cubo;
+	}
+
+	bool GetMallaCubo()
+	{
+		return mallaCubo;
+	}
+
+	// Pasos de simulacion dados desde el principio
+	u32 GetTicks()
+	{
+		return ticks;
+	}
+
+	// Escena de prueba (el sol y una rejilla de planetas con la malla de
+	// SetMallaCubo): dibuja frames
+	// frames enviando la geometria en cada frame y otros tantos con
+	// BufferEstatico, y escribe el tiempo medio de cada modo
+	void Benchmark(int frames);
+
+	// Durante Benchmark los nodos escriben lo que tardan en crearse
+	bool GetEnBenchmark()
+	{
+		return enBenchmark;
+	}
+
 	irr::IrrlichtDevice * GetDevice();
 	scene::ISceneManager * GetSceneManager();
 	video::IVideoDriver * GetVideoDriver();
 	gui::IGUIEnvironment * GetGui();
 	void SetPantalla(Pantalla *pantalla);
+
+	// Semilla de la sesion; cada partida deriva de ella sus generadores
+	Aleatorio::Semilla GetSemilla()
+	{
+		return semilla;
+	}
 	//Raton * GetRaton();
 	Teclado * GetTeclado();
 	//GestorMusica * GetGestorMusica();
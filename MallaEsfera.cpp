@@ -0,0 +1,102 @@
+#include "MallaEsfera.h"
+
+#include <math.h>
+using namespace irr;
+
+MallaEsfera *MallaEsfera::primera = NULL;
+
+MallaEsfera::MallaEsfera(int meridianos, int paralelos, MODO_UV modo, video::SColor color)
+	: meridianos(meridianos), paralelos(paralelos), modo(modo), color(color)
+{
+	float PI = 3.141592f;
+
+	numVertices = (meridianos+1)*(paralelos+1);
+	numIndices = meridianos*paralelos*2*3;
+
+	// Generamos los vertices (el ultimo meridiano repite el primero con otra
+	// coordenada de textura)
+	vertices = new video::S3DVertex[numVertices];
+	int nv = 0;
+	for ( int m = 0 ; m <= meridianos ; m++ )
+	{
+		float theta = m*(2*PI) / meridianos;
+		for ( int p = 0 ; p <= paralelos ; p++ )
+		{
+			float phi = -PI/2 + p*PI / paralelos;
+			float u = modo == UV_NORMALIZADAS ? theta/(2*PI) : theta;
+			float v = modo == UV_NORMALIZADAS ? phi/PI : phi;
+			vertices[nv] = video::S3DVertex(cos(phi)*cos(theta), sin(phi), cos(phi)*sin(theta), cos(phi)*cos(theta), sin(phi), cos(phi)*sin(theta), color, u, v);
+			nv++;
+		}
+	}
+
+	// Generamos los triangulos
+	indices = new u16[numIndices];
+	int nTrig = 0 ;
+	for ( int p = 0 ; p < paralelos ; p++ )
+	{
+		for ( int m = 0 ; m < meridianos ; m++ )
+		{
+			indices[nTrig*3+0] = m*(paralelos+1) + p ;
+			indices[nTrig*3+1] = m*(paralelos+1) + ((p+1));
+			indices[nTrig*3+2] = ((m+1))*(paralelos+1) + p ;
+			nTrig++;
+
+			indices[nTrig*3+0] = m*(paralelos+1) + ((p+1));
+			indices[nTrig*3+1] = ((m+1))*(paralelos+1) + ((p+1)) ;
+			indices[nTrig*3+2] = ((m+1))*(paralelos+1) + p ;
+			nTrig++;
+		}
+	}
+
+	// Calculamos el bounding box
+	box.reset(vertices[0].Pos);
+	for (s32 i=1; i<numVertices; ++i)
+	{
+		box.addInternalPoint(vertices[i].Pos);
+	}
+
+	siguiente = primera;
+	primera = this;
+}
+
+MallaEsfera::~MallaEsfera(void)
+{
+	// Fuera de la lista
+	MallaEsfera **p = &primera;
+	while ( *p != this )
+	{
+		p = &(*p)->siguiente;
+	}
+	*p = siguiente;
+
+	delete [] vertices;
+	delete [] indices;
+}
+
+MallaEsfera *
+MallaEsfera::Obtener(int meridianos, int paralelos, MODO_UV modo, video::SColor color)
+{
+	for ( MallaEsfera *m = primera ; m != NULL ; m = m->siguiente )
+	{
+		if ( m->meridianos == meridianos && m->paralelos == paralelos && m->modo == modo && m->color == color )
+		{
+			m->grab();
+			return m;
+		}
+	}
+
+	// Nace con la referencia del llamante
+	return new MallaEsfera(meridianos, paralelos, modo, color);
+}
+
+int
+MallaEsfera::GetNumMallas()
+{
+	int n = 0;
+	for ( MallaEsfera *m = primera ; m != NULL ; m = m->siguiente )
+	{
+		n++;
+	}
+	return n;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <irrlicht.h>
+
+#include "BufferEstatico.h"
+
+// Esfera unidad de meridianos x paralelos compartida entre todos los nodos que
+// la piden igual (el mar y la atmosfera de cada planeta y el fondo). Los
+// vertices y los indices no cambian despues de crearse: lo propio de cada
+// nodo (escala, posicion, material) va en el nodo.
+//
+// Se cuenta por referencias como el resto de objetos de Irrlicht: Obtener
+// devuelve la malla con una referencia mas, que el nodo suelta con drop()
+// al destruirse. Cuando no queda ninguna la malla se borra y sale de la
+// cache.
+class MallaEsfera : public irr::IUnknown
+{
+public:
+	// Coordenadas de textura: (theta, phi) en radianes o divididas por 2PI y
+	// PI
+	enum MODO_UV
+	{
+		UV_RADIANES = 0,
+		UV_NORMALIZADAS
+	};
+
+private:
+	int meridianos;
+	int paralelos;
+	MODO_UV modo;
+	irr::video::SColor color;
+
+	irr::video::S3DVertex *vertices;
+	irr::u16 *indices;
+	int numVertices;
+	int numIndices;
+	irr::core::aabbox3d<irr::f32> box;
+	BufferEstatico buffer;
+
+	// Lista de las mallas vivas
+	static MallaEsfera *primera;
+	MallaEsfera *siguiente;
+
+	MallaEsfera(int meridianos, int paralelos, MODO_UV modo, irr::video::SColor color);
+	virtual ~MallaEsfera(void);
+
+public:
+	// La malla de esos parametros, con una referencia para el llamante. El
+	// color de los vertices tambien distingue mallas, porque con
+	// EMT_TRANSPARENT_VERTEX_ALPHA su alfa es la transparencia.
+	static MallaEsfera *Obtener(int meridianos, int paralelos, MODO_UV modo, irr::video::SColor color);
+
+	// Mallas distintas que hay creadas
+	static int GetNumMallas();
+
+	void Dibujar(irr::video::IVideoDriver *driver)
+	{
+		buffer.Dibujar(driver, vertices, numVertices, indices, numIndices/3);
+	}
+
+	const irr::core::aabbox3d<irr::f32>& GetBoundingBox() const
+	{
+		return box;
+	}
+
+	int GetNumVertices() const
+	{
+		return numVertices;
+	}
+
+	int GetNumIndices() const
+	{
+		return numIndices;
+	}
+};
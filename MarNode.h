@@ -1,21 +1,20 @@
 #pragma once
 #include <irrlicht.h>
 
+#include "MallaEsfera.h"
+
 class MarNode :
 	public irr::scene::ISceneNode
 {
 private:
-	irr::core::aabbox3d<irr::f32> box;
-	irr::video::S3DVertex *vertices;
+	MallaEsfera *malla;
 	irr::video::SMaterial material;
-	irr::u16 *indices ;
 	float radio;
+	float radioAnterior;
 	float d_radio;
 
 	static const int NUM_PARALELOS = 15;
 	static const int NUM_MERIDIANOS = 30;
-	int NUM_VERTICES;
-	int NUM_INDICES;
 
 public:
 	MarNode(irr::scene::ISceneNode* parent, irr::scene::ISceneManager* mgr, irr::s32 id,float radio);
@@ -24,9 +23,13 @@ public:
 	virtual void OnPreRender();
 	virtual void render();
 
+	// Un paso de la simulacion: el radio se acerca al deseado
+	void Actualizar();
+	void Interpolar(float alpha);
+
 		virtual const irr::core::aabbox3d<irr::f32>& getBoundingBox() const
 	{
-		return box;
+		return malla->GetBoundingBox();
 	}
 
 	virtual irr::s32 getMaterialCount()
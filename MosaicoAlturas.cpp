@@ -0,0 +1,360 @@
+#include "MosaicoAlturas.h"
+
+#include "ArchivoMapeado.h"
+#include "GeneradorTerreno.h"
+
+#include <string.h>
+using namespace irr;
+
+static const char MAGIA[4] = { 'G', 'T', 'M', 'A' };
+
+static const int TAM_MUESTRA[NUM_TIPOS_MUESTRA] = { sizeof(u16), sizeof(f32) };
+
+static size_t
+BytesMosaico(const CabeceraMosaico &c)
+{
+	size_t bytes = (size_t)c.tamMosaico*c.tamMosaico*TAM_MUESTRA[c.tipoMuestra];
+	size_t alineacion = EscritorMosaico::ALINEACION_MOSAICO;
+	return (bytes + alineacion-1) / alineacion * alineacion;
+}
+
+// ---------------------------------------------------------------------------
+// EscritorMosaico
+// ---------------------------------------------------------------------------
+
+EscritorMosaico::EscritorMosaico(void) : fichero(NULL), indice(NULL), banda(NULL), filasBanda(0),
+	bandaActual(0), ok(false)
+{
+}
+
+EscritorMosaico::~EscritorMosaico(void)
+{
+	Cerrar();
+}
+
+bool
+EscritorMosaico::Abrir(const char *nombre, int ancho, int alto, int tamMosaico, TIPO_MUESTRA tipo,
+	float minimo, float maximo)
+{
+	Cerrar();
+
+	if ( ancho < 1 || alto < 1 || tamMosaico < 1 || tipo < 0 || tipo >= NUM_TIPOS_MUESTRA )
+	{
+		return false;
+	}
+
+	fichero = fopen(nombre, "wb");
+	if ( fichero == NULL )
+	{
+		return false;
+	}
+
+	memset(&cabecera, 0, sizeof(cabecera));
+	memcpy(cabecera.magia, MAGIA, sizeof(MAGIA));
+	cabecera.version = VERSION;
+	cabecera.ancho = ancho;
+	cabecera.alto = alto;
+	cabecera.tamMosaico = tamMosaico;
+	cabecera.tipoMuestra = tipo;
+	cabecera.mosaicosX = (ancho + tamMosaico-1) / tamMosaico;
+	cabecera.mosaicosY = (alto + tamMosaico-1) / tamMosaico;
+	cabecera.minimo = minimo;
+	cabecera.maximo = maximo;
+	cabecera.desplazamientoIndice = sizeof(CabeceraMosaico);
+	if ( tipo == MUESTRA_U16 )
+	{
+		cabecera.escala = (maximo - minimo) / 65535.0f;
+		cabecera.desplazamiento = minimo;
+	}
+	else
+	{
+		cabecera.escala = 1.0f;
+		cabecera.desplazamiento = 0.0f;
+	}
+
+	// Los mosaicos empiezan en la primera posicion alineada tras el indice
+	int numMosaicos = cabecera.mosaicosX*cabecera.mosaicosY;
+	unsigned long long inicio = sizeof(CabeceraMosaico) + numMosaicos*sizeof(EntradaMosaico);
+	inicio = (inicio + ALINEACION_MOSAICO-1) / ALINEACION_MOSAICO * ALINEACION_MOSAICO;
+
+	indice = new EntradaMosaico[numMosaicos];
+	for ( int i = 0 ; i < numMosaicos ; ++i )
+	{
+		indice[i].desplazamiento = inicio + i*(unsigned long long)BytesMosaico(cabecera);
+		indice[i].minimo = 0.0f;
+		indice[i].maximo = 0.0f;
+	}
+
+	banda = new float[(size_t)tamMosaico*cabecera.mosaicosX*tamMosaico];
+	filasBanda = 0;
+	bandaActual = 0;
+
+	// La cabecera y el indice se reescriben al cerrar, con los rangos ya
+	// calculados; hasta entonces reservamos su sitio
+	ok = fwrite(&cabecera, sizeof(cabecera), 1, fichero) == 1 &&
+		fwrite(indice, sizeof(EntradaMosaico), numMosaicos, fichero) == (size_t)numMosaicos;
+	for ( unsigned long long p = sizeof(CabeceraMosaico) + numMosaicos*sizeof(EntradaMosaico) ; ok && p < inicio ; ++p )
+	{
+		ok = fputc(0, fichero) != EOF;
+	}
+
+	return ok;
+}
+
+bool
+EscritorMosaico::EscribirFila(const float *fila)
+{
+	if ( fichero == NULL || bandaActual >= (int)cabecera.mosaicosY )
+	{
+		return false;
+	}
+
+	// La fila se completa hasta el ancho de los mosaicos repitiendo la
+	// ultima muestra
+	int anchoBanda = cabecera.tamMosaico*cabecera.mosaicosX;
+	float *destino = &banda[(size_t)filasBanda*anchoBanda];
+	memcpy(destino, fila, cabecera.ancho*sizeof(float));
+	for ( int x = cabecera.ancho ; x < anchoBanda ; ++x )
+	{
+		destino[x] = fila[cabecera.ancho-1];
+	}
+
+	filasBanda++;
+	int filasEscritas = bandaActual*cabecera.tamMosaico + filasBanda;
+	if ( filasBanda == (int)cabecera.tamMosaico || filasEscritas == (int)cabecera.alto )
+	{
+		ok = EscribirBanda() && ok;
+	}
+	return ok;
+}
+
+bool
+EscritorMosaico::EscribirBanda()
+{
+	int tam = cabecera.tamMosaico;
+	int anchoBanda = tam*cabecera.mosaicosX;
+
+	// La ultima banda se completa repitiendo la ultima fila
+	for ( int y = filasBanda ; y < tam ; ++y )
+	{
+		memcpy(&banda[(size_t)y*anchoBanda], &banda[(size_t)(filasBanda-1)*anchoBanda], anchoBanda*sizeof(float));
+	}
+
+	char *mosaico = new char[BytesMosaico(cabecera)];
+	memset(mosaico, 0, BytesMosaico(cabecera));
+
+	bool escrito = true;
+	for ( int mx = 0 ; mx < (int)cabecera.mosaicosX ; ++mx )
+	{
+		EntradaMosaico &entrada = indice[bandaActual*cabecera.mosaicosX + mx];
+		entrada.minimo = banda[mx*tam];
+		entrada.maximo = banda[mx*tam];
+
+		for ( int y = 0 ; y < tam ; ++y )
+		{
+			const float *origen = &banda[(size_t)y*anchoBanda + mx*tam];
+			for ( int x = 0 ; x < tam ; ++x )
+			{
+				float h = origen[x];
+				if ( cabecera.tipoMuestra == MUESTRA_U16 )
+				{
+					float q = cabecera.escala > 0.0f ? (h - cabecera.desplazamiento) / cabecera.escala : 0.0f;
+					q = core::min_(core::max_(q, 0.0f), 65535.0f);
+					u16 muestra = (u16)(q + 0.5f);
+					((u16 *)mosaico)[y*tam+x] = muestra;
+
+					// El rango del indice es el de lo que se guarda
+					h = muestra*cabecera.escala + cabecera.desplazamiento;
+				}
+				else
+				{
+					((f32 *)mosaico)[y*tam+x] = h;
+				}
+				entrada.minimo = core::min_(entrada.minimo, h);
+				entrada.maximo = core::max_(entrada.maximo, h);
+			}
+		}
+
+		escrito = escrito && fwrite(mosaico, 1, BytesMosaico(cabecera), fichero) == BytesMosaico(cabecera);
+	}
+
+	delete [] mosaico;
+
+	filasBanda = 0;
+	bandaActual++;
+	return escrito;
+}
+
+bool
+EscritorMosaico::Cerrar()
+{
+	if ( fichero == NULL )
+	{
+		return false;
+	}
+
+	// Si faltan filas el fichero queda incompleto
+	bool completo = ok && bandaActual == (int)cabecera.mosaicosY;
+	if ( completo )
+	{
+		int numMosaicos = cabecera.mosaicosX*cabecera.mosaicosY;
+		completo = fseek(fichero, 0, SEEK_SET) == 0 &&
+			fwrite(&cabecera, sizeof(cabecera), 1, fichero) == 1 &&
+			fwrite(indice, sizeof(EntradaMosaico), numMosaicos, fichero) == (size_t)numMosaicos;
+	}
+	completo = fclose(fichero) == 0 && completo;
+
+	fichero = NULL;
+	delete [] indice;
+	indice = NULL;
+	delete [] banda;
+	banda = NULL;
+	ok = false;
+	return completo;
+}
+
+bool
+EscritorMosaico::Guardar(const char *nombre, const GeneradorTerreno &generador, int tamMosaico, TIPO_MUESTRA tipo)
+{
+	int W = generador.GetAncho();
+	int H = generador.GetAlto();
+	const float *alturas = generador.GetAlturas();
+
+	float minimo = alturas[0];
+	float maximo = alturas[0];
+	for ( int i = 1 ; i < W*H ; ++i )
+	{
+		minimo = core::min_(minimo, alturas[i]);
+		maximo = core::max_(maximo, alturas[i]);
+	}
+
+	EscritorMosaico escritor;
+	bool ok = escritor.Abrir(nombre, W, H, tamMosaico, tipo, minimo, maximo);
+	for ( int y = 0 ; ok && y < H ; ++y )
+	{
+		ok = escritor.EscribirFila(&alturas[y*W]);
+	}
+	return escritor.Cerrar() && ok;
+}
+
+// ---------------------------------------------------------------------------
+// LectorMosaico
+// ---------------------------------------------------------------------------
+
+LectorMosaico::LectorMosaico(void) : archivo(NULL), cabecera(NULL), indice(NULL)
+{
+}
+
+LectorMosaico::~LectorMosaico(void)
+{
+	Cerrar();
+}
+
+bool
+LectorMosaico::Abrir(const char *nombre)
+{
+	Cerrar();
+
+	archivo = new ArchivoMapeado();
+	if ( !archivo->Abrir(nombre, true) || archivo->GetTamano() < sizeof(CabeceraMosaico) )
+	{
+		Cerrar();
+		return false;
+	}
+
+	const char *datos = (const char *)archivo->GetDatos();
+	size_t tamano = archivo->GetTamano();
+	const CabeceraMosaico *c = (const CabeceraMosaico *)datos;
+
+	bool valido = memcmp(c->magia, MAGIA, sizeof(MAGIA)) == 0 &&
+		c->version == (u32)EscritorMosaico::VERSION &&
+		c->tipoMuestra < NUM_TIPOS_MUESTRA &&
+		c->ancho > 0 && c->alto > 0 && c->tamMosaico > 0 &&
+		c->mosaicosX == (c->ancho + c->tamMosaico-1) / c->tamMosaico &&
+		c->mosaicosY == (c->alto + c->tamMosaico-1) / c->tamMosaico &&
+		c->desplazamientoIndice % sizeof(unsigned long long) == 0 &&
+		c->desplazamientoIndice + (unsigned long long)c->mosaicosX*c->mosaicosY*sizeof(EntradaMosaico) <= tamano;
+
+	// Comprobamos que todos los mosaicos estan dentro del fichero
+	const EntradaMosaico *entradas = valido ? (const EntradaMosaico *)(datos + c->desplazamientoIndice) : NULL;
+	for ( u32 i = 0 ; valido && i < c->mosaicosX*c->mosaicosY ; ++i )
+	{
+		valido = entradas[i].desplazamiento % TAM_MUESTRA[c->tipoMuestra] == 0 &&
+			entradas[i].desplazamiento + (unsigned long long)c->tamMosaico*c->tamMosaico*TAM_MUESTRA[c->tipoMuestra] <= tamano;
+	}
+
+	if ( !valido )
+	{
+		Cerrar();
+		return false;
+	}
+
+	cabecera = c;
+	indice = entradas;
+	return true;
+}
+
+void
+LectorMosaico::Cerrar()
+{
+	delete archivo;
+	archivo = NULL;
+	cabecera = NULL;
+	indice = NULL;
+}
+
+const char *
+LectorMosaico::GetMosaico(int mx, int my) const
+{
+	return (const char *)archivo->GetDatos() + indice[my*cabecera->mosaicosX+mx].desplazamiento;
+}
+
+float
+LectorMosaico::GetAltura(int x, int y) const
+{
+	int tam = cabecera->tamMosaico;
+	const char *mosaico = GetMosaico(x / tam, y / tam);
+	int i = (y % tam)*tam + x % tam;
+
+	if ( cabecera->tipoMuestra == MUESTRA_U16 )
+	{
+		return ((const u16 *)mosaico)[i]*cabecera->escala + cabecera->desplazamiento;
+	}
+	return ((const f32 *)mosaico)[i];
+}
+
+void
+LectorMosaico::LeerVentana(float *destino, int x0, int y0, int ancho, int alto) const
+{
+	int tam = cabecera->tamMosaico;
+	for ( int j = 0 ; j < alto ; ++j )
+	{
+		int y = y0 + j;
+		int my = y / tam;
+		int fila = (y % tam)*tam;
+
+		// Tramo de la fila que cae en cada mosaico
+		int x = x0;
+		while ( x < x0 + ancho )
+		{
+			int mx = x / tam;
+			int fin = core::min_((mx+1)*tam, x0 + ancho);
+			const char *mosaico = GetMosaico(mx, my);
+			float *d = &destino[j*ancho + x - x0];
+
+			if ( cabecera->tipoMuestra == MUESTRA_U16 )
+			{
+				const u16 *origen = (const u16 *)mosaico + fila + x % tam;
+				for ( int i = 0 ; i < fin - x ; ++i )
+				{
+					d[i] = origen[i]*cabecera->escala + cabecera->desplazamiento;
+				}
+			}
+			else
+			{
+				memcpy(d, (const f32 *)mosaico + fila + x % tam, (fin - x)*sizeof(float));
+			}
+			x = fin;
+		}
+	}
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <irrlicht.h>
+
+#include <stdio.h>
+
+class ArchivoMapeado;
+class GeneradorTerreno;
+
+// Formato de mapas de alturas por mosaicos, para terrenos que no caben en
+// memoria. El fichero tiene:
+//   - CabeceraMosaico: tamano del mapa, de los mosaicos y tipo de muestra
+//   - El indice: una EntradaMosaico (posicion, minimo y maximo) por mosaico,
+//     fila a fila de mosaicos
+//   - Los mosaicos, de tamMosaico x tamMosaico muestras cada uno, alineados
+//     a ALINEACION_MOSAICO bytes. Los del borde se rellenan repitiendo la
+//     ultima fila o columna del mapa.
+// Las muestras de 16 bits se convierten con altura = muestra*escala +
+// desplazamiento; las float se guardan tal cual.
+enum TIPO_MUESTRA
+{
+	MUESTRA_U16 = 0,
+	MUESTRA_F32,
+
+	NUM_TIPOS_MUESTRA
+};
+
+struct CabeceraMosaico
+{
+	char magia[4];
+	irr::u32 version;
+	irr::u32 ancho;
+	irr::u32 alto;
+	irr::u32 tamMosaico;
+	irr::u32 tipoMuestra;
+	irr::u32 mosaicosX;
+	irr::u32 mosaicosY;
+	irr::f32 escala;
+	irr::f32 desplazamiento;
+	irr::f32 minimo;
+	irr::f32 maximo;
+	unsigned long long desplazamientoIndice;
+	irr::u32 reservado[2];
+};
+
+struct EntradaMosaico
+{
+	unsigned long long desplazamiento;
+	irr::f32 minimo;
+	irr::f32 maximo;
+};
+
+// Escribe un mapa fila a fila. Solo guarda en memoria una banda de
+// tamMosaico filas, asi que el mapa puede ser mucho mas grande que la RAM.
+class EscritorMosaico
+{
+private:
+	FILE *fichero;
+	CabeceraMosaico cabecera;
+	EntradaMosaico *indice;
+	float *banda;
+	int filasBanda;
+	int bandaActual;
+	bool ok;
+
+	bool EscribirBanda();
+
+public:
+	static const int VERSION = 1;
+	static const int ALINEACION_MOSAICO = 4096;
+
+	EscritorMosaico(void);
+	virtual ~EscritorMosaico(void);
+
+	// Con MUESTRA_U16, minimo y maximo fijan el rango que se cuantiza (las
+	// alturas de fuera se recortan); con MUESTRA_F32 solo se guardan.
+	bool Abrir(const char *nombre, int ancho, int alto, int tamMosaico, TIPO_MUESTRA tipo,
+		float minimo, float maximo);
+
+	// Las filas van en orden, de y = 0 a alto-1
+	bool EscribirFila(const float *fila);
+
+	// Completa la ultima banda y escribe el indice. Devuelve false si algo
+	// fallo desde Abrir.
+	bool Cerrar();
+
+	// Guarda las alturas de un generador
+	static bool Guardar(const char *nombre, const GeneradorTerreno &generador, int tamMosaico, TIPO_MUESTRA tipo);
+};
+
+// Lee un mapa por mosaicos proyectando el fichero en memoria. Abrir solo
+// lee la cabecera y el indice, asi que es instantaneo con cualquier tamano;
+// el sistema carga las paginas de cada mosaico la primera vez que se tocan.
+class LectorMosaico
+{
+private:
+	ArchivoMapeado *archivo;
+	const CabeceraMosaico *cabecera;
+	const EntradaMosaico *indice;
+
+	const char *GetMosaico(int mx, int my) const;
+
+public:
+	LectorMosaico(void);
+	virtual ~LectorMosaico(void);
+
+	bool Abrir(const char *nombre);
+	void Cerrar();
+
+	int GetAncho() const
+	{
+		return cabecera->ancho;
+	}
+
+	int GetAlto() const
+	{
+		return cabecera->alto;
+	}
+
+	int GetTamMosaico() const
+	{
+		return cabecera->tamMosaico;
+	}
+
+	int GetMosaicosX() const
+	{
+		return cabecera->mosaicosX;
+	}
+
+	int GetMosaicosY() const
+	{
+		return cabecera->mosaicosY;
+	}
+
+	TIPO_MUESTRA GetTipoMuestra() const
+	{
+		return (TIPO_MUESTRA)cabecera->tipoMuestra;
+	}
+
+	// Rango de alturas de un mosaico, sin tocar sus muestras
+	float GetMinimo(int mx, int my) const
+	{
+		return indice[my*cabecera->mosaicosX+mx].minimo;
+	}
+
+	float GetMaximo(int mx, int my) const
+	{
+		return indice[my*cabecera->mosaicosX+mx].maximo;
+	}
+
+	float GetAltura(int x, int y) const;
+
+	// Copia en destino (ancho floats por fila) las alturas del rectangulo
+	// que empieza en (x0,y0), que tiene que estar dentro del mapa. Solo toca
+	// los mosaicos que cubre el rectangulo.
+	void LeerVentana(float *destino, int x0, int y0, int ancho, int alto) const;
+};
@@ -0,0 +1,396 @@
+#include "OperadoresTerreno.h"
+
+#include "OperadoresTerrenoAprox.h"
+
+#include <cmath>
+#include <string.h>
+using namespace std;
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define OPERADORES_X86
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+const float OperadoresTerreno::ERROR_ARCOTANGENTE = 1e-6f;
+const float OperadoresTerreno::ERROR_PARABOLOIDE = 1e-7f;
+const float OperadoresTerreno::ERROR_POTENCIAL = 4e-6f;
+
+static OperadoresTerreno::NIVEL nivelActual = OperadoresTerreno::Detectar();
+
+// -------------------------------------------------------------------
+// Deteccion de la CPU
+// -------------------------------------------------------------------
+
+#ifdef OPERADORES_X86
+static void
+Cpuid(unsigned int hoja, unsigned int subhoja, unsigned int r[4])
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuidex(info, (int)hoja, (int)subhoja);
+	r[0] = info[0];
+	r[1] = info[1];
+	r[2] = info[2];
+	r[3] = info[3];
+#else
+	r[0] = r[1] = r[2] = r[3] = 0;
+	__cpuid_count(hoja, subhoja, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+static unsigned long long
+Xgetbv()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+#endif
+
+OperadoresTerreno::NIVEL
+OperadoresTerreno::Detectar()
+{
+#ifdef OPERADORES_X86
+	unsigned int r[4];
+	Cpuid(0, 0, r);
+	unsigned int maxHoja = r[0];
+	if ( maxHoja < 1 )
+	{
+		return NIVEL_ESCALAR;
+	}
+
+	Cpuid(1, 0, r);
+	bool sse2 = (r[3] & (1u << 26)) != 0;
+	bool osxsave = (r[2] & (1u << 27)) != 0;
+	bool avx = (r[2] & (1u << 28)) != 0;
+	if ( !sse2 )
+	{
+		return NIVEL_ESCALAR;
+	}
+
+	// AVX2 necesita ademas que el sistema guarde los registros YMM
+	if ( osxsave && avx && maxHoja >= 7 && (Xgetbv() & 6) == 6 )
+	{
+		Cpuid(7, 0, r);
+		if ( r[1] & (1u << 5) )
+		{
+			return NIVEL_AVX2;
+		}
+	}
+	return NIVEL_SSE2;
+#else
+	return NIVEL_ESCALAR;
+#endif
+}
+
+OperadoresTerreno::NIVEL
+OperadoresTerreno::GetNivel()
+{
+	return nivelActual;
+}
+
+void
+OperadoresTerreno::SetNivel(NIVEL nivel)
+{
+	NIVEL maximo = Detectar();
+	nivelActual = nivel > maximo ? maximo : nivel;
+}
+
+const char *
+OperadoresTerreno::NombreNivel(NIVEL nivel)
+{
+	switch (nivel)
+	{
+	case NIVEL_SSE2:
+		return "SSE2";
+	case NIVEL_AVX2:
+		return "AVX2";
+	default:
+		return "escalar";
+	}
+}
+
+OperadoresTerreno::FuncionFila
+OperadoresTerreno::GetFuncion(TIPO_OPERADOR tipo)
+{
+	return GetFuncion(tipo, nivelActual);
+}
+
+OperadoresTerreno::FuncionFila
+OperadoresTerreno::GetFuncion(TIPO_OPERADOR tipo, NIVEL nivel)
+{
+	static const FuncionFila tabla[3][NUM_OPERADORES] =
+	{
+		{ ArcotangenteEscalar, ParaboloideEscalar, PotencialEscalar },
+		{ ArcotangenteSSE2, ParaboloideSSE2, PotencialSSE2 },
+		{ ArcotangenteAVX2, ParaboloideAVX2, PotencialAVX2 }
+	};
+	return tabla[nivel][tipo];
+}
+
+// -------------------------------------------------------------------
+// Version escalar (referencia)
+// -------------------------------------------------------------------
+
+void
+OperadoresTerreno::ArcotangenteEscalar(float *fila, int W, float y, const BultoTerreno &b)
+{
+	float PI = APROX_PI_TERRENO;
+	float dy2 = (y-b.y0)*(y-b.y0);
+	for ( int x = 0 ; x < W ; ++x )
+	{
+		float dist = sqrt( (x-b.x0)*(x-b.x0) + dy2 ) ;
+
+		fila[x] += b.mag * atan(1 - dist*b.param)/PI + PI/2;
+	}
+}
+
+void
+OperadoresTerreno::ParaboloideEscalar(float *fila, int W, float y, const BultoTerreno &b)
+{
+	float dy2 = (y-b.y0)*(y-b.y0);
+	for ( int x = 0 ; x < W ; ++x )
+	{
+		float dist = pow( (x-b.x0)*(x-b.x0) + dy2, 2 ) / b.param ;
+		if ( dist < b.mag )
+		{
+			fila[x] += b.mag - dist ;
+		}
+	}
+}
+
+void
+OperadoresTerreno::PotencialEscalar(float *fila, int W, float y, const BultoTerreno &b)
+{
+	float dy2 = (y-b.y0)*(y-b.y0);
+	for ( int x = 0 ; x < W ; ++x )
+	{
+		float dist = pow( (x-b.x0)*(x-b.x0) + dy2, b.param );
+
+		fila[x] += b.mag/dist;
+	}
+}
+
+// -------------------------------------------------------------------
+// Version SSE2
+// -------------------------------------------------------------------
+
+#ifdef OPERADORES_X86
+
+static inline __m128
+Seleccionar(__m128 mascara, __m128 si, __m128 no)
+{
+	return _mm_or_ps(_mm_and_ps(mascara, si), _mm_andnot_ps(mascara, no));
+}
+
+// 1/sqrt(x) con la estimacion de 12 bits y un paso de Newton
+static inline __m128
+Rsqrt(__m128 x)
+{
+	__m128 r = _mm_rsqrt_ps(x);
+	__m128 xr2 = _mm_mul_ps(_mm_mul_ps(x, r), r);
+	return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), _mm_sub_ps(_mm_set1_ps(3.0f), xr2));
+}
+
+static inline __m128
+Atan(__m128 x)
+{
+	__m128 mascaraSigno = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+	__m128 signo = _mm_and_ps(x, mascaraSigno);
+	__m128 a = _mm_andnot_ps(mascaraSigno, x);
+
+	// Para |x| > 1 usamos atan(x) = PI/2 - atan(1/x)
+	__m128 uno = _mm_set1_ps(1.0f);
+	__m128 mayor = _mm_cmpgt_ps(a, uno);
+	__m128 t = Seleccionar(mayor, _mm_div_ps(uno, a), a);
+
+	__m128 t2 = _mm_mul_ps(t, t);
+	__m128 p = _mm_set1_ps(APROX_ATAN_17);
+	p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(APROX_ATAN_15));
+	p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(APROX_ATAN_13));
+	p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(APROX_ATAN_11));
+	p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(APROX_ATAN_9));
+	p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(APROX_ATAN_7));
+	p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(APROX_ATAN_5));
+	p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(APROX_ATAN_3));
+	p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(APROX_ATAN_1));
+	__m128 r = _mm_mul_ps(p, t);
+
+	r = Seleccionar(mayor, _mm_sub_ps(_mm_set1_ps(APROX_PI_2), r), r);
+	return _mm_or_ps(r, signo);
+}
+
+// Logaritmo neperiano para x > 0
+static inline __m128
+Log(__m128 x)
+{
+	__m128i xi = _mm_castps_si128(x);
+	__m128i exponente = _mm_sub_epi32(_mm_srli_epi32(xi, 23), _mm_set1_epi32(126));
+	__m128 e = _mm_cvtepi32_ps(exponente);
+
+	// Mantisa en [0.5, 1)
+	__m128 m = _mm_or_ps(
+		_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x007fffff))),
+		_mm_set1_ps(0.5f));
+
+	// Si m < sqrt(1/2) la doblamos para quedar en [sqrt(1/2), sqrt(2))
+	__m128 uno = _mm_set1_ps(1.0f);
+	__m128 menor = _mm_cmplt_ps(m, _mm_set1_ps(APROX_SQRT_1_2));
+	__m128 extra = _mm_and_ps(menor, m);
+	m = _mm_sub_ps(m, uno);
+	e = _mm_sub_ps(e, _mm_and_ps(menor, uno));
+	m = _mm_add_ps(m, extra);
+
+	__m128 z = _mm_mul_ps(m, m);
+	__m128 p = _mm_set1_ps(APROX_LOG_P0);
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(APROX_LOG_P1));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(APROX_LOG_P2));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(APROX_LOG_P3));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(APROX_LOG_P4));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(APROX_LOG_P5));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(APROX_LOG_P6));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(APROX_LOG_P7));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(APROX_LOG_P8));
+	__m128 y = _mm_mul_ps(_mm_mul_ps(p, m), z);
+
+	y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(APROX_LN2_BAJO)));
+	y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+	__m128 r = _mm_add_ps(m, y);
+	return _mm_add_ps(r, _mm_mul_ps(e, _mm_set1_ps(APROX_LN2_ALTO)));
+}
+
+static inline __m128
+Exp(__m128 x)
+{
+	x = _mm_min_ps(x, _mm_set1_ps(APROX_EXP_MAX));
+	x = _mm_max_ps(x, _mm_set1_ps(-APROX_EXP_MAX));
+
+	// n = floor(x*log2(e) + 0.5), sin SSE4.1
+	__m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(APROX_LOG2E)), _mm_set1_ps(0.5f));
+	__m128 n = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+	n = _mm_sub_ps(n, _mm_and_ps(_mm_cmpgt_ps(n, fx), _mm_set1_ps(1.0f)));
+
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(APROX_LN2_ALTO)));
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(APROX_LN2_BAJO)));
+
+	__m128 z = _mm_mul_ps(x, x);
+	__m128 p = _mm_set1_ps(APROX_EXP_P0);
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(APROX_EXP_P1));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(APROX_EXP_P2));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(APROX_EXP_P3));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(APROX_EXP_P4));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(APROX_EXP_P5));
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_add_ps(x, _mm_set1_ps(1.0f)));
+
+	// 2^n construyendo el exponente del float
+	__m128i pot = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23);
+	return _mm_mul_ps(p, _mm_castsi128_ps(pot));
+}
+
+// Recorre la fila de 4 en 4; el resto se procesa sobre una copia rellena
+// para que cada x se calcule siempre igual, este donde este.
+#define RECORRER_FILA_SSE2(CUERPO) \
+	__m128 vdy2 = _mm_set1_ps((y-b.y0)*(y-b.y0)); \
+	__m128 vx0 = _mm_set1_ps(b.x0); \
+	__m128 vxs = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); \
+	__m128 cuatro = _mm_set1_ps(4.0f); \
+	int x = 0; \
+	for ( ; x + 4 <= W ; x += 4 ) \
+	{ \
+		__m128 dx = _mm_sub_ps(vxs, vx0); \
+		__m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), vdy2); \
+		__m128 h = _mm_loadu_ps(&fila[x]); \
+		CUERPO \
+		_mm_storeu_ps(&fila[x], h); \
+		vxs = _mm_add_ps(vxs, cuatro); \
+	} \
+	if ( x < W ) \
+	{ \
+		float resto[4] = { 0.0f, 0.0f, 0.0f, 0.0f }; \
+		memcpy(resto, &fila[x], sizeof(float)*(W-x)); \
+		__m128 dx = _mm_sub_ps(vxs, vx0); \
+		__m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), vdy2); \
+		__m128 h = _mm_loadu_ps(resto); \
+		CUERPO \
+		_mm_storeu_ps(resto, h); \
+		memcpy(&fila[x], resto, sizeof(float)*(W-x)); \
+	}
+
+void
+OperadoresTerreno::ArcotangenteSSE2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	__m128 uno = _mm_set1_ps(1.0f);
+	__m128 k = _mm_set1_ps(b.param);
+	__m128 escala = _mm_set1_ps(b.mag / APROX_PI_TERRENO);
+	__m128 desplazamiento = _mm_set1_ps(APROX_PI_TERRENO/2);
+	__m128 minimo = _mm_set1_ps(APROX_DIST2_MIN);
+
+	RECORRER_FILA_SSE2(
+		d2 = _mm_max_ps(d2, minimo);
+		__m128 dist = _mm_mul_ps(d2, Rsqrt(d2));
+		__m128 at = Atan(_mm_sub_ps(uno, _mm_mul_ps(dist, k)));
+		h = _mm_add_ps(h, _mm_add_ps(_mm_mul_ps(escala, at), desplazamiento));
+	)
+}
+
+void
+OperadoresTerreno::ParaboloideSSE2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	__m128 mag = _mm_set1_ps(b.mag);
+	__m128 rad = _mm_set1_ps(b.param);
+
+	RECORRER_FILA_SSE2(
+		__m128 dist = _mm_div_ps(_mm_mul_ps(d2, d2), rad);
+		__m128 dentro = _mm_cmplt_ps(dist, mag);
+		h = _mm_add_ps(h, _mm_and_ps(dentro, _mm_sub_ps(mag, dist)));
+	)
+}
+
+void
+OperadoresTerreno::PotencialSSE2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	__m128 mag = _mm_set1_ps(b.mag);
+	__m128 menosExp = _mm_set1_ps(-b.param);
+	__m128 minimo = _mm_set1_ps(APROX_DIST2_MIN);
+
+	// mag / d2^exp = mag * exp(-exp*log(d2))
+	RECORRER_FILA_SSE2(
+		d2 = _mm_max_ps(d2, minimo);
+		__m128 inv = Exp(_mm_mul_ps(menosExp, Log(d2)));
+		h = _mm_add_ps(h, _mm_mul_ps(mag, inv));
+	)
+}
+
+#else
+
+// Sin SSE2 las versiones vectoriales son las escalares (GetNivel nunca
+// devolvera un nivel superior, pero las funciones tienen que existir)
+
+void
+OperadoresTerreno::ArcotangenteSSE2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	ArcotangenteEscalar(fila, W, y, b);
+}
+
+void
+OperadoresTerreno::ParaboloideSSE2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	ParaboloideEscalar(fila, W, y, b);
+}
+
+void
+OperadoresTerreno::PotencialSSE2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	PotencialEscalar(fila, W, y, b);
+}
+
+#endif
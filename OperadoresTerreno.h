@@ -0,0 +1,84 @@
+#pragma once
+
+// Operadores que suman un bulto a las alturas del terreno, fila a fila.
+//
+// Cada operador tiene una version escalar (la de referencia, con sqrt, atan
+// y pow de la libreria estandar) y versiones SSE2 y AVX2 que usan rsqrt con
+// un paso de Newton y aproximaciones polinomicas de atan, log y exp. La
+// version se elige al arrancar segun la CPU, y se puede limitar con SetNivel.
+//
+// Error maximo de las versiones vectoriales respecto a la escalar, para un
+// bulto (medido con genterr -verificar, que comprueba estas cotas):
+//   - Arcotangente: ERROR_ARCOTANGENTE en valor absoluto
+//   - Paraboloide:  ERROR_PARABOLOIDE en valor absoluto
+//   - Potencial:    ERROR_POTENCIAL relativo al valor del bulto
+// Al acumular N bultos el error esta acotado por N veces esas cotas, mas el
+// redondeo propio de la suma en float.
+
+enum TIPO_OPERADOR
+{
+	// [ y += mag * atan(1 - dist*k)/PI + PI/2 ]
+	OPERADOR_ARCOTANGENTE = 0,
+
+	// Paraboloide de revolucion
+	// [ y += mag - (dist^2)^2/rad ] (Siempre y cuando mag > (dist^2)^2/rad )
+	OPERADOR_PARABOLOIDE,
+
+	// Campo de potencial
+	// [ y += mag / ( (dist^2)^exp ) ]
+	OPERADOR_POTENCIAL,
+
+	NUM_OPERADORES
+};
+
+struct BultoTerreno
+{
+	float mag;
+	// k en la arcotangente, rad en el paraboloide, exp en el potencial
+	float param;
+	float x0;
+	float y0;
+};
+
+class OperadoresTerreno
+{
+public:
+	enum NIVEL
+	{
+		NIVEL_ESCALAR = 0,
+		NIVEL_SSE2,
+		NIVEL_AVX2
+	};
+
+	// Suma el bulto b a los W valores de una fila situada en la coordenada y
+	typedef void (*FuncionFila)(float *fila, int W, float y, const BultoTerreno &b);
+
+	static const float ERROR_ARCOTANGENTE;
+	static const float ERROR_PARABOLOIDE;
+	static const float ERROR_POTENCIAL;
+
+	// Mejor nivel soportado por la CPU y el sistema operativo
+	static NIVEL Detectar();
+
+	// Nivel en uso. SetNivel no permite subir por encima de Detectar().
+	static NIVEL GetNivel();
+	static void SetNivel(NIVEL nivel);
+
+	static const char *NombreNivel(NIVEL nivel);
+
+	static FuncionFila GetFuncion(TIPO_OPERADOR tipo);
+	static FuncionFila GetFuncion(TIPO_OPERADOR tipo, NIVEL nivel);
+
+	// Implementaciones de cada nivel
+	static void ArcotangenteEscalar(float *fila, int W, float y, const BultoTerreno &b);
+	static void ParaboloideEscalar(float *fila, int W, float y, const BultoTerreno &b);
+	static void PotencialEscalar(float *fila, int W, float y, const BultoTerreno &b);
+
+	static void ArcotangenteSSE2(float *fila, int W, float y, const BultoTerreno &b);
+	static void ParaboloideSSE2(float *fila, int W, float y, const BultoTerreno &b);
+	static void PotencialSSE2(float *fila, int W, float y, const BultoTerreno &b);
+
+	static void ArcotangenteAVX2(float *fila, int W, float y, const BultoTerreno &b);
+	static void ParaboloideAVX2(float *fila, int W, float y, const BultoTerreno &b);
+	static void PotencialAVX2(float *fila, int W, float y, const BultoTerreno &b);
+};
@@ -0,0 +1,220 @@
+// Version AVX2 de OperadoresTerreno. Va en su propio fichero porque con gcc
+// hay que compilarlo con -mavx2 (ver Makefile); solo se llama si Detectar()
+// ha encontrado AVX2, asi que el resto del programa no lo necesita.
+
+#include "OperadoresTerreno.h"
+
+#include "OperadoresTerrenoAprox.h"
+
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define OPERADORES_X86
+#include <immintrin.h>
+#endif
+
+#ifdef OPERADORES_X86
+
+static inline __m256
+Seleccionar(__m256 mascara, __m256 si, __m256 no)
+{
+	return _mm256_blendv_ps(no, si, mascara);
+}
+
+// 1/sqrt(x) con la estimacion de 12 bits y un paso de Newton
+static inline __m256
+Rsqrt(__m256 x)
+{
+	__m256 r = _mm256_rsqrt_ps(x);
+	__m256 xr2 = _mm256_mul_ps(_mm256_mul_ps(x, r), r);
+	return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), r), _mm256_sub_ps(_mm256_set1_ps(3.0f), xr2));
+}
+
+static inline __m256
+Atan(__m256 x)
+{
+	__m256 mascaraSigno = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+	__m256 signo = _mm256_and_ps(x, mascaraSigno);
+	__m256 a = _mm256_andnot_ps(mascaraSigno, x);
+
+	// Para |x| > 1 usamos atan(x) = PI/2 - atan(1/x)
+	__m256 uno = _mm256_set1_ps(1.0f);
+	__m256 mayor = _mm256_cmp_ps(a, uno, _CMP_GT_OQ);
+	__m256 t = Seleccionar(mayor, _mm256_div_ps(uno, a), a);
+
+	__m256 t2 = _mm256_mul_ps(t, t);
+	__m256 p = _mm256_set1_ps(APROX_ATAN_17);
+	p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(APROX_ATAN_15));
+	p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(APROX_ATAN_13));
+	p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(APROX_ATAN_11));
+	p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(APROX_ATAN_9));
+	p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(APROX_ATAN_7));
+	p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(APROX_ATAN_5));
+	p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(APROX_ATAN_3));
+	p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(APROX_ATAN_1));
+	__m256 r = _mm256_mul_ps(p, t);
+
+	r = Seleccionar(mayor, _mm256_sub_ps(_mm256_set1_ps(APROX_PI_2), r), r);
+	return _mm256_or_ps(r, signo);
+}
+
+// Logaritmo neperiano para x > 0
+static inline __m256
+Log(__m256 x)
+{
+	__m256i xi = _mm256_castps_si256(x);
+	__m256i exponente = _mm256_sub_epi32(_mm256_srli_epi32(xi, 23), _mm256_set1_epi32(126));
+	__m256 e = _mm256_cvtepi32_ps(exponente);
+
+	// Mantisa en [0.5, 1)
+	__m256 m = _mm256_or_ps(
+		_mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff))),
+		_mm256_set1_ps(0.5f));
+
+	// Si m < sqrt(1/2) la doblamos para quedar en [sqrt(1/2), sqrt(2))
+	__m256 uno = _mm256_set1_ps(1.0f);
+	__m256 menor = _mm256_cmp_ps(m, _mm256_set1_ps(APROX_SQRT_1_2), _CMP_LT_OQ);
+	__m256 extra = _mm256_and_ps(menor, m);
+	m = _mm256_sub_ps(m, uno);
+	e = _mm256_sub_ps(e, _mm256_and_ps(menor, uno));
+	m = _mm256_add_ps(m, extra);
+
+	__m256 z = _mm256_mul_ps(m, m);
+	__m256 p = _mm256_set1_ps(APROX_LOG_P0);
+	p = _mm256_add_ps(_mm256_mul_ps(p, m), _mm256_set1_ps(APROX_LOG_P1));
+	p = _mm256_add_ps(_mm256_mul_ps(p, m), _mm256_set1_ps(APROX_LOG_P2));
+	p = _mm256_add_ps(_mm256_mul_ps(p, m), _mm256_set1_ps(APROX_LOG_P3));
+	p = _mm256_add_ps(_mm256_mul_ps(p, m), _mm256_set1_ps(APROX_LOG_P4));
+	p = _mm256_add_ps(_mm256_mul_ps(p, m), _mm256_set1_ps(APROX_LOG_P5));
+	p = _mm256_add_ps(_mm256_mul_ps(p, m), _mm256_set1_ps(APROX_LOG_P6));
+	p = _mm256_add_ps(_mm256_mul_ps(p, m), _mm256_set1_ps(APROX_LOG_P7));
+	p = _mm256_add_ps(_mm256_mul_ps(p, m), _mm256_set1_ps(APROX_LOG_P8));
+	__m256 y = _mm256_mul_ps(_mm256_mul_ps(p, m), z);
+
+	y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(APROX_LN2_BAJO)));
+	y = _mm256_sub_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+	__m256 r = _mm256_add_ps(m, y);
+	return _mm256_add_ps(r, _mm256_mul_ps(e, _mm256_set1_ps(APROX_LN2_ALTO)));
+}
+
+static inline __m256
+Exp(__m256 x)
+{
+	x = _mm256_min_ps(x, _mm256_set1_ps(APROX_EXP_MAX));
+	x = _mm256_max_ps(x, _mm256_set1_ps(-APROX_EXP_MAX));
+
+	__m256 n = _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(APROX_LOG2E)), _mm256_set1_ps(0.5f)));
+
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(APROX_LN2_ALTO)));
+	x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(APROX_LN2_BAJO)));
+
+	__m256 z = _mm256_mul_ps(x, x);
+	__m256 p = _mm256_set1_ps(APROX_EXP_P0);
+	p = _mm256_add_ps(_mm256_mul_ps(p, x), _mm256_set1_ps(APROX_EXP_P1));
+	p = _mm256_add_ps(_mm256_mul_ps(p, x), _mm256_set1_ps(APROX_EXP_P2));
+	p = _mm256_add_ps(_mm256_mul_ps(p, x), _mm256_set1_ps(APROX_EXP_P3));
+	p = _mm256_add_ps(_mm256_mul_ps(p, x), _mm256_set1_ps(APROX_EXP_P4));
+	p = _mm256_add_ps(_mm256_mul_ps(p, x), _mm256_set1_ps(APROX_EXP_P5));
+	p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+	// 2^n construyendo el exponente del float
+	__m256i pot = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(127)), 23);
+	return _mm256_mul_ps(p, _mm256_castsi256_ps(pot));
+}
+
+// Recorre la fila de 8 en 8; el resto se procesa sobre una copia rellena
+// para que cada x se calcule siempre igual, este donde este.
+#define RECORRER_FILA_AVX2(CUERPO) \
+	__m256 vdy2 = _mm256_set1_ps((y-b.y0)*(y-b.y0)); \
+	__m256 vx0 = _mm256_set1_ps(b.x0); \
+	__m256 vxs = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); \
+	__m256 ocho = _mm256_set1_ps(8.0f); \
+	int x = 0; \
+	for ( ; x + 8 <= W ; x += 8 ) \
+	{ \
+		__m256 dx = _mm256_sub_ps(vxs, vx0); \
+		__m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), vdy2); \
+		__m256 h = _mm256_loadu_ps(&fila[x]); \
+		CUERPO \
+		_mm256_storeu_ps(&fila[x], h); \
+		vxs = _mm256_add_ps(vxs, ocho); \
+	} \
+	if ( x < W ) \
+	{ \
+		float resto[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }; \
+		memcpy(resto, &fila[x], sizeof(float)*(W-x)); \
+		__m256 dx = _mm256_sub_ps(vxs, vx0); \
+		__m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), vdy2); \
+		__m256 h = _mm256_loadu_ps(resto); \
+		CUERPO \
+		_mm256_storeu_ps(resto, h); \
+		memcpy(&fila[x], resto, sizeof(float)*(W-x)); \
+	} \
+	_mm256_zeroupper();
+
+void
+OperadoresTerreno::ArcotangenteAVX2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	__m256 uno = _mm256_set1_ps(1.0f);
+	__m256 k = _mm256_set1_ps(b.param);
+	__m256 escala = _mm256_set1_ps(b.mag / APROX_PI_TERRENO);
+	__m256 desplazamiento = _mm256_set1_ps(APROX_PI_TERRENO/2);
+	__m256 minimo = _mm256_set1_ps(APROX_DIST2_MIN);
+
+	RECORRER_FILA_AVX2(
+		d2 = _mm256_max_ps(d2, minimo);
+		__m256 dist = _mm256_mul_ps(d2, Rsqrt(d2));
+		__m256 at = Atan(_mm256_sub_ps(uno, _mm256_mul_ps(dist, k)));
+		h = _mm256_add_ps(h, _mm256_add_ps(_mm256_mul_ps(escala, at), desplazamiento));
+	)
+}
+
+void
+OperadoresTerreno::ParaboloideAVX2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	__m256 mag = _mm256_set1_ps(b.mag);
+	__m256 rad = _mm256_set1_ps(b.param);
+
+	RECORRER_FILA_AVX2(
+		__m256 dist = _mm256_div_ps(_mm256_mul_ps(d2, d2), rad);
+		__m256 dentro = _mm256_cmp_ps(dist, mag, _CMP_LT_OQ);
+		h = _mm256_add_ps(h, _mm256_and_ps(dentro, _mm256_sub_ps(mag, dist)));
+	)
+}
+
+void
+OperadoresTerreno::PotencialAVX2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	__m256 mag = _mm256_set1_ps(b.mag);
+	__m256 menosExp = _mm256_set1_ps(-b.param);
+	__m256 minimo = _mm256_set1_ps(APROX_DIST2_MIN);
+
+	// mag / d2^exp = mag * exp(-exp*log(d2))
+	RECORRER_FILA_AVX2(
+		d2 = _mm256_max_ps(d2, minimo);
+		__m256 inv = Exp(_mm256_mul_ps(menosExp, Log(d2)));
+		h = _mm256_add_ps(h, _mm256_mul_ps(mag, inv));
+	)
+}
+
+#else
+
+void
+OperadoresTerreno::ArcotangenteAVX2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	ArcotangenteEscalar(fila, W, y, b);
+}
+
+void
+OperadoresTerreno::ParaboloideAVX2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	ParaboloideEscalar(fila, W, y, b);
+}
+
+void
+OperadoresTerreno::PotencialAVX2(float *fila, int W, float y, const BultoTerreno &b)
+{
+	PotencialEscalar(fila, W, y, b);
+}
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+// Constantes de las aproximaciones que comparten las versiones SSE2 y AVX2
+// de OperadoresTerreno. Solo lo incluyen OperadoresTerreno*.cpp.
+
+// PI tal y como lo usaba SolNode (no es un error, se mantiene el terreno)
+static const float APROX_PI_TERRENO = 3.1416f;
+
+// atan(t) en [0,1]: t*P(t^2) (Abramowitz y Stegun 4.4.49, error < 2e-8)
+static const float APROX_ATAN_1 = 1.0f;
+static const float APROX_ATAN_3 = -0.3333314528f;
+static const float APROX_ATAN_5 = 0.1999355085f;
+static const float APROX_ATAN_7 = -0.1420889944f;
+static const float APROX_ATAN_9 = 0.1065626393f;
+static const float APROX_ATAN_11 = -0.0752896400f;
+static const float APROX_ATAN_13 = 0.0429096138f;
+static const float APROX_ATAN_15 = -0.0161657367f;
+static const float APROX_ATAN_17 = 0.0028662257f;
+static const float APROX_PI_2 = 1.57079632679f;
+
+// log(x) = e*ln2 + log(m), con m en [sqrt(1/2), sqrt(2)) (polinomio de Cephes)
+static const float APROX_SQRT_1_2 = 0.707106781186547524f;
+static const float APROX_LOG_P0 = 7.0376836292E-2f;
+static const float APROX_LOG_P1 = -1.1514610310E-1f;
+static const float APROX_LOG_P2 = 1.1676998740E-1f;
+static const float APROX_LOG_P3 = -1.2420140846E-1f;
+static const float APROX_LOG_P4 = 1.4249322787E-1f;
+static const float APROX_LOG_P5 = -1.6668057665E-1f;
+static const float APROX_LOG_P6 = 2.0000714765E-1f;
+static const float APROX_LOG_P7 = -2.4999993993E-1f;
+static const float APROX_LOG_P8 = 3.3333331174E-1f;
+
+// ln2 partido en dos para no perder precision al reducir el rango
+static const float APROX_LN2_ALTO = 0.693359375f;
+static const float APROX_LN2_BAJO = -2.12194440e-4f;
+
+// exp(x) = 2^n * exp(r), con r en [-ln2/2, ln2/2] (polinomio de Cephes)
+static const float APROX_LOG2E = 1.44269504088896341f;
+static const float APROX_EXP_MAX = 88.3762626647949f;
+static const float APROX_EXP_P0 = 1.9875691500E-4f;
+static const float APROX_EXP_P1 = 1.3981999507E-3f;
+static const float APROX_EXP_P2 = 8.3334519073E-3f;
+static const float APROX_EXP_P3 = 4.1665795894E-2f;
+static const float APROX_EXP_P4 = 1.6666665459E-1f;
+static const float APROX_EXP_P5 = 5.0000001201E-1f;
+
+// Evita rsqrt(0) y log(0); las distancias reales nunca bajan de 0.5
+static const float APROX_DIST2_MIN = 1e-20f;
@@ -19,5 +19,12 @@ public:
 
 	virtual void Activar()=0;
 	virtual void Desactivar()=0;
+	// Un paso fijo de la simulacion
 	virtual void Update()=0;
+
+	// Coloca los nodos entre el penultimo paso (alpha 0) y el ultimo
+	// (alpha 1) antes de dibujar
+	virtual void Interpolar(float alpha)
+	{
+	}
 };
@@ -1,17 +1,15 @@
 #pragma once
 
 #include "Pantalla.h"
-#include "PlanetaNode.h"
-#include "Disparo.h"
+#include "VistasPartida.h"
+#include "Aleatorio.h"
 
 #include <irrlicht.h>
-#include <list>
-using namespace std;
+using namespace irr;
 
-class SolNode;
-class Sol;
-class DisparoNode;
-class Disparo;
+class Simulacion;
+class FabricaVistasIrrlicht;
+class ControlTeclado;
 class Planeta;
 class Dios;
 class GUI;
@@ -19,22 +17,17 @@ class FondoEspacialNode;
 class Camara;
 class MegaMensaje;
 
-class Partida : public Pantalla
+// La partida en pantalla: una Simulacion con vistas de Irrlicht, los dioses
+// en el teclado, la camara y los mensajes
+class Partida : public Pantalla, public ObservadorSimulacion
 {
 private:
-	// Sol
-	Sol* sol;
-	GUI* gui;
-
-	// Planetas
-	list<Planeta *> planetas ;
+	Simulacion *simulacion;
+	FabricaVistasIrrlicht *vistas;
+	ControlTeclado *controlIzq;
+	ControlTeclado *controlDer;
 
-	//Disparos
-	list<Disparo *> disparos ;
-
-	// Dioses
-	Dios *diosIzq;
-	Dios *diosDer;
+	GUI* gui;
 
 	// Fondo espacial
 	FondoEspacialNode *fondo;
@@ -52,38 +45,28 @@ private:
 	MegaMensaje *msgGanoRojo;
 	MegaMensaje *msgGanoAzul;
 
-	bool enSecuencia;
-	int ticksSecuencia;
-	int tipoMegaImpacto;
-	Planeta *planetaMegaImpacto;
-
-
-
 protected:
-	void Inicializar();
-	void InicializarSistema();
-	void InicializarDioses();
+	void Inicializar(Aleatorio::Semilla semilla);
 	void InicializarFondo();
 	void InicializarIluminacion();
 	void InicializarGUI();
 	void InicializarCamara();
 	void InicializarMegaMensajes();
-	void ActualizarDisparos();
 	// ...
 
 public:
-	Partida();
+	Partida(Aleatorio::Semilla semilla);
 	virtual ~Partida(void);
 	virtual void Activar();
 	virtual void Desactivar();
 	virtual void Update();
+	virtual void Interpolar(float alpha);
 	
 	Dios* GetDios(int d);
-	void CrearDisparo(core::vector3df pos,float valor,int tipo,Dios *dios);
-	core::vector3df CalcularInfluencia(Sol *s,Disparo *d);
-	core::vector3df CalcularInfluencia(Planeta *p,Disparo *d);
-	bool CalcularColision(core::vector3df pos_p,core::vector3df pos_d, float radio);
-	void PreColisionPlaneta(Planeta *planeta, int tipo);
-	void MegaColisionPlaneta(Planeta *planeta, int tipo);
 
+	// ObservadorSimulacion
+	virtual void MegaImpactoAnunciado(Planeta *planeta, int tipo);
+	virtual void MegaImpactoProducido();
+	virtual void FinSecuencia();
+	virtual void FinPartida(int resultado);
 };
@@ -1,11 +1,12 @@
 #include "Planeta.h"
 
-#include "Juego.h"
-#include "PlanetaNode.h"
+#include "VistasPartida.h"
 #include "Dios.h"
-#include "Disparo.h"
 
-Planeta::Planeta(void)
+#include <math.h>
+#include <stdio.h>
+
+Planeta::Planeta(Aleatorio &aleatorio, FabricaVistas *vistas)
 {
 	diosAdorado = NULL;
 	calor = 0.5f;
@@ -15,28 +16,12 @@ Planeta::Planeta(void)
 	devocion = 0.0f ;
 	poblacion = 0.0f ;
 
-	nodo = new PlanetaNode(
-		Juego::GetInstance()->GetSceneManager()->getRootSceneNode(), 
-		Juego::GetInstance()->GetSceneManager(), 
-		0, 
-		core::vector3df::vector3d());
-
-	nodo->setRotation(core::vector3df(30.0f, 0.0f, 90.0f));
-	nodo->setScale(core::vector3df(2.0,2.0,2.0));
-	nodo->SetAlturaMar(0.5f);
-	//nodo->SetColorAtmosfera(video::SColor(0,96,96,0));
-	//nodo->SetColorAtmosfera(video::SColor(0,192,0,0));
-
-	scene::ISceneNodeAnimator* anim = 
-		Juego::GetInstance()->GetSceneManager()->createRotationAnimator(core::vector3df(0.0f, -0.2f, 0.0f));
-
-	nodo->addAnimator(anim);
-
-	anim->drop();
+	nodo = vistas ? vistas->CrearPlaneta(aleatorio) : NULL;
 }
 
 Planeta::~Planeta(void)
 {
+	delete nodo;
 }
 
 void
@@ -49,9 +34,12 @@ Planeta::ColorearAtmosfera()
 		//colorDios.g *= 0.5f+(devocion/2.0f);
 		//colorDios.b *= 0.5f+(devocion/2.0f);
 
-		nodo->SetColorAtmosfera(colorDios.toSColor());
+		if ( nodo )
+		{
+			nodo->SetColorAtmosfera(colorDios.toSColor());
+		}
 	}
-	else
+	else if ( nodo )
 	{
 		nodo->SetColorAtmosfera( video::SColor(255,0,0,0) );
 	}
@@ -90,18 +78,18 @@ Planeta::AddHerejes(float dev, Dios *dios)
 }
 
 void
-Planeta::Impacto(Disparo *d)
+Planeta::Impacto(int tipo, float energia, Dios *dios)
 {
-	switch(d->GetTipo())
+	switch(tipo)
 	{
 	case 1:
-		ImpactoCalor(d->GetEnergia()/100,d->GetDios());
+		ImpactoCalor(energia/100,dios);
 		break;
 	case 2:
-		ImpactoAgua(d->GetEnergia()/100,d->GetDios());
+		ImpactoAgua(energia/100,dios);
 		break;
 	case 3:
-		ImpactoMeteorito(d->GetEnergia()/100,d->GetDios());
+		ImpactoMeteorito(energia/100,dios);
 		break;
 	default:
 		printf("Que coo es esto!\n");
@@ -212,7 +200,10 @@ Planeta::ImpactoAgua(float cant, Dios *dios)
 	{
 		agua = 0.0f ;
 	}
-	nodo->SetAlturaMar(agua);
+	if ( nodo )
+	{
+		nodo->SetAlturaMar(agua);
+	}
 
 	// Comprobamos si ha sido para bien o para mal
 	float ndureza = fabs(agua - 0.5f);
@@ -264,14 +255,18 @@ Planeta::GetRadio()
 core::vector3df
 Planeta::GetPosicion()
 {
-	return nodo->getPosition();
+	return pos;
 }
 
 void
 Planeta::SetPosicion(irr::core::vector3df posicion)
 {
 	pos=posicion;
-	nodo->setPosition(posicion);
+	posAnterior=posicion;
+	if ( nodo )
+	{
+		nodo->SetPosicion(posicion);
+	}
 }
 
 void
@@ -284,23 +279,27 @@ Planeta::Update()
 	this->ImpactoCalor(-0.00005f, NULL);
 
 	// Mostramos los cambios en el planeta
-	nodo->SetAlturaMar(agua);
-	// TODO: Cambio de calor
-	video::SColor colorDesierto(255,255,128,0);
-	video::SColor colorHierba(255,0,255,0);
-	video::SColor colorNieve(255,128,128,255);
-
-	video::SColor colorTerreno;
-	if ( calor < 0.5f )
-	{
-		colorTerreno = colorHierba.getInterpolated(colorNieve, calor*2.0f);
-	}
-	else
+	if ( nodo )
 	{
-		colorTerreno = colorDesierto.getInterpolated(colorHierba, (calor-0.5f)*2.0f);
-	}
+		nodo->SetAlturaMar(agua);
+		nodo->Actualizar();
+		// TODO: Cambio de calor
+		video::SColor colorDesierto(255,255,128,0);
+		video::SColor colorHierba(255,0,255,0);
+		video::SColor colorNieve(255,128,128,255);
+
+		video::SColor colorTerreno;
+		if ( calor < 0.5f )
+		{
+			colorTerreno = colorHierba.getInterpolated(colorNieve, calor*2.0f);
+		}
+		else
+		{
+			colorTerreno = colorDesierto.getInterpolated(colorHierba, (calor-0.5f)*2.0f);
+		}
 
-	nodo->SetColorTerreno(colorTerreno);
+		nodo->SetColorTerreno(colorTerreno);
+	}
 
 	// Comprobamos los cambios de poblacion
 	core::vector2df dureza( calor-0.5f, agua-0.5f );
@@ -329,7 +328,16 @@ Planeta::Update()
 	
 
 	// Giramos el planeta
-	core::vector3df pos = nodo->getPosition();
+	posAnterior = pos;
 	pos.rotateXZBy(0.01f, core::vector3df());
-	nodo->setPosition(pos);
+}
+
+void
+Planeta::Interpolar(float alpha)
+{
+	if ( nodo )
+	{
+		nodo->SetPosicion(pos.getInterpolated(posAnterior, alpha));
+		nodo->Interpolar(alpha);
+	}
 }
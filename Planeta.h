@@ -4,8 +4,9 @@
 using namespace irr;
 
 class Dios;
-class PlanetaNode;
-class Disparo;
+class Aleatorio;
+class VistaPlaneta;
+class FabricaVistas;
 
 class Planeta
 {
@@ -13,11 +14,13 @@ private:
 	float poblacion; // 0..1
 	float calor; // 0..1
 	float agua; // 0..1
-	PlanetaNode *nodo;
+	// NULL sin graficos
+	VistaPlaneta *nodo;
 	Dios *diosAdorado;
 	float devocion; // 0..1
 	float masa;
 	core::vector3df pos;
+	core::vector3df posAnterior;
 
 
 protected:
@@ -32,13 +35,14 @@ public:
 	
 
 public:
-	Planeta(void);
+	// vistas puede ser NULL (simulacion sin graficos)
+	Planeta(Aleatorio &aleatorio, FabricaVistas *vistas);
 	virtual ~Planeta(void);
 
 	void DiluvioUniversal();
 	void Armaggeddon();
 	void CalentamientoGlobal();
-	void Impacto(Disparo *d);
+	void Impacto(int tipo, float energia, Dios *dios);
 	void ImpactoCalor(float cant, Dios *dios);
 	void ImpactoAgua(float cant, Dios *dios);
 	void ImpactoMeteorito(float cant, Dios *dios);
@@ -57,4 +61,5 @@ public:
 	void SetPosicion(core::vector3df);
 
 	void Update();	
+	void Interpolar(float alpha);
 };
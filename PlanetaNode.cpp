@@ -3,14 +3,32 @@
 #include "MarNode.h"
 #include "AtmosferaNode.h"
 #include "Juego.h"
-
+#include "Aleatorio.h"
+#include "CacheMallas.h"
+#include "ArchivoMapeado.h"
+#include "GeneradorTerreno.h"
+#include "GeneradorPlaneta.h"
+#include "ArenaMemoria.h"
+#include "EsferaCubo.h"
+#include "ImportadorAlturas.h"
+
+#include <stdio.h>
 #include <stdlib.h>
-#include <list>
 using namespace std;
 using namespace irr;
 
-PlanetaNode::PlanetaNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s32 id, core::vector3df pos) : 
-	scene::ISceneNode(parent, mgr, id)
+ArenaMemoria PlanetaNode::arenaGeneracion;
+
+const float PlanetaNode::ALTURA_MINIMA = 8.0f;
+const float PlanetaNode::ALTURA_MAXIMA = 12.0f;
+
+int PlanetaNode::escriturasColor = 0;
+int PlanetaNode::escriturasColorEvitadas = 0;
+
+PlanetaNode::PlanetaNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s32 id, core::vector3df pos, Aleatorio &aleatorio, const char *ficheroAlturas,
+	TIPO_MALLA tipoMalla) : 
+	scene::ISceneNode(parent, mgr, id), vertices(NULL), indices(NULL), colorTerreno(255,255,255,255), memoriaMalla(NULL),
+	archivo(NULL), cubo(NULL)
 {
 	setPosition(pos);
 
@@ -28,118 +46,98 @@ PlanetaNode::PlanetaNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s
 	material.ZWriteEnable = true;
 	material.Shininess = 0;
 
-	float PI = 3.141592f;
-	float EPSILON = 0.001f;
+	u32 inicio = Juego::GetInstance()->GetDevice()->getTimer()->getRealTime();
+	bool enCache = false;
 
-	// Generamos el mapa de alturas
-	float **alturas = new float *[NUM_MERIDIANOS];
-	for ( int i = 0 ; i < NUM_MERIDIANOS ; ++i )
+	if ( tipoMalla == MALLA_CUBO && ficheroAlturas == NULL )
 	{
-		alturas[i] = new float[NUM_PARALELOS+1];
+		// Los nodos del cubo se generan segun hacen falta: de momento solo
+		// se sortea la orografia
+		GeneradorPlaneta *orografia = new GeneradorPlaneta(NUM_PUNTOS_FIJOS);
+		orografia->Sortear(aleatorio, NUM_PUNTOS_FIJOS);
+		if ( VECINOS_OROGRAFIA > 0 )
+		{
+			orografia->SetModo(GeneradorPlaneta::IDW_VECINOS, VECINOS_OROGRAFIA);
+		}
+		cubo = new EsferaCubo(orografia);
+		box = cubo->GetBoundingBox();
 	}
-	for ( int m = 0 ; m < NUM_MERIDIANOS ; ++m )
+	else
 	{
-		for ( int p = 0 ; p < NUM_PARALELOS+1 ; ++p )
+		// Generamos la malla, o la sacamos de la cache
+		ClaveCache clave("PlanetaNode", VERSION);
+		clave.Anadir(aleatorio);
+		clave.Anadir(NUM_MERIDIANOS);
+		clave.Anadir(NUM_PARALELOS);
+		clave.Anadir(NUM_PUNTOS_FIJOS);
+		clave.Anadir(VECINOS_OROGRAFIA);
+
+		// Lo importado no pasa por la cache: depende del contenido del fichero
+		enCache = ficheroAlturas == NULL && CargarMalla(clave, aleatorio);
+		if ( !enCache )
 		{
-			alturas[m][p] = 10.0f ;
-			/*
-			if ( p == 0 || p == NUM_PARALELOS+1 )
-			{
-				alturas[m][p] = 10.0f ;
-			}
-			else
+			GenerarMalla(aleatorio, ficheroAlturas);
+			if ( ficheroAlturas == NULL )
 			{
-				alturas[m][p] = 8.0f + (rand()%400)/100.0f ;
+				GuardarMalla(clave, aleatorio);
 			}
-			*/
 		}
-	}
 
-	// Generamos los puntos fijos de la orografia
-	typedef pair<core::vector3df, float> PuntoFijo ;
-	list< PuntoFijo > puntosFijos;
-	for (int i = 0 ; i < 50 ; i++)
-	{
-		// Calculamos la altura al azar
-		float h = 10.0f+((((rand()%400)/100.0f)-2.0f)*1.0f);
-
-		// Calculamos las coordeandas cilindricas al azar
-		// TODO: Tener en cuenta que la probabilidad en los polos debe ser menor
-		float theta = (rand()%((int)(2*PI*1000)))/1000.0f ;
-		float phi = (rand()%((int)(PI*1000)))/1000.0f ;
-		//float phi = pow((rand()%1000)/1000.0f, 2.0f)*2*PI ;
-
-		// Calculamos las coordenadas cartesianas asociadas
-		float x = cos(theta)*sin(phi) ;
-		float y = cos(phi);
-		float z = sin(theta)*sin(phi) ;
-
-		// Guardamos el punto fijo
-		puntosFijos.push_back(PuntoFijo(core::vector3df(x, y, z), h));
+		// Calculamos el bounding box
+		box.reset(vertices[0].Pos);
+		for (s32 i=1; i<NUM_MERIDIANOS*(NUM_PARALELOS+1); ++i)
+		{
+			box.addInternalPoint(vertices[i].Pos);
+		}
 	}
 
-	// Generamos la orografia
-	for (int m = 0 ; m < NUM_MERIDIANOS ; m++ )
+	if ( Juego::GetInstance()->GetEnBenchmark() )
 	{
-		for (int p = 0 ; p < NUM_PARALELOS+1 ; p++ )
-		{
-			// Calculamos las coordenadas esfricas de este punto
-			float theta = 2*PI*m/NUM_MERIDIANOS ;
-			float phi = -PI/2 + PI*p/NUM_PARALELOS ;
+		printf("PlanetaNode: %u ms (%s)\n",
+			Juego::GetInstance()->GetDevice()->getTimer()->getRealTime() - inicio,
+			cubo ? "cubo" : (enCache ? "cache" : (ficheroAlturas != NULL ? "importado" : "generado")));
+	}
+}
 
-			// Calculamos las cooredanadas cartesianas de este punto
-			float x = cos(theta)*sin(phi);
-			float y = cos(phi);
-			float z = sin(theta)*sin(phi) ;
 
-			// Inicializamos su altura a 0
-			float h = 0.0f ;
+void
+PlanetaNode::GenerarMalla(Aleatorio &aleatorio, const char *ficheroAlturas)
+{
+	float PI = 3.141592f;
+	float EPSILON = 0.001f;
 
-			// Calculamos la distancia cuadrtica a cada punto fijo, 
-			// y la altura del mismo
-			list<core::vector2df> relacionPuntosFijos ;
+	// Todo lo temporal sale de la arena, que conserva su memoria de un
+	// planeta al siguiente
+	arenaGeneracion.Vaciar();
 
-			// Y guardamos la suma de distancias para normalizar
-			float suma = 0.0f ;
-			for ( list<PuntoFijo>::iterator i = puntosFijos.begin() ; i != puntosFijos.end() ; ++i )
+	// Generamos el mapa de alturas, con los paralelos de cada meridiano
+	// seguidos
+	float *alturas = arenaGeneracion.Reservar<float>(NUM_MERIDIANOS*(NUM_PARALELOS+1));
+	for ( int m = 0 ; m < NUM_MERIDIANOS ; ++m )
+	{
+		for ( int p = 0 ; p < NUM_PARALELOS+1 ; ++p )
+		{
+			alturas[m*(NUM_PARALELOS+1)+p] = 10.0f ;
+			/*
+			if ( p == 0 || p == NUM_PARALELOS+1 )
 			{
-				// Obtenemos las coordenadas del punto fijo y su altura
-				float fx = i->first.X;
-				float fy = i->first.Y;
-				float fz = i->first.Z;
-				float fh = i->second;
-
-				// Calculamos la distancia cuadrtica euclidea al punto fijo
-				float d2 = (x-fx)*(x-fx) + (y-fy)*(y-fy) + (z-fz)*(z-fz) ;
-
-				// Lo guardamos todo en la lista de relacion
-				relacionPuntosFijos.push_back(core::vector2df(1.0/d2,fh));
-
-				// Aadimos la distancia a la suma
-				suma += 1.0f/d2 ;
+				alturas[m*(NUM_PARALELOS+1)+p] = 10.0f ;
 			}
-			
-			// Normalizamos el vector con norma euclidea (lo mas normal sera utilizar
-			// norma del valor absoluto, ya que normalizando con norma euclidea ocurren
-			// cosas raras, como que la altura de un punto cercano a dos puntos fijos sea
-			// mxima en el punto equidistante a los dos puntos fijos, formando una especie
-			// de montaa redondeada... espera, eso me gusta... por eso utilizo norma
-			// euclidea)
-			//suma = sqrt(suma);
-			for ( list<core::vector2df>::iterator i = relacionPuntosFijos.begin(); i != relacionPuntosFijos.end() ; ++i )
+			else
 			{
-				//i->X = sqrt(i->X)/suma ;
-				//float f = i->X / suma ;
-				i->X /= suma;
-
-				// Y vamos aprovechando para calcular la altura
-				h += i->Y * i->X ;
+				alturas[m*(NUM_PARALELOS+1)+p] = 8.0f + (rand()%400)/100.0f ;
 			}
-
-			alturas[m][p] = h ;
+			*/
 		}
 	}
 
+	// Con un mapa equirectangular las alturas salen de el, y si no de los
+	// puntos fijos
+	if ( ficheroAlturas == NULL || !ImportarAlturas(ficheroAlturas, alturas) )
+	{
+		GenerarOrografia(aleatorio, alturas);
+	}
+
 	/*
 	// Generamos la orografa
 	for (int i = 0 ; i < 1000 ; i++ )
@@ -192,7 +190,7 @@ PlanetaNode::PlanetaNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s
 					// vertices del polo (lo se, deb de utilizar slo un vertice)
 					for ( int j = 0 ; j < NUM_MERIDIANOS ; j++ )
 					{
-						alturas[j][p] += lfz ;
+						alturas[j*(NUM_PARALELOS+1)+p] += lfz ;
 					}
 
 					// Pasamos al siguiente paralelo
@@ -202,7 +200,7 @@ PlanetaNode::PlanetaNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s
 				{
 					// No es un polo, aplicamos el cambio sobre el punto concreto
 					// y se acab.
-					alturas[m][p] += lfz ;
+					alturas[m*(NUM_PARALELOS+1)+p] += lfz ;
 				}
 			}
 		}
@@ -210,8 +208,15 @@ PlanetaNode::PlanetaNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s
 	}
 */
 
+	// Vertices e indices van juntos en el unico bloque que sobrevive a la
+	// generacion
+	int numVertices = NUM_MERIDIANOS*(NUM_PARALELOS+1);
+	int numIndices = NUM_PARALELOS*NUM_MERIDIANOS*2*3;
+	size_t bytesMalla = numVertices*sizeof(video::S3DVertex) + numIndices*sizeof(u16);
+	memoriaMalla = new char[bytesMalla];
+
 	// Generamos los vrtices
-	vertices = new video::S3DVertex[NUM_MERIDIANOS*(NUM_PARALELOS+1)];
+	vertices = (video::S3DVertex *)memoriaMalla;
 	int nv = 0;
 	int m=0,p=0;
 	for (float theta = 0.0f ; theta < 2*PI - EPSILON ; theta += (2*PI) / NUM_MERIDIANOS )
@@ -219,7 +224,7 @@ PlanetaNode::PlanetaNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s
 		p=0;
 		for (float phi = -PI/2; phi < PI/2 + EPSILON; phi += (PI) / NUM_PARALELOS )
 		{
-			float altura = alturas[m][p]/10.0f;
+			float altura = alturas[m*(NUM_PARALELOS+1)+p]/10.0f;
 			//vertices[nv] = video::S3DVertex(altura*cos(phi)*cos(theta), altura*sin(phi), altura*cos(phi)*sin(theta), cos(phi)*cos(theta), sin(phi), cos(phi)*sin(theta), video::SColor(255,(int)(255-altura*10),(int)(altura*10),0), theta , phi);
 			vertices[nv] = video::S3DVertex(altura*cos(phi)*cos(theta), altura*sin(phi), altura*cos(phi)*sin(theta), 0, 0, 0, video::SColor(255,255,255,255), theta , phi);
 			nv++;
@@ -229,7 +234,7 @@ PlanetaNode::PlanetaNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s
 	}
 
 	// Generamos los triangulos
-	indices = new u16[NUM_PARALELOS*NUM_MERIDIANOS*2*3];
+	indices = (u16 *)(memoriaMalla + numVertices*sizeof(video::S3DVertex));
 	int nTrig = 0 ;
 	for ( int p = 0 ; p < NUM_PARALELOS ; p++ )
 	{
@@ -271,17 +276,103 @@ PlanetaNode::PlanetaNode(scene::ISceneNode* parent, scene::ISceneManager* mgr, s
 	{
 		vertices[i].Normal.normalize();
 	}
+}
+
+void
+PlanetaNode::GenerarOrografia(Aleatorio &aleatorio, float *alturas)
+{
+	float PI = 3.141592f;
+
+	// Generamos los puntos fijos de la orografia
+	GeneradorPlaneta generador(NUM_PUNTOS_FIJOS, arenaGeneracion);
+	generador.Sortear(aleatorio, NUM_PUNTOS_FIJOS);
+	if ( VECINOS_OROGRAFIA > 0 )
+	{
+		generador.SetModo(GeneradorPlaneta::IDW_VECINOS, VECINOS_OROGRAFIA);
+	}
 
-	// Calculamos el bounding box
-	box.reset(vertices[0].Pos);
-	for (s32 i=1; i<NUM_MERIDIANOS*(NUM_PARALELOS+1); ++i)
+	// Generamos la orografia
+	for (int m = 0 ; m < NUM_MERIDIANOS ; m++ )
 	{
-		box.addInternalPoint(vertices[i].Pos);
+		for (int p = 0 ; p < NUM_PARALELOS+1 ; p++ )
+		{
+			// Calculamos las coordenadas esfricas de este punto
+			float theta = 2*PI*m/NUM_MERIDIANOS ;
+			float phi = -PI/2 + PI*p/NUM_PARALELOS ;
+
+			// Calculamos las cooredanadas cartesianas de este punto
+			float x = cos(theta)*sin(phi);
+			float y = cos(phi);
+			float z = sin(theta)*sin(phi) ;
+
+			alturas[m*(NUM_PARALELOS+1)+p] = generador.GetAltura(core::vector3df(x, y, z)) ;
+		}
 	}
 }
 
+bool
+PlanetaNode::ImportarAlturas(const char *fichero, float *alturas)
+{
+	// La columna NUM_MERIDIANOS es la de 360 grados, que en un mapa
+	// equirectangular coincide con la 0
+	GeneradorTerreno mapa(NUM_MERIDIANOS+1, NUM_PARALELOS+1);
+	if ( !ImportadorAlturas::Cargar(fichero, ALTURA_MINIMA, ALTURA_MAXIMA, mapa, SceneManager->getVideoDriver()) )
+	{
+		printf("PlanetaNode: no se pudo importar %s\n", fichero);
+		return false;
+	}
+
+	// La fila 0 del mapa es el polo norte y el paralelo 0 el sur
+	for ( int m = 0 ; m < NUM_MERIDIANOS ; ++m )
+	{
+		for ( int p = 0 ; p < NUM_PARALELOS+1 ; ++p )
+		{
+			alturas[m*(NUM_PARALELOS+1)+p] = mapa.GetAltura(m, NUM_PARALELOS-p);
+		}
+	}
+	return true;
+}
+
+bool
+PlanetaNode::CargarMalla(const ClaveCache &clave, Aleatorio &aleatorio)
+{
+	CacheMallas::Malla malla;
+	Aleatorio::Semilla estadoAleatorio;
+	archivo = CacheMallas::Cargar(clave, &malla, 1, estadoAleatorio);
+	if ( archivo != NULL &&
+		(malla.numVertices != NUM_MERIDIANOS*(NUM_PARALELOS+1) || malla.numIndices != NUM_PARALELOS*NUM_MERIDIANOS*2*3) )
+	{
+		delete archivo;
+		archivo = NULL;
+	}
+	if ( archivo == NULL )
+	{
+		return false;
+	}
+
+	// Mapeado de copia al escribir: SetColorTerreno no toca el fichero
+	vertices = malla.vertices;
+	indices = malla.indices;
+	aleatorio.SetEstado(estadoAleatorio);
+	return true;
+}
+
+void
+PlanetaNode::GuardarMalla(const ClaveCache &clave, const Aleatorio &aleatorio)
+{
+	CacheMallas::Malla malla;
+	malla.vertices = vertices;
+	malla.indices = indices;
+	malla.numVertices = NUM_MERIDIANOS*(NUM_PARALELOS+1);
+	malla.numIndices = NUM_PARALELOS*NUM_MERIDIANOS*2*3;
+	CacheMallas::Guardar(clave, &malla, 1, aleatorio.GetEstado());
+}
+
 PlanetaNode::~PlanetaNode(void)
 {
+	delete [] memoriaMalla;
+	delete archivo;
+	delete cubo;
 }
 
 void 
@@ -301,14 +392,36 @@ PlanetaNode::render()
 	video::IVideoDriver* driver = SceneManager->getVideoDriver();
 	driver->setMaterial(material);
 	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
-	driver->drawIndexedTriangleList(&vertices[0], NUM_MERIDIANOS*(NUM_PARALELOS+1), &indices[0], NUM_PARALELOS*NUM_MERIDIANOS*2);
+	if ( cubo )
+	{
+		cubo->Dibujar(driver, AbsoluteTransformation, SceneManager->getActiveCamera());
+		return;
+	}
+	buffer.Dibujar(driver, vertices, NUM_MERIDIANOS*(NUM_PARALELOS+1), indices, NUM_PARALELOS*NUM_MERIDIANOS*2);
 }
 
 void
 PlanetaNode::SetColorTerreno(irr::video::SColor c)
 {
-	for (s32 i=1; i<NUM_MERIDIANOS*(NUM_PARALELOS+1); ++i)
+	if ( cubo )
+	{
+		cubo->SetColor(c);
+		return;
+	}
+	// Los vertices salen blancos de GenerarMalla (y asi se guardan en la
+	// cache), y casi ningun tick cambia el color cuantizado
+	int numVertices = NUM_MERIDIANOS*(NUM_PARALELOS+1);
+	if ( c == colorTerreno )
+	{
+		escriturasColorEvitadas += numVertices;
+		return;
+	}
+
+	for (s32 i=0; i<numVertices; ++i)
 	{
 		vertices[i].Color = c;
 	}
+	colorTerreno = c;
+	escriturasColor += numVertices;
+	buffer.MarcarVertices();
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "MarNode.h"
 #include "AtmosferaNode.h"
+#include "BufferEstatico.h"
 
 
 #include <irrlicht.h>
@@ -9,6 +10,11 @@ using namespace irr;
 
 class MarNode;
 class AtmosferaNode;
+class Aleatorio;
+class ArchivoMapeado;
+class ArenaMemoria;
+class EsferaCubo;
+class ClaveCache;
 
 class PlanetaNode :
 	public irr::scene::ISceneNode
@@ -19,14 +25,66 @@ private:
 	irr::video::SMaterial material;
 	irr::u16 *indices ;
 
+	// Copia de la malla UV en la tarjeta
+	BufferEstatico buffer;
+
+	// Color que tienen ahora los vertices del terreno
+	irr::video::SColor colorTerreno;
+
+	// Escrituras de color en vertices hechas y ahorradas por no cambiar el
+	// color, desde ReiniciarContadoresColor
+	static int escriturasColor;
+	static int escriturasColorEvitadas;
+
 	static const int NUM_PARALELOS = 25;
 	static const int NUM_MERIDIANOS = 50;
+	static const int NUM_PUNTOS_FIJOS = 50;
+
+	// Puntos fijos mas cercanos que cuentan para la altura de cada vertice
+	// (GeneradorPlaneta::IDW_VECINOS), o 0 para contarlos todos
+	static const int VECINOS_OROGRAFIA = 0;
+
+	// Rango de las alturas de la orografia (y de los mapas importados)
+	static const float ALTURA_MINIMA;
+	static const float ALTURA_MAXIMA;
+
+	// Sube cada vez que cambia la malla que sale de la misma semilla
+	static const int VERSION = 1;
+
+	// Vertices e indices generados (un solo bloque), o NULL si son de la cache
+	char *memoriaMalla;
+
+	// Fichero de la cache con los vertices e indices, o NULL si se generaron
+	ArchivoMapeado *archivo;
+
+	// Malla del cubo proyectado (MALLA_CUBO), o NULL con la esfera UV
+	EsferaCubo *cubo;
+
+	// Memoria temporal de GenerarMalla, compartida por todos los planetas
+	static ArenaMemoria arenaGeneracion;
 
 	MarNode *mar ;
 	AtmosferaNode *atmosfera;
 
+	void GenerarMalla(Aleatorio &aleatorio, const char *ficheroAlturas);
+	void GenerarOrografia(Aleatorio &aleatorio, float *alturas);
+	bool ImportarAlturas(const char *fichero, float *alturas);
+	bool CargarMalla(const ClaveCache &clave, Aleatorio &aleatorio);
+	void GuardarMalla(const ClaveCache &clave, const Aleatorio &aleatorio);
+
 public:
-	PlanetaNode(irr::scene::ISceneNode* parent, irr::scene::ISceneManager* mgr, irr::s32 id, irr::core::vector3df pos);
+	enum TIPO_MALLA
+	{
+		// Esfera de NUM_MERIDIANOS x NUM_PARALELOS vertices
+		MALLA_UV = 0,
+		// Cubo proyectado a la esfera con LOD por distancia (EsferaCubo)
+		MALLA_CUBO
+	};
+
+	// Con ficheroAlturas (un mapa equirectangular: .raw, .pgm o imagen) la
+	// orografia se importa en vez de generarse, siempre en la esfera UV
+	PlanetaNode(irr::scene::ISceneNode* parent, irr::scene::ISceneManager* mgr, irr::s32 id, irr::core::vector3df pos, Aleatorio &aleatorio,
+		const char *ficheroAlturas = NULL, TIPO_MALLA tipoMalla = MALLA_UV);
 	virtual ~PlanetaNode(void);
 	virtual void OnPreRender();
 	virtual void render();
@@ -56,6 +114,36 @@ public:
 		atmosfera->SetDesColor(c);
 	}
 
+	// Un paso de la simulacion del mar y la atmosfera
+	void Actualizar()
+	{
+		mar->Actualizar();
+		atmosfera->Actualizar();
+	}
+
+	void Interpolar(float alpha)
+	{
+		mar->Interpolar(alpha);
+		atmosfera->Interpolar(alpha);
+	}
+
+	// Solo reescribe los vertices si el color cambia
 	void SetColorTerreno(video::SColor c);
+
+	static int GetEscriturasColor()
+	{
+		return escriturasColor;
+	}
+
+	static int GetEscriturasColorEvitadas()
+	{
+		return escriturasColorEvitadas;
+	}
+
+	static void ReiniciarContadoresColor()
+	{
+		escriturasColor = 0;
+		escriturasColorEvitadas = 0;
+	}
 	
 };
@@ -0,0 +1,221 @@
+#include "PoolDisparos.h"
+
+#include "VistasPartida.h"
+#include "Dios.h"
+
+#include <string.h>
+
+// Velocidad inicial y maxima en X y Z
+static const float VELOCIDAD_DISPARO = 0.15f;
+static const float VELOCIDAD_MAXIMA = 0.4f;
+
+template <class T>
+static void
+CrecerColumna(T *&columna, int num, int capacidad)
+{
+	T *nueva = new T[capacidad];
+	if ( num > 0 )
+	{
+		memcpy(nueva, columna, num*sizeof(T));
+	}
+	delete[] columna;
+	columna = nueva;
+}
+
+PoolDisparos::PoolDisparos(void)
+	: num(0), capacidad(0),
+	x(NULL), y(NULL), z(NULL), xAnterior(NULL), yAnterior(NULL), zAnterior(NULL),
+	vx(NULL), vy(NULL), vz(NULL), tipos(NULL), energias(NULL), dioses(NULL), vistas(NULL),
+	manejadores(NULL), indices(NULL), generaciones(NULL), ranurasLibres(NULL), numRanurasLibres(0)
+{
+}
+
+PoolDisparos::~PoolDisparos(void)
+{
+	Vaciar();
+
+	delete[] x;
+	delete[] y;
+	delete[] z;
+	delete[] xAnterior;
+	delete[] yAnterior;
+	delete[] zAnterior;
+	delete[] vx;
+	delete[] vy;
+	delete[] vz;
+	delete[] tipos;
+	delete[] energias;
+	delete[] dioses;
+	delete[] vistas;
+	delete[] manejadores;
+	delete[] indices;
+	delete[] generaciones;
+	delete[] ranurasLibres;
+}
+
+bool
+PoolDisparos::Crecer()
+{
+	if ( capacidad >= MAX_RANURAS )
+	{
+		return false;
+	}
+	int nuevaCapacidad = capacidad > 0 ? capacidad*2 : 64;
+	if ( nuevaCapacidad > MAX_RANURAS )
+	{
+		nuevaCapacidad = MAX_RANURAS;
+	}
+
+	CrecerColumna(x, num, nuevaCapacidad);
+	CrecerColumna(y, num, nuevaCapacidad);
+	CrecerColumna(z, num, nuevaCapacidad);
+	CrecerColumna(xAnterior, num, nuevaCapacidad);
+	CrecerColumna(yAnterior, num, nuevaCapacidad);
+	CrecerColumna(zAnterior, num, nuevaCapacidad);
+	CrecerColumna(vx, num, nuevaCapacidad);
+	CrecerColumna(vy, num, nuevaCapacidad);
+	CrecerColumna(vz, num, nuevaCapacidad);
+	CrecerColumna(tipos, num, nuevaCapacidad);
+	CrecerColumna(energias, num, nuevaCapacidad);
+	CrecerColumna(dioses, num, nuevaCapacidad);
+	CrecerColumna(vistas, num, nuevaCapacidad);
+	CrecerColumna(manejadores, num, nuevaCapacidad);
+
+	// Con el pool lleno todas las ranuras estan en uso: las nuevas quedan
+	// libres, y se usaran de la primera a la ultima
+	CrecerColumna(indices, capacidad, nuevaCapacidad);
+	CrecerColumna(generaciones, capacidad, nuevaCapacidad);
+	CrecerColumna(ranurasLibres, 0, nuevaCapacidad);
+	numRanurasLibres = 0;
+	for ( int r = nuevaCapacidad-1 ; r >= capacidad ; --r )
+	{
+		indices[r] = -1;
+		generaciones[r] = 0;
+		ranurasLibres[numRanurasLibres++] = r;
+	}
+
+	capacidad = nuevaCapacidad;
+	return true;
+}
+
+ManejadorDisparo
+PoolDisparos::Crear(core::vector3df pos, int tipo, float energia, Dios *dios, FabricaVistas *fabrica)
+{
+	if ( num == capacidad && !Crecer() )
+	{
+		return NINGUNO;
+	}
+
+	int i = num++;
+	int ranura = ranurasLibres[--numRanurasLibres];
+	indices[ranura] = i;
+	manejadores[i] = (generaciones[ranura] << BITS_RANURA) | (ManejadorDisparo)ranura;
+
+	x[i] = xAnterior[i] = pos.X;
+	y[i] = yAnterior[i] = pos.Y;
+	z[i] = zAnterior[i] = pos.Z;
+	vx[i] = 0.0f;
+	vy[i] = 0.0f;
+	vz[i] = dios->EsDiosIzquierdo() ? VELOCIDAD_DISPARO : -VELOCIDAD_DISPARO ;
+	tipos[i] = tipo;
+	energias[i] = energia;
+	dioses[i] = dios;
+
+	// El radio de la vista: la mitad de la energia, entre 5 y 50, y 100 los
+	// mega disparos
+	float radio = energia;
+	if ( radio < 10.0f )
+	{
+		radio = 10.0f ;
+	}
+
+	if ( radio < 99.9f )
+	{
+		radio *= 0.5f ;
+	}
+	else
+	{
+		radio = 100.0f;
+	}
+	vistas[i] = fabrica ? fabrica->CrearDisparo(pos, radio, tipo) : NULL;
+
+	return manejadores[i];
+}
+
+void
+PoolDisparos::Borrar(int i)
+{
+	if ( vistas[i] != NULL )
+	{
+		vistas[i]->Destruir(energias[i] >= 99.9f);
+	}
+
+	int ranura = manejadores[i] & MASCARA_RANURA;
+	indices[ranura] = -1;
+	generaciones[ranura] = (generaciones[ranura] + 1) & (0xffffffffu >> BITS_RANURA);
+	ranurasLibres[numRanurasLibres++] = ranura;
+
+	int ultimo = --num;
+	if ( i != ultimo )
+	{
+		x[i] = x[ultimo];
+		y[i] = y[ultimo];
+		z[i] = z[ultimo];
+		xAnterior[i] = xAnterior[ultimo];
+		yAnterior[i] = yAnterior[ultimo];
+		zAnterior[i] = zAnterior[ultimo];
+		vx[i] = vx[ultimo];
+		vy[i] = vy[ultimo];
+		vz[i] = vz[ultimo];
+		tipos[i] = tipos[ultimo];
+		energias[i] = energias[ultimo];
+		dioses[i] = dioses[ultimo];
+		vistas[i] = vistas[ultimo];
+		manejadores[i] = manejadores[ultimo];
+		indices[manejadores[i] & MASCARA_RANURA] = i;
+	}
+}
+
+void
+PoolDisparos::Vaciar()
+{
+	while ( num > 0 )
+	{
+		Borrar(num-1);
+	}
+}
+
+void
+PoolDisparos::Integrar(const float *ax, const float *ay, const float *az)
+{
+	for ( int i = 0 ; i < num ; ++i )
+	{
+		float nvx = vx[i] + ax[i];
+		float nvz = vz[i] + az[i];
+		nvx = nvx > VELOCIDAD_MAXIMA ? VELOCIDAD_MAXIMA : (nvx < -VELOCIDAD_MAXIMA ? -VELOCIDAD_MAXIMA : nvx);
+		nvz = nvz > VELOCIDAD_MAXIMA ? VELOCIDAD_MAXIMA : (nvz < -VELOCIDAD_MAXIMA ? -VELOCIDAD_MAXIMA : nvz);
+		vx[i] = nvx;
+		vy[i] += ay[i];
+		vz[i] = nvz;
+
+		xAnterior[i] = x[i];
+		yAnterior[i] = y[i];
+		zAnterior[i] = z[i];
+		x[i] += vx[i];
+		y[i] += vy[i];
+		z[i] += vz[i];
+	}
+}
+
+void
+PoolDisparos::Interpolar(float alpha)
+{
+	for ( int i = 0 ; i < num ; ++i )
+	{
+		if ( vistas[i] != NULL )
+		{
+			vistas[i]->SetPosicion(core::vector3df(x[i], y[i], z[i]).getInterpolated(
+				core::vector3df(xAnterior[i], yAnterior[i], zAnterior[i]), alpha));
+		}
+	}
+}
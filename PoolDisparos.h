@@ -0,0 +1,150 @@
+#pragma once
+
+#include <irrlicht.h>
+using namespace irr;
+
+class Dios;
+class VistaDisparo;
+class FabricaVistas;
+
+// Los disparos vivos de una Simulacion, guardados por columnas: cada
+// propiedad en su propio array y los GetNum() primeros elementos de todos
+// en uso, sin huecos. Los bucles de la simulacion (choques, gravedad,
+// integracion) recorren asi memoria contigua, y al borrar un disparo el
+// ultimo ocupa su sitio, asi que el orden de los disparos cambia.
+//
+// Como el indice de un disparo cambia al borrar otros, quien necesite
+// seguir a uno concreto guarda su ManejadorDisparo, que no cambia mientras
+// el disparo viva y deja de ser valido (Valido) cuando se borra.
+typedef unsigned int ManejadorDisparo;
+
+class PoolDisparos
+{
+public:
+	static const ManejadorDisparo NINGUNO = 0xffffffff;
+
+private:
+	// El manejador es la ranura en los bits bajos y una generacion que
+	// aumenta cada vez que la ranura se reutiliza en los altos
+	static const int BITS_RANURA = 20;
+	static const ManejadorDisparo MASCARA_RANURA = (1u << BITS_RANURA) - 1;
+
+	// Ranuras como mucho. La ultima (MASCARA_RANURA) no se usa, asi que
+	// ningun manejador es NINGUNO
+	static const int MAX_RANURAS = (1 << BITS_RANURA) - 1;
+
+	int num;
+	int capacidad;
+
+	// Columnas, por indice
+	float *x, *y, *z;
+	float *xAnterior, *yAnterior, *zAnterior;
+	float *vx, *vy, *vz;
+	int *tipos;
+	float *energias;
+	Dios **dioses;
+	VistaDisparo **vistas;
+	ManejadorDisparo *manejadores;
+
+	// Por ranura: el indice del disparo (-1 si esta libre) y su generacion
+	int *indices;
+	unsigned int *generaciones;
+	int *ranurasLibres;
+	int numRanurasLibres;
+
+	// false si ya tiene MAX_RANURAS
+	bool Crecer();
+
+	// No se copia
+	PoolDisparos(const PoolDisparos &);
+	PoolDisparos &operator=(const PoolDisparos &);
+
+public:
+	PoolDisparos(void);
+	virtual ~PoolDisparos(void);
+
+	// Un disparo de dios desde pos. energia es el poder que gasta; la vista
+	// (si hay fabrica) se crea con el radio que corresponde a esa energia.
+	// Con GetMaxDisparos() disparos no crea nada y devuelve NINGUNO.
+	ManejadorDisparo Crear(core::vector3df pos, int tipo, float energia, Dios *dios, FabricaVistas *fabrica);
+
+	// Borra el disparo i: su vista explota y el ultimo pasa a ser el i
+	void Borrar(int i);
+
+	// Borra todos
+	void Vaciar();
+
+	int GetNum() const
+	{
+		return num;
+	}
+
+	static int GetMaxDisparos()
+	{
+		return MAX_RANURAS;
+	}
+
+	bool Valido(ManejadorDisparo m) const
+	{
+		return m != NINGUNO && (m & MASCARA_RANURA) < (ManejadorDisparo)capacidad &&
+			indices[m & MASCARA_RANURA] >= 0 && generaciones[m & MASCARA_RANURA] == (m >> BITS_RANURA);
+	}
+
+	// Indice actual del disparo (Valido(m))
+	int GetIndice(ManejadorDisparo m) const
+	{
+		return indices[m & MASCARA_RANURA];
+	}
+
+	ManejadorDisparo GetManejador(int i) const
+	{
+		return manejadores[i];
+	}
+
+	core::vector3df GetPosicion(int i) const
+	{
+		return core::vector3df(x[i], y[i], z[i]);
+	}
+
+	core::vector3df GetVelocidad(int i) const
+	{
+		return core::vector3df(vx[i], vy[i], vz[i]);
+	}
+
+	int GetTipo(int i) const
+	{
+		return tipos[i];
+	}
+
+	float GetEnergia(int i) const
+	{
+		return energias[i];
+	}
+
+	Dios *GetDios(int i) const
+	{
+		return dioses[i];
+	}
+
+	const float *GetX() const
+	{
+		return x;
+	}
+
+	const float *GetY() const
+	{
+		return y;
+	}
+
+	const float *GetZ() const
+	{
+		return z;
+	}
+
+	// Suma a la velocidad de cada disparo su aceleracion (ax[i], ay[i],
+	// az[i]), con la velocidad en X y Z limitada, y lo mueve un paso
+	void Integrar(const float *ax, const float *ay, const float *az);
+
+	// Coloca las vistas entre el penultimo paso y el ultimo
+	void Interpolar(float alpha);
+};
@@ -0,0 +1,123 @@
+#include "PoolHilos.h"
+
+using namespace std;
+
+PoolHilos::PoolHilos(int numHilos)
+	: funcion(NULL), datos(NULL), numTareas(0), siguienteTarea(0), tareasPendientes(0), lote(0), salir(false)
+{
+	if ( numHilos <= 0 )
+	{
+		numHilos = NumNucleos();
+	}
+
+	// El hilo llamante cuenta como uno de ellos
+	for ( int i = 1 ; i < numHilos ; ++i )
+	{
+		hilos.push_back(thread(&PoolHilos::BucleHilo, this));
+	}
+}
+
+PoolHilos::~PoolHilos(void)
+{
+	{
+		lock_guard<std::mutex> lock(mutex);
+		salir = true;
+	}
+	hayTrabajo.notify_all();
+
+	for ( size_t i = 0 ; i < hilos.size() ; ++i )
+	{
+		hilos[i].join();
+	}
+}
+
+int
+PoolHilos::NumNucleos()
+{
+	int n = (int)thread::hardware_concurrency();
+	return n > 0 ? n : 1;
+}
+
+void
+PoolHilos::Ejecutar(FuncionTarea funcion, void *datos, int numTareas)
+{
+	if ( numTareas <= 0 )
+	{
+		return;
+	}
+
+	if ( hilos.empty() || numTareas == 1 )
+	{
+		for ( int i = 0 ; i < numTareas ; ++i )
+		{
+			funcion(datos, i);
+		}
+		return;
+	}
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+		this->funcion = funcion;
+		this->datos = datos;
+		this->numTareas = numTareas;
+		siguienteTarea = 0;
+		tareasPendientes = numTareas;
+		lote++;
+	}
+	hayTrabajo.notify_all();
+
+	EjecutarTareas();
+
+	// Esperamos a que los demas hilos acaben sus tareas
+	unique_lock<std::mutex> lock(mutex);
+	while ( tareasPendientes > 0 )
+	{
+		trabajoAcabado.wait(lock);
+	}
+	this->funcion = NULL;
+}
+
+void
+PoolHilos::EjecutarTareas()
+{
+	unique_lock<std::mutex> lock(mutex);
+	while ( siguienteTarea < numTareas )
+	{
+		int tarea = siguienteTarea++;
+		FuncionTarea f = funcion;
+		void *d = datos;
+
+		lock.unlock();
+		f(d, tarea);
+		lock.lock();
+
+		tareasPendientes--;
+		if ( tareasPendientes == 0 )
+		{
+			trabajoAcabado.notify_all();
+		}
+	}
+}
+
+void
+PoolHilos::BucleHilo()
+{
+	unsigned int ultimoLote = 0;
+	for (;;)
+	{
+		{
+			unique_lock<std::mutex> lock(mutex);
+			while ( !salir && lote == ultimoLote )
+			{
+				hayTrabajo.wait(lock);
+			}
+			if ( salir )
+			{
+				return;
+			}
+			ultimoLote = lote;
+		}
+
+		EjecutarTareas();
+	}
+}
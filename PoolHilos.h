@@ -0,0 +1,49 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+// Pool de hilos sencillo para repartir trabajo en tareas independientes.
+// El hilo que llama a Ejecutar tambien trabaja, asi que con un hilo todo se
+// ejecuta en el hilo llamante sin crear ninguno.
+class PoolHilos
+{
+public:
+	// Funcion de una tarea: recibe los datos comunes y el indice de tarea
+	typedef void (*FuncionTarea)(void *datos, int tarea);
+
+private:
+	std::vector<std::thread> hilos;
+	std::mutex mutex;
+	std::condition_variable hayTrabajo;
+	std::condition_variable trabajoAcabado;
+
+	FuncionTarea funcion;
+	void *datos;
+	int numTareas;
+	int siguienteTarea;
+	int tareasPendientes;
+	unsigned int lote;
+	bool salir;
+
+	void BucleHilo();
+	void EjecutarTareas();
+
+public:
+	// numHilos <= 0 utiliza todos los nucleos
+	PoolHilos(int numHilos);
+	virtual ~PoolHilos(void);
+
+	int GetNumHilos() const
+	{
+		return (int)hilos.size() + 1;
+	}
+
+	// Ejecuta funcion(datos, i) para cada i en [0, numTareas) y espera a
+	// que acaben todas. El orden de ejecucion de las tareas no esta definido.
+	void Ejecutar(FuncionTarea funcion, void *datos, int numTareas);
+
+	static int NumNucleos();
+};
@@ -0,0 +1,104 @@
+#include "PoolNodosDisparo.h"
+
+#include "DisparoNode.h"
+
+using namespace irr;
+
+bool PoolNodosDisparo::activo = true;
+int PoolNodosDisparo::aciertos = 0;
+int PoolNodosDisparo::fallos = 0;
+
+PoolNodosDisparo::PoolNodosDisparo(scene::ISceneManager *mgr) : mgr(mgr)
+{
+	if ( !activo )
+	{
+		return;
+	}
+
+	for ( int t = 0 ; t < NUM_TIPOS ; t++ )
+	{
+		for ( int i = 0 ; i < NODOS_INICIALES ; i++ )
+		{
+			libres[t].push_back(CrearNodo(t+1));
+		}
+	}
+}
+
+PoolNodosDisparo::~PoolNodosDisparo(void)
+{
+	// Tambien los que estan en uso o explotando: las vistas de los disparos
+	// ya no existen
+	for ( u32 i = 0 ; i < nodos.size() ; i++ )
+	{
+		nodos[i]->remove();
+		nodos[i]->drop();
+	}
+}
+
+DisparoNode *
+PoolNodosDisparo::CrearNodo(int tipo)
+{
+	DisparoNode *nodo = new DisparoNode(mgr->getRootSceneNode(), mgr, -1, tipo, this);
+	nodos.push_back(nodo);
+	return nodo;
+}
+
+DisparoNode *
+PoolNodosDisparo::Obtener(int tipo, float radio, core::vector3df pos)
+{
+	BorrarAcabados();
+
+	core::array<DisparoNode *> &l = libres[tipo-1];
+	DisparoNode *nodo;
+	if ( l.size() > 0 )
+	{
+		aciertos++;
+		nodo = l[l.size()-1];
+		l.erase(l.size()-1);
+	}
+	else
+	{
+		fallos++;
+		nodo = CrearNodo(tipo);
+	}
+
+	nodo->Reiniciar(radio, pos);
+	return nodo;
+}
+
+void
+PoolNodosDisparo::Devolver(DisparoNode *nodo)
+{
+	if ( activo )
+	{
+		libres[nodo->GetTipo()-1].push_back(nodo);
+	}
+	else
+	{
+		porBorrar.push_back(nodo);
+	}
+}
+
+int
+PoolNodosDisparo::GetNumLibres() const
+{
+	int n = porBorrar.size();
+	for ( int t = 0 ; t < NUM_TIPOS ; t++ )
+	{
+		n += libres[t].size();
+	}
+	return n;
+}
+
+void
+PoolNodosDisparo::BorrarAcabados()
+{
+	for ( u32 i = 0 ; i < porBorrar.size() ; i++ )
+	{
+		s32 j = nodos.linear_search(porBorrar[i]);
+		nodos.erase(j);
+		porBorrar[i]->remove();
+		porBorrar[i]->drop();
+	}
+	porBorrar.clear();
+}
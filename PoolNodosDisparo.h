@@ -0,0 +1,95 @@
+#pragma once
+
+#include <irrlicht.h>
+using namespace irr;
+
+class DisparoNode;
+
+// Nodos de disparo ya creados, separados por tipo (1 calor, 2 agua, 3
+// meteorito). Crear un DisparoNode anade a la escena una luz o una esfera,
+// un billboard y un sistema de particulas con su emisor y busca sus
+// texturas; con fuego rapido eso se notaba. Aqui se crean unos cuantos de
+// cada tipo al empezar, Obtener devuelve uno libre con el radio y la
+// posicion del disparo y, cuando acaba su explosion, el nodo se esconde y
+// vuelve solo a la lista de libres. Si no hay libre se crea otro, que
+// tambien se queda en el pool.
+class PoolNodosDisparo
+{
+public:
+	static const int NUM_TIPOS = 3;
+
+	// Nodos que se crean de cada tipo al construir el pool
+	static const int NODOS_INICIALES = 16;
+
+private:
+	scene::ISceneManager *mgr;
+
+	// Todos los nodos del pool (el pool tiene una referencia de cada uno) y
+	// los que estan libres de cada tipo
+	core::array<DisparoNode *> nodos;
+	core::array<DisparoNode *> libres[NUM_TIPOS];
+
+	// Sin pool los nodos que acaban se quitan de la escena en el siguiente
+	// Obtener, fuera del recorrido de la escena
+	core::array<DisparoNode *> porBorrar;
+
+	static bool activo;
+	static int aciertos;
+	static int fallos;
+
+	DisparoNode *CrearNodo(int tipo);
+	void BorrarAcabados();
+
+	// No se copia
+	PoolNodosDisparo(const PoolNodosDisparo &);
+	PoolNodosDisparo &operator=(const PoolNodosDisparo &);
+
+public:
+	PoolNodosDisparo(scene::ISceneManager *mgr);
+	virtual ~PoolNodosDisparo(void);
+
+	// Un nodo visible del tipo con ese radio en pos. Es del pool: se suelta
+	// con DisparoNode::Destruir, nunca con drop().
+	DisparoNode *Obtener(int tipo, float radio, core::vector3df pos);
+
+	// Lo llama el nodo al acabar su explosion
+	void Devolver(DisparoNode *nodo);
+
+	int GetNumNodos() const
+	{
+		return nodos.size();
+	}
+
+	// Nodos que no estan en uso ni explotando
+	int GetNumLibres() const;
+
+	// Con false cada disparo crea su nodo y lo quita de la escena al acabar,
+	// como antes del pool, para comparar
+	static void SetActivo(bool a)
+	{
+		activo = a;
+	}
+
+	static bool GetActivo()
+	{
+		return activo;
+	}
+
+	// Obtener que encontraron un nodo libre y que tuvieron que crearlo desde
+	// ReiniciarContadores
+	static int GetAciertos()
+	{
+		return aciertos;
+	}
+
+	static int GetFallos()
+	{
+		return fallos;
+	}
+
+	static void ReiniciarContadores()
+	{
+		aciertos = 0;
+		fallos = 0;
+	}
+};
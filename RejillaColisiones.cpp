@@ -0,0 +1,74 @@
+#include "RejillaColisiones.h"
+
+#include <math.h>
+using namespace irr;
+
+RejillaColisiones::RejillaColisiones(float lado)
+	: lado(lado), mascara(0), x(NULL), y(NULL), z(NULL), numPuntos(0)
+{
+}
+
+void
+RejillaColisiones::Construir(const float *x, const float *y, const float *z, int n)
+{
+	this->x = x;
+	this->y = y;
+	this->z = z;
+	numPuntos = n;
+
+	unsigned int entradas = 16;
+	while ( entradas < 2u*(unsigned int)n )
+	{
+		entradas <<= 1;
+	}
+	mascara = entradas - 1;
+
+	cabezas.assign(entradas, -1);
+	if ( (int)siguiente.size() < n )
+	{
+		siguiente.resize(n);
+	}
+
+	// Al insertar de atras adelante cada lista queda en orden de indice
+	for ( int i = n-1 ; i >= 0 ; --i )
+	{
+		unsigned int e = Entrada(Celda(x[i]), Celda(z[i]));
+		siguiente[i] = cabezas[e];
+		cabezas[e] = i;
+	}
+}
+
+int
+RejillaColisiones::PrimerChoque(int i, const std::vector<bool> &borrados) const
+{
+	core::vector3df p(x[i], y[i], z[i]);
+	int cx = Celda(p.X);
+	int cz = Celda(p.Z);
+
+	int primero = -1;
+	for ( int dz = -1 ; dz <= 1 ; ++dz )
+	{
+		for ( int dx = -1 ; dx <= 1 ; ++dx )
+		{
+			for ( int j = cabezas[Entrada(cx+dx, cz+dz)] ; j >= 0 ; j = siguiente[j] )
+			{
+				if ( primero >= 0 && j >= primero )
+				{
+					// La lista va en orden: los que quedan no son primeros
+					break;
+				}
+				if ( j == i || borrados[j] )
+				{
+					continue;
+				}
+				// La misma prueba que Simulacion::CalcularColision
+				if ( (f64)core::vector3df(x[j], y[j], z[j]).getDistanceFrom(p) < lado )
+				{
+					primero = j;
+					break;
+				}
+			}
+		}
+	}
+	return primero;
+}
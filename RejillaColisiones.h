@@ -0,0 +1,48 @@
+#pragma once
+
+#include <irrlicht.h>
+#include <vector>
+
+// Rejilla uniforme en el plano XZ para buscar choques entre muchos puntos
+// sin probar todos contra todos. Las celdas miden lo mismo que la distancia
+// de choque, asi que cada punto solo puede chocar con los de su celda y las
+// ocho vecinas. Las celdas no se guardan: se dispersan en una tabla del
+// doble de entradas que puntos, y las que caen en la misma entrada solo
+// anaden candidatos que luego no pasan la prueba de distancia.
+//
+// Los vectores se conservan entre un Construir y el siguiente, asi que en
+// cada paso solo se reserva memoria si hay mas puntos que nunca.
+class RejillaColisiones
+{
+private:
+	float lado;
+	unsigned int mascara;
+	std::vector<int> cabezas;
+	std::vector<int> siguiente;
+	const float *x;
+	const float *y;
+	const float *z;
+	int numPuntos;
+
+	unsigned int Entrada(int cx, int cz) const
+	{
+		return ((unsigned int)cx * 73856093u ^ (unsigned int)cz * 19349663u) & mascara;
+	}
+
+	int Celda(float v) const
+	{
+		return (int)floorf(v / lado);
+	}
+
+public:
+	// lado: distancia de choque
+	RejillaColisiones(float lado);
+
+	// Reparte los n puntos, dados por columnas (no se copian: tienen que
+	// seguir ahi mientras se busca)
+	void Construir(const float *x, const float *y, const float *z, int n);
+
+	// El primer punto en orden de indice, distinto de i y no borrado, a
+	// menos de lado de i; -1 si no hay ninguno
+	int PrimerChoque(int i, const std::vector<bool> &borrados) const;
+};
@@ -0,0 +1,444 @@
+#include "Simulacion.h"
+
+#include "Planeta.h"
+#include "Dios.h"
+#include "Sol.h"
+#include "VistasPartida.h"
+
+#include <stdlib.h>
+using namespace irr;
+
+const float Simulacion::DISTANCIA_CHOQUE_DISPAROS = 2.0f;
+
+Simulacion::Simulacion(Aleatorio::Semilla semilla, ControlDios *controlIzq, ControlDios *controlDer,
+	FabricaVistas *vistas, ObservadorSimulacion *observador) :
+	vistas(vistas), observador(observador), semilla(semilla), ticks(0), resultado(EN_JUEGO), ticksResultado(0),
+	disparosCreados(0), megaImpactos(0), rejillaActiva(true), rejilla(DISTANCIA_CHOQUE_DISPAROS)
+{
+	enSecuencia = false ;
+	ticksSecuencia = 0 ;
+	tipoMegaImpacto = 0 ;
+	planetaMegaImpacto = NULL ;
+
+	InicializarSistema();
+
+	diosIzq = new Dios(this, -35, true, controlIzq, vistas);
+	diosDer = new Dios(this, 35, false, controlDer, vistas);
+
+	bool iz = true ;
+	for ( list<Planeta *>::iterator i = planetas.begin() ; i != planetas.end() ; ++i )
+	{
+		(*i)->ImpactoAgua(0.01f, iz?diosIzq:diosDer);
+		iz = !iz ;
+	}
+}
+
+Simulacion::~Simulacion(void)
+{
+	disparos.Vaciar();
+	for ( list<Planeta *>::iterator p = planetas.begin() ; p != planetas.end() ; ++p )
+	{
+		delete (*p);
+	}
+	delete diosIzq;
+	delete diosDer;
+	delete sol;
+}
+
+void
+Simulacion::InicializarSistema()
+{
+	Aleatorio aleatorio(semilla, FLUJO_SISTEMA);
+
+	// Creamos el sol
+	Aleatorio aleatorioSol(semilla, FLUJO_SOL);
+	sol = new Sol(core::vector3df(), aleatorioSol, vistas);
+
+	// Creamos los planetas
+	for ( int i = 0 ; i < NUM_PLANETAS ; i++ )
+	{
+		float x, z, cerca;
+		do
+		{
+			x = (float)((aleatorio.Entero(2000)/1000.0f)-1.0)*20.0f;
+			z = (float)((aleatorio.Entero(2000)/1000.0f)-1.0)*20.0f;
+
+			// Comprobamos que no esta muy cerca de algun planeta existente
+			cerca = false ;
+			for ( list<Planeta *>::iterator i = planetas.begin() ; i != planetas.end() ; ++i )
+			{
+				float px = (*i)->GetPosicion().X;
+				float pz = (*i)->GetPosicion().Z;
+
+				float d2 = (x-px)*(x-px) + (z-pz)*(z-pz) ;
+				if ( d2 < 150 )
+				{
+					cerca = true;
+					break;
+				}
+			}
+			if ( x*x + z*z < 150 )
+			{
+				// Esta cerca del sol
+				cerca = true ;
+			}
+		}while (cerca);
+
+		Aleatorio aleatorioPlaneta(semilla, FLUJO_PLANETAS + i);
+		Planeta *planeta = new Planeta(aleatorioPlaneta, vistas);
+		planeta->SetPosicion(core::vector3df(x,0,z));
+
+		planetas.push_back(planeta);
+	}
+}
+
+ManejadorDisparo
+Simulacion::CrearDisparo(core::vector3df pos,float valor,int tipo,Dios *dios)
+{
+	ManejadorDisparo m = disparos.Crear(pos,tipo,valor,dios,vistas);
+	if ( m != PoolDisparos::NINGUNO )
+	{
+		disparosCreados++;
+	}
+	return m;
+}
+
+void
+Simulacion::Paso()
+{
+	// Planetas
+	for ( list<Planeta *>::iterator p = planetas.begin() ; p != planetas.end() ; ++p )
+	{
+		(*p)->Update();
+	}
+
+	// Dioses
+	diosIzq->Update();
+	diosDer->Update();
+
+	// Disparos
+	ActualizarDisparos();
+
+	if ( enSecuencia )
+	{
+		// Comprobamos la desactivacion de la secuncia
+		ticksSecuencia--;
+		if ( ticksSecuencia < 1 )
+		{
+			enSecuencia = false ;
+			if ( observador )
+			{
+				observador->FinSecuencia();
+			}
+		}
+	}
+
+	ComprobarFinal();
+	ticks++;
+}
+
+void
+Simulacion::ComprobarFinal()
+{
+	// Comprobamos si ha acabado la partida
+	bool izqMuerto=true;
+	bool derMuerto=true;
+	for ( list<Planeta *>::iterator i = planetas.begin() ; i != planetas.end() ; ++i )
+	{
+		if ( (*i)->GetDiosAdorado() == diosIzq )
+		{
+			izqMuerto = false ;
+		}
+		else if ( (*i)->GetDiosAdorado() == diosDer )
+		{
+			derMuerto = false ;
+		}
+	}
+
+	RESULTADO r = EN_JUEGO;
+	if ( izqMuerto & derMuerto )
+	{
+		r = EMPATE;
+	}
+	else if ( izqMuerto )
+	{
+		r = GANA_DERECHO;
+	}
+	else if ( derMuerto )
+	{
+		r = GANA_IZQUIERDO;
+	}
+
+	if ( r != EN_JUEGO )
+	{
+		enSecuencia = true ;
+		ticksSecuencia = 10000000 ;
+
+		if ( r != resultado )
+		{
+			resultado = r;
+			ticksResultado = ticks;
+			if ( observador )
+			{
+				observador->FinPartida(r);
+			}
+		}
+	}
+}
+
+void
+Simulacion::Interpolar(float alpha)
+{
+	for ( list<Planeta *>::iterator p = planetas.begin() ; p != planetas.end() ; ++p )
+	{
+		(*p)->Interpolar(alpha);
+	}
+	disparos.Interpolar(alpha);
+	diosIzq->Interpolar(alpha);
+	diosDer->Interpolar(alpha);
+}
+
+void
+Simulacion::ActualizarDisparos()
+{
+
+	//Primero compruebo si chocan entre ellos
+	if ( rejillaActiva )
+	{
+		ChocarDisparosRejilla();
+	}
+	else
+	{
+		ChocarDisparosTodos();
+	}
+
+	// Luego los que se salen, caen en el sol o dan en un planeta. Al borrar
+	// uno el ultimo pasa a su sitio y se mira sin avanzar.
+	for ( int i = 0 ; i < disparos.GetNum() ; )
+	{
+		core::vector3df pos = disparos.GetPosicion(i);
+
+		//Primero compruebo si se salio de la pantalla
+		if ( pos.getLength() > 100 )
+		{
+			disparos.Borrar(i);
+			continue;
+		}
+
+		if(CalcularColision(pos,core::vector3df(0,0,0),3.2f))
+		{
+			disparos.Borrar(i);
+			continue;
+		}
+
+		bool choca=false;
+		for ( list<Planeta *>::iterator p = planetas.begin() ; p != planetas.end() ; ++p )
+		{
+			if(CalcularColision(pos,(*p)->GetPosicion(),(*p)->GetRadio()))
+			{
+				bool retrasarImpacto = false ;
+				if ( disparos.GetEnergia(i) > 99.9f )
+				{
+					// Es un mega disparo
+					if ( !enSecuencia )
+					{
+						// Y no estamos mostrando otro mega disparo
+						PreColisionPlaneta(*p, disparos.GetTipo(i) );
+						retrasarImpacto = true ;
+						tipoMegaImpacto = disparos.GetTipo(i) ;
+						planetaMegaImpacto = (*p) ;
+						megaImpactos++;
+					}
+				}
+
+				if (!retrasarImpacto)
+				{
+					(*p)->Impacto(disparos.GetTipo(i), disparos.GetEnergia(i), disparos.GetDios(i));
+				}
+
+				choca=true;
+
+				break;
+			}
+		}
+		if(choca)
+		{
+			disparos.Borrar(i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	// Los que quedan se aceleran hacia el sol y los planetas y avanzan
+	int n = disparos.GetNum();
+	if ( (int)aceleraciones.size() < 3*n )
+	{
+		aceleraciones.resize(3*n);
+	}
+	float *ax = n > 0 ? &aceleraciones[0] : NULL;
+	float *ay = ax + n;
+	float *az = ay + n;
+	gravedad.Vaciar();
+	gravedad.AnadirAtractor(core::vector3df(0,0,0), sol->GetMasa());
+	for ( list<Planeta *>::iterator p = planetas.begin() ; p != planetas.end() ; ++p )
+	{
+		gravedad.AnadirAtractor((*p)->GetPosicion(), (*p)->GetMasa());
+	}
+	gravedad.Calcular(disparos.GetX(), disparos.GetY(), disparos.GetZ(), n, ax, ay, az);
+	disparos.Integrar(ax, ay, az);
+
+	if ( enSecuencia )
+	{
+		// Comprobamos la desactivacion de la secuncia
+		ticksSecuencia--;
+		if ( ticksSecuencia < 1 )
+		{
+			enSecuencia = false ;
+			if ( observador )
+			{
+				observador->FinSecuencia();
+			}
+		}
+		else if ( ticksSecuencia < 500 )
+		{
+			if ( observador )
+			{
+				observador->MegaImpactoProducido();
+			}
+			this->MegaColisionPlaneta(planetaMegaImpacto, tipoMegaImpacto);
+		}
+	}
+}
+
+// Cada disparo se prueba contra todos los demas en orden y choca con el
+// primero que encuentra a menos de 2 que no haya chocado ya; los dos
+// desaparecen
+void
+Simulacion::ChocarDisparosTodos()
+{
+	int n = disparos.GetNum();
+	disparosBorrados.assign(n, false);
+	bool alguno = false;
+	for ( int i = 0 ; i < n ; ++i )
+	{
+		if ( disparosBorrados[i] )
+			continue;
+
+		for ( int j = 0 ; j < n ; ++j )
+		{
+			if ( disparosBorrados[j] || i == j )
+				continue;
+			if(CalcularColision(disparos.GetPosicion(i),disparos.GetPosicion(j),DISTANCIA_CHOQUE_DISPAROS))
+			{
+				disparosBorrados[i] = true;
+				disparosBorrados[j] = true;
+				alguno = true;
+				break;
+			}
+		}
+	}
+	if ( alguno )
+	{
+		BorrarChocados();
+	}
+}
+
+// Lo mismo que ChocarDisparosTodos, buscando solo entre los vecinos de la
+// rejilla, asi que desaparecen exactamente los mismos
+void
+Simulacion::ChocarDisparosRejilla()
+{
+	int n = disparos.GetNum();
+	if ( n < 2 )
+	{
+		return;
+	}
+
+	disparosBorrados.assign(n, false);
+	rejilla.Construir(disparos.GetX(), disparos.GetY(), disparos.GetZ(), n);
+	bool alguno = false;
+	for ( int i = 0 ; i < n ; ++i )
+	{
+		if ( disparosBorrados[i] )
+		{
+			continue;
+		}
+		int j = rejilla.PrimerChoque(i, disparosBorrados);
+		if ( j >= 0 )
+		{
+			disparosBorrados[i] = true;
+			disparosBorrados[j] = true;
+			alguno = true;
+		}
+	}
+	if ( alguno )
+	{
+		BorrarChocados();
+	}
+}
+
+void
+Simulacion::BorrarChocados()
+{
+	// De atras adelante, para que el ultimo que pasa al hueco ya este visto
+	for ( int i = disparos.GetNum()-1 ; i >= 0 ; --i )
+	{
+		if ( disparosBorrados[i] )
+		{
+			disparos.Borrar(i);
+		}
+	}
+}
+
+bool
+Simulacion::CalcularColision(core::vector3df a,core::vector3df b, float min_dist)
+{
+	f64 d=b.getDistanceFrom(a);
+
+	if(d<min_dist)
+		return true;
+	return false;
+}
+
+void
+Simulacion::PreColisionPlaneta(Planeta *planeta, int tipo)
+{
+	if ( !enSecuencia )
+	{
+		enSecuencia = true ;
+		ticksSecuencia = 1000 ;
+
+		if ( observador )
+		{
+			observador->MegaImpactoAnunciado(planeta, tipo);
+		}
+	}
+}
+
+Dios*
+Simulacion::GetDios(int d)
+{
+	if(d==1)
+		return diosIzq;
+	else
+		return diosDer;
+}
+
+void
+Simulacion::MegaColisionPlaneta(Planeta *planeta, int tipo)
+{
+	switch (tipo)
+	{
+	case 1:
+		planeta->CalentamientoGlobal();
+		break;
+	case 2:
+		planeta->DiluvioUniversal();
+		break;
+	case 3:
+		planeta->Armaggeddon();
+		break;
+	}
+}
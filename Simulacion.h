@@ -0,0 +1,186 @@
+#pragma once
+
+#include "Aleatorio.h"
+#include "RejillaColisiones.h"
+#include "PoolDisparos.h"
+#include "Gravedad.h"
+
+#include <irrlicht.h>
+#include <list>
+#include <vector>
+using namespace std;
+using namespace irr;
+
+class Sol;
+class Planeta;
+class Dios;
+class ControlDios;
+class FabricaVistas;
+class ObservadorSimulacion;
+
+// Las reglas de una partida: el sol, los planetas, los dioses y sus
+// disparos, avanzando a pasos fijos. No sabe nada de la ventana: Partida le
+// pasa una FabricaVistas y se entera de lo que pasa como
+// ObservadorSimulacion, y sin ellas la simulacion corre sin graficos (ver
+// Simulador.cpp).
+class Simulacion
+{
+public:
+	enum RESULTADO
+	{
+		EN_JUEGO = 0,
+		EMPATE,
+		GANA_IZQUIERDO,
+		GANA_DERECHO,
+
+		NUM_RESULTADOS
+	};
+
+	static const int NUM_PLANETAS = 3;
+
+	// Dos disparos a menos de esta distancia se destruyen
+	static const float DISTANCIA_CHOQUE_DISPAROS;
+
+private:
+	// Sol
+	Sol* sol;
+
+	// Planetas
+	list<Planeta *> planetas ;
+
+	//Disparos
+	PoolDisparos disparos ;
+
+	// Dioses
+	Dios *diosIzq;
+	Dios *diosDer;
+
+	FabricaVistas *vistas;
+	ObservadorSimulacion *observador;
+
+	// Cada generador usa su propio flujo de la semilla de la partida, asi que
+	// el sistema no cambia aunque cambie lo que consume otro generador
+	enum FLUJO
+	{
+		FLUJO_SISTEMA = 0,
+		FLUJO_SOL,
+		FLUJO_PLANETAS
+	};
+	Aleatorio::Semilla semilla;
+
+	bool enSecuencia;
+	int ticksSecuencia;
+	int tipoMegaImpacto;
+	Planeta *planetaMegaImpacto;
+
+	unsigned int ticks;
+	RESULTADO resultado;
+	unsigned int ticksResultado;
+
+	// Estadisticas de la partida
+	int disparosCreados;
+	int megaImpactos;
+
+	// Choques entre disparos
+	bool rejillaActiva;
+	RejillaColisiones rejilla;
+	vector<bool> disparosBorrados;
+
+	// Gravedad del sol y los planetas sobre los disparos, y la aceleracion
+	// de cada disparo en cada paso (X, Y y Z seguidas)
+	Gravedad gravedad;
+	vector<float> aceleraciones;
+
+	void InicializarSistema();
+	void ActualizarDisparos();
+	void ChocarDisparosTodos();
+	void ChocarDisparosRejilla();
+	void BorrarChocados();
+	void ComprobarFinal();
+
+	// No se copia
+	Simulacion(const Simulacion &);
+	Simulacion &operator=(const Simulacion &);
+
+public:
+	// controlIzq y controlDer manejan a los dioses y no son de la
+	// simulacion. vistas y observador pueden ser NULL.
+	Simulacion(Aleatorio::Semilla semilla, ControlDios *controlIzq, ControlDios *controlDer,
+		FabricaVistas *vistas = NULL, ObservadorSimulacion *observador = NULL);
+	virtual ~Simulacion(void);
+
+	// Un paso fijo
+	void Paso();
+
+	// Con la rejilla (por defecto) los choques entre disparos cuestan
+	// O(n) por paso en lugar de O(n^2); el resultado es el mismo. Sin ella
+	// se prueban todos contra todos, para comparar.
+	void SetRejillaActiva(bool activa)
+	{
+		rejillaActiva = activa;
+	}
+
+	bool GetRejillaActiva() const
+	{
+		return rejillaActiva;
+	}
+
+	// Coloca las vistas entre el penultimo paso y el ultimo
+	void Interpolar(float alpha);
+
+	Dios* GetDios(int d);
+	list<Planeta *> &GetPlanetas()
+	{
+		return planetas;
+	}
+
+	int GetNumDisparos() const
+	{
+		return disparos.GetNum();
+	}
+
+	const PoolDisparos &GetDisparos() const
+	{
+		return disparos;
+	}
+
+	ManejadorDisparo CrearDisparo(core::vector3df pos,float valor,int tipo,Dios *dios);
+	bool CalcularColision(core::vector3df pos_p,core::vector3df pos_d, float radio);
+	void PreColisionPlaneta(Planeta *planeta, int tipo);
+	void MegaColisionPlaneta(Planeta *planeta, int tipo);
+
+	bool GetEnSecuencia() const
+	{
+		return enSecuencia;
+	}
+
+	// Pasos dados
+	unsigned int GetTicks() const
+	{
+		return ticks;
+	}
+
+	// El primer resultado que se dio (EN_JUEGO mientras ningun dios se
+	// quede sin planetas) y el paso en el que se dio
+	RESULTADO GetResultado() const
+	{
+		return resultado;
+	}
+
+	unsigned int GetTicksResultado() const
+	{
+		return ticksResultado;
+	}
+
+	// Disparos de los dos dioses desde el principio
+	int GetDisparosCreados() const
+	{
+		return disparosCreados;
+	}
+
+	// Mega disparos que han dado en un planeta y han empezado su secuencia
+	int GetMegaImpactos() const
+	{
+		return megaImpactos;
+	}
+};
@@ -0,0 +1,751 @@
+// Partidas simuladas sin ventana ni nodos de escena, tan deprisa como da la
+// CPU.
+//
+// Uso: simulador [-semilla N] [-partidas N] [-ticks N] [-hilos N]
+//                 [-csv FICHERO] [-resumen FICHERO]
+//        simulador -rafaga N [-ticks N]
+//        simulador -verificar
+//        simulador -barneshut N [-theta T]
+//
+// Juega "partidas" partidas entre dos ControlIA, la partida m con la
+// semilla N+m (el mismo sistema que Partida con esa semilla), hasta que un
+// dios se queda sin planetas o pasan N pasos de simulacion (por defecto
+// diez minutos de juego a Juego::HZ_SIMULACION). Cada partida es
+// independiente, asi que con -hilos se reparten entre los nucleos
+// (0 = todos) y el resultado es el mismo que con un hilo.
+// -csv escribe una fila por partida: semilla, resultado, pasos jugados,
+// paso en que se decidio, disparos y mega impactos.
+// Al acabar muestra cuantas gano cada dios, la duracion media, los mega
+// impactos por partida y los pasos por segundo. -resumen escribe esos
+// totales en un CSV de una fila.
+// -rafaga lanza N disparos repartidos al azar por el sistema y da N pasos
+// (10 por defecto) con la rejilla de choques entre disparos y probando
+// todos contra todos; comprueba que quedan los mismos disparos en cada paso
+// y muestra lo que tarda cada paso con los dos metodos.
+// -verificar comprueba que la gravedad (Gravedad) sigue la ley del inverso
+// del cuadrado, que la version SSE2 esta dentro de su cota de error
+// respecto a la escalar, y compara lo que tardan las dos. Comprueba tambien
+// que el arbol de Barnes-Hut con theta 0 da la suma directa y que con
+// Gravedad::THETA no se aleja mas de Gravedad::ERROR_ARBOL, y los
+// manejadores de PoolDisparos.
+// -barneshut compara la suma directa de la gravedad con el arbol de
+// Barnes-Hut (angulo de apertura T, Gravedad::THETA por defecto) sobre
+// sistemas de 8, 16... hasta N atractores y muchos disparos: tiempo de cada
+// uno y error del arbol.
+
+#include "Simulacion.h"
+#include "ControlIA.h"
+#include "PoolHilos.h"
+#include "Gravedad.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <chrono>
+
+using namespace std::chrono;
+
+static const char *NOMBRES_RESULTADO[Simulacion::NUM_RESULTADOS] = { "sin acabar", "empate", "gana izquierdo", "gana derecho" };
+
+// Flujos de los Aleatorio de cada ControlIA (los de la Simulacion son otros
+// generadores con la misma semilla)
+static const Aleatorio::Semilla FLUJO_IA_IZQUIERDO = 100;
+static const Aleatorio::Semilla FLUJO_IA_DERECHO = 101;
+static const Aleatorio::Semilla FLUJO_RAFAGA = 102;
+static const Aleatorio::Semilla FLUJO_VERIFICAR = 103;
+static const Aleatorio::Semilla FLUJO_BARNES_HUT = 104;
+
+static const char *CLAVES_RESULTADO[Simulacion::NUM_RESULTADOS] = { "sin_acabar", "empate", "izquierdo", "derecho" };
+
+struct ResultadoPartida
+{
+	Aleatorio::Semilla semilla;
+	Simulacion::RESULTADO resultado;
+	unsigned int ticks;
+	unsigned int ticksResultado;
+	int disparos;
+	int megaImpactos;
+};
+
+struct DatosPartidas
+{
+	Aleatorio::Semilla semilla;
+	unsigned int maxTicks;
+	ResultadoPartida *resultados;
+};
+
+static void
+Uso()
+{
+	printf("Uso: simulador [-semilla N] [-partidas N] [-ticks N] [-hilos N]\n");
+	printf("                [-csv FICHERO] [-resumen FICHERO]\n");
+	printf("       simulador -rafaga N [-ticks N]\n");
+	printf("       simulador -verificar\n");
+	printf("       simulador -barneshut N [-theta T]\n");
+}
+
+static double
+Segundos(steady_clock::time_point desde)
+{
+	return duration_cast<duration<double> >(steady_clock::now() - desde).count();
+}
+
+// Un atractor de masa 1000 en (1,2,3) y puntos alrededor a distintas
+// distancias: el modulo tiene que ser G*masa/d^2, apuntando al atractor, y
+// a doble distancia la cuarta parte
+static bool
+VerificarLey(bool vectorial, float cota)
+{
+	const int PUNTOS = 64;
+	const float MASA = 1000.0f;
+	const core::vector3df centro(1,2,3);
+	const float distancias[2] = { 5.0f, 10.0f };
+
+	Gravedad gravedad;
+	gravedad.AnadirAtractor(centro, MASA);
+
+	Aleatorio aleatorio(1, FLUJO_VERIFICAR);
+	float px[2][PUNTOS], py[2][PUNTOS], pz[2][PUNTOS];
+	float ax[2][PUNTOS], ay[2][PUNTOS], az[2][PUNTOS];
+	for ( int i = 0 ; i < PUNTOS ; ++i )
+	{
+		core::vector3df dir(aleatorio.Real()*2-1, aleatorio.Real()*2-1, aleatorio.Real()*2-1);
+		dir.normalize();
+		for ( int k = 0 ; k < 2 ; ++k )
+		{
+			core::vector3df p = centro + dir*distancias[k];
+			px[k][i] = p.X;
+			py[k][i] = p.Y;
+			pz[k][i] = p.Z;
+		}
+	}
+
+	float maxError = 0.0f;
+	for ( int k = 0 ; k < 2 ; ++k )
+	{
+		if ( vectorial )
+		{
+			gravedad.CalcularSSE2(px[k], py[k], pz[k], PUNTOS, ax[k], ay[k], az[k]);
+		}
+		else
+		{
+			gravedad.CalcularEscalar(px[k], py[k], pz[k], PUNTOS, ax[k], ay[k], az[k]);
+		}
+
+		float esperado = Gravedad::G * MASA / (distancias[k]*distancias[k]);
+		for ( int i = 0 ; i < PUNTOS ; ++i )
+		{
+			core::vector3df a(ax[k][i], ay[k][i], az[k][i]);
+			core::vector3df haciaCentro = centro - core::vector3df(px[k][i], py[k][i], pz[k][i]);
+			haciaCentro.normalize();
+
+			float errorModulo = fabs((float)a.getLength() - esperado) / esperado;
+			float errorDireccion = (a - haciaCentro*esperado).getLength() / esperado;
+			float error = errorModulo > errorDireccion ? errorModulo : errorDireccion;
+			if ( !(error <= maxError) )
+			{
+				maxError = error;
+			}
+		}
+	}
+
+	float maxErrorRazon = 0.0f;
+	for ( int i = 0 ; i < PUNTOS ; ++i )
+	{
+		float razon = core::vector3df(ax[0][i], ay[0][i], az[0][i]).getLength() /
+			core::vector3df(ax[1][i], ay[1][i], az[1][i]).getLength();
+		float error = fabs(razon - 4.0f) / 4.0f;
+		if ( !(error <= maxErrorRazon) )
+		{
+			maxErrorRazon = error;
+		}
+	}
+
+	bool ok = maxError <= cota && maxErrorRazon <= 2*cota;
+	printf("Ley %-7s error maximo %.3g, razon a d y 2d %.3g %s\n", vectorial ? "SSE2" : "escalar",
+		maxError, maxErrorRazon, ok ? "ok" : "FALLO");
+	return ok;
+}
+
+// Error de (vx,vy,vz) respecto a (ex,ey,ez) en el punto p, relativo a la
+// suma de los modulos de cada atraccion
+static float
+ErrorGravedad(core::vector3df p, core::vector3df v, core::vector3df e,
+	const core::vector3df *posiciones, const float *masas, int atractores)
+{
+	float modulos = 0.0f;
+	for ( int a = 0 ; a < atractores ; ++a )
+	{
+		float d2 = (float)p.getDistanceFromSQ(posiciones[a]);
+		modulos += Gravedad::G * masas[a] / (d2 > Gravedad::DIST2_MINIMA ? d2 : Gravedad::DIST2_MINIMA);
+	}
+	return (v - e).getLength() / modulos;
+}
+
+// Error maximo (ErrorGravedad) del arbol con angulo theta respecto a
+// CalcularEscalar, con n atractores y los puntos repartidos como en
+// BarnesHut
+static float
+ErrorArbol(int n, float theta)
+{
+	const int PUNTOS = 4096;
+	const float RADIO = 200.0f;
+
+	core::vector3df *posiciones = new core::vector3df[n];
+	float *masas = new float[n];
+	float *columnas = new float[9*PUNTOS];
+	float *px = columnas, *py = px + PUNTOS, *pz = py + PUNTOS;
+	float *ex = pz + PUNTOS, *ey = ex + PUNTOS, *ez = ey + PUNTOS;
+	float *ax = ez + PUNTOS, *ay = ax + PUNTOS, *az = ay + PUNTOS;
+
+	Aleatorio aleatorio(3, FLUJO_VERIFICAR);
+	Gravedad gravedad;
+	gravedad.SetTheta(theta);
+	for ( int a = 0 ; a < n ; ++a )
+	{
+		posiciones[a] = core::vector3df((aleatorio.Real()*2-1)*RADIO, 0, (aleatorio.Real()*2-1)*RADIO);
+		masas[a] = 100.0f + aleatorio.Real()*900.0f;
+		gravedad.AnadirAtractor(posiciones[a], masas[a]);
+	}
+	for ( int i = 0 ; i < PUNTOS ; ++i )
+	{
+		px[i] = (aleatorio.Real()*2-1)*RADIO;
+		py[i] = (aleatorio.Real()*2-1)*2;
+		pz[i] = (aleatorio.Real()*2-1)*RADIO;
+	}
+
+	gravedad.CalcularEscalar(px, py, pz, PUNTOS, ex, ey, ez);
+	gravedad.CalcularArbol(px, py, pz, PUNTOS, ax, ay, az);
+
+	float maxError = 0.0f;
+	for ( int i = 0 ; i < PUNTOS ; ++i )
+	{
+		float error = ErrorGravedad(core::vector3df(px[i], py[i], pz[i]), core::vector3df(ax[i], ay[i], az[i]),
+			core::vector3df(ex[i], ey[i], ez[i]), posiciones, masas, n);
+		if ( !(error <= maxError) )
+		{
+			maxError = error;
+		}
+	}
+
+	delete[] posiciones;
+	delete[] masas;
+	delete[] columnas;
+	return maxError;
+}
+
+static void
+BarnesHut(int maxAtractores, float theta)
+{
+	const int PUNTOS = 4096;
+	const float RADIO = 200.0f;
+
+	core::vector3df *posiciones = new core::vector3df[maxAtractores];
+	float *masas = new float[maxAtractores];
+	float *columnas = new float[9*PUNTOS];
+	float *px = columnas, *py = px + PUNTOS, *pz = py + PUNTOS;
+	float *ex = pz + PUNTOS, *ey = ex + PUNTOS, *ez = ey + PUNTOS;
+	float *ax = ez + PUNTOS, *ay = ax + PUNTOS, *az = ay + PUNTOS;
+
+	Aleatorio aleatorio(1, FLUJO_BARNES_HUT);
+	for ( int a = 0 ; a < maxAtractores ; ++a )
+	{
+		posiciones[a] = core::vector3df((aleatorio.Real()*2-1)*RADIO, 0, (aleatorio.Real()*2-1)*RADIO);
+		masas[a] = 100.0f + aleatorio.Real()*900.0f;
+	}
+	for ( int i = 0 ; i < PUNTOS ; ++i )
+	{
+		px[i] = (aleatorio.Real()*2-1)*RADIO;
+		py[i] = (aleatorio.Real()*2-1)*2;
+		pz[i] = (aleatorio.Real()*2-1)*RADIO;
+	}
+
+	printf("%d disparos, theta %.2f, %s\n", PUNTOS, theta, Gravedad::GetVectorialDisponible() ? "SSE2" : "escalar");
+	printf("atractores  directa ms   arbol ms  error maximo\n");
+	for ( int n = 8 ; n <= maxAtractores ; n = n*2 > maxAtractores && n < maxAtractores ? maxAtractores : n*2 )
+	{
+		Gravedad gravedad;
+		gravedad.SetTheta(theta);
+		for ( int a = 0 ; a < n ; ++a )
+		{
+			gravedad.AnadirAtractor(posiciones[a], masas[a]);
+		}
+
+		// Las veces justas para medir unos 100 ms con la directa
+		int repeticiones = 1 + (int)(100000000LL / ((long long)PUNTOS * n * 4));
+
+		gravedad.SetUmbralArbol(n+1);
+		steady_clock::time_point t0 = steady_clock::now();
+		for ( int r = 0 ; r < repeticiones ; ++r )
+		{
+			gravedad.Calcular(px, py, pz, PUNTOS, ex, ey, ez);
+		}
+		double segundosDirecta = Segundos(t0);
+
+		gravedad.SetUmbralArbol(0);
+		t0 = steady_clock::now();
+		for ( int r = 0 ; r < repeticiones ; ++r )
+		{
+			gravedad.Calcular(px, py, pz, PUNTOS, ax, ay, az);
+		}
+		double segundosArbol = Segundos(t0);
+
+		float maxError = 0.0f;
+		for ( int i = 0 ; i < PUNTOS ; ++i )
+		{
+			float error = ErrorGravedad(core::vector3df(px[i], py[i], pz[i]), core::vector3df(ax[i], ay[i], az[i]),
+				core::vector3df(ex[i], ey[i], ez[i]), posiciones, masas, n);
+			if ( !(error <= maxError) )
+			{
+				maxError = error;
+			}
+		}
+
+		printf("%10d %10.3f %10.3f  %.3g\n", n, segundosDirecta*1000.0/repeticiones,
+			segundosArbol*1000.0/repeticiones, maxError);
+		if ( n == maxAtractores )
+		{
+			break;
+		}
+	}
+
+	delete[] posiciones;
+	delete[] masas;
+	delete[] columnas;
+}
+
+// Disparos con energias distintas: al borrar uno su manejador deja de ser
+// valido (tambien cuando otro reutiliza su ranura) y los demas siguen
+// llevando a su disparo aunque haya cambiado de indice. Y el pool no pasa
+// de GetMaxDisparos().
+static bool
+VerificarManejadores()
+{
+	const int N = 8;
+	Simulacion simulacion(1, NULL, NULL);
+	Dios *dios = simulacion.GetDios(1);
+	PoolDisparos pool;
+	ManejadorDisparo m[N];
+	for ( int k = 0 ; k < N ; ++k )
+	{
+		m[k] = pool.Crear(core::vector3df(0,0,0), 1, (float)k, dios, NULL);
+	}
+
+	// El primero, el ultimo y uno del medio: el ultimo disparo pasa a
+	// ocupar cada hueco
+	int borrados[3] = { 0, N-1, N/2 };
+	bool ok = true;
+	for ( int b = 0 ; b < 3 ; ++b )
+	{
+		ManejadorDisparo viejo = m[borrados[b]];
+		pool.Borrar(pool.GetIndice(viejo));
+		ok = ok && !pool.Valido(viejo);
+		m[borrados[b]] = PoolDisparos::NINGUNO;
+
+		// Reutiliza la ranura del borrado con otra generacion
+		ManejadorDisparo nuevo = pool.Crear(core::vector3df(0,0,0), 1, 100.0f + b, dios, NULL);
+		ok = ok && nuevo != viejo && !pool.Valido(viejo) && pool.Valido(nuevo) &&
+			pool.GetEnergia(pool.GetIndice(nuevo)) == 100.0f + b;
+		pool.Borrar(pool.GetIndice(nuevo));
+		ok = ok && !pool.Valido(nuevo);
+	}
+	for ( int k = 0 ; k < N ; ++k )
+	{
+		if ( m[k] != PoolDisparos::NINGUNO )
+		{
+			ok = ok && pool.Valido(m[k]) && pool.GetManejador(pool.GetIndice(m[k])) == m[k] &&
+				pool.GetEnergia(pool.GetIndice(m[k])) == (float)k;
+		}
+	}
+	ok = ok && pool.GetNum() == N-3 && !pool.Valido(PoolDisparos::NINGUNO);
+
+	// Lleno: no crece mas y ningun manejador es NINGUNO
+	bool lleno = true;
+	while ( pool.GetNum() < PoolDisparos::GetMaxDisparos() )
+	{
+		lleno = lleno && pool.Crear(core::vector3df(0,0,0), 1, 1.0f, dios, NULL) != PoolDisparos::NINGUNO;
+	}
+	lleno = lleno && pool.Crear(core::vector3df(0,0,0), 1, 1.0f, dios, NULL) == PoolDisparos::NINGUNO &&
+		pool.GetNum() == PoolDisparos::GetMaxDisparos();
+
+	printf("Manejadores de disparos: %s, lleno con %d: %s\n", ok ? "ok" : "FALLO", PoolDisparos::GetMaxDisparos(),
+		lleno ? "ok" : "FALLO");
+	return ok && lleno;
+}
+
+static bool
+Verificar()
+{
+	bool ok = VerificarManejadores();
+	ok = VerificarLey(false, 1e-6f) && ok;
+	if ( Gravedad::GetVectorialDisponible() )
+	{
+		ok = VerificarLey(true, Gravedad::ERROR_SSE2) && ok;
+	}
+
+	// Muchos disparos y un sistema como el de una partida: las dos
+	// versiones tienen que coincidir dentro de la cota (ver ErrorGravedad:
+	// donde las atracciones se anulan el resultado es casi cero)
+	const int PUNTOS = 100003;
+	const int REPETICIONES = 20;
+	const int ATRACTORES = 1 + Simulacion::NUM_PLANETAS;
+	Aleatorio aleatorio(2, FLUJO_VERIFICAR);
+	Gravedad gravedad;
+	core::vector3df posiciones[ATRACTORES];
+	float masas[ATRACTORES];
+	for ( int a = 0 ; a < ATRACTORES ; ++a )
+	{
+		posiciones[a] = a == 0 ? core::vector3df(0,0,0) :
+			core::vector3df((aleatorio.Real()*2-1)*20, 0, (aleatorio.Real()*2-1)*20);
+		masas[a] = a == 0 ? 1000.0f : 100.0f;
+		gravedad.AnadirAtractor(posiciones[a], masas[a]);
+	}
+
+	float *columnas = new float[9*PUNTOS];
+	float *px = columnas, *py = px + PUNTOS, *pz = py + PUNTOS;
+	float *ex = pz + PUNTOS, *ey = ex + PUNTOS, *ez = ey + PUNTOS;
+	float *vx = ez + PUNTOS, *vy = vx + PUNTOS, *vz = vy + PUNTOS;
+	for ( int i = 0 ; i < PUNTOS ; ++i )
+	{
+		px[i] = (aleatorio.Real()*2-1)*100;
+		py[i] = (aleatorio.Real()*2-1)*2;
+		pz[i] = (aleatorio.Real()*2-1)*100;
+	}
+
+	steady_clock::time_point t0 = steady_clock::now();
+	for ( int r = 0 ; r < REPETICIONES ; ++r )
+	{
+		gravedad.CalcularEscalar(px, py, pz, PUNTOS, ex, ey, ez);
+	}
+	double segundosEscalar = Segundos(t0);
+
+	if ( Gravedad::GetVectorialDisponible() )
+	{
+		t0 = steady_clock::now();
+		for ( int r = 0 ; r < REPETICIONES ; ++r )
+		{
+			gravedad.CalcularSSE2(px, py, pz, PUNTOS, vx, vy, vz);
+		}
+		double segundosSSE2 = Segundos(t0);
+
+		float maxError = 0.0f;
+		for ( int i = 0 ; i < PUNTOS ; ++i )
+		{
+			float error = ErrorGravedad(core::vector3df(px[i], py[i], pz[i]), core::vector3df(vx[i], vy[i], vz[i]),
+				core::vector3df(ex[i], ey[i], ez[i]), posiciones, masas, ATRACTORES);
+			if ( !(error <= maxError) )
+			{
+				maxError = error;
+			}
+		}
+		bool dentro = maxError <= Gravedad::ERROR_SSE2;
+		ok = ok && dentro;
+		printf("SSE2 frente a escalar: error maximo %.3g (cota %.3g) %s\n", maxError, Gravedad::ERROR_SSE2,
+			dentro ? "ok" : "FALLO");
+		printf("%d disparos, %d atractores: escalar %.3f ms, SSE2 %.3f ms\n", PUNTOS, gravedad.GetNumAtractores(),
+			segundosEscalar*1000.0/REPETICIONES, segundosSSE2*1000.0/REPETICIONES);
+	}
+	else
+	{
+		printf("%d disparos, %d atractores: escalar %.3f ms (sin SSE2)\n", PUNTOS, gravedad.GetNumAtractores(),
+			segundosEscalar*1000.0/REPETICIONES);
+	}
+
+	// El arbol: con theta 0 es la suma directa en otro orden, asi que solo
+	// cambia el redondeo (FLT_EPSILON por atractor como mucho), y con THETA
+	// queda dentro de ERROR_ARBOL
+	for ( int n = Gravedad::UMBRAL_ARBOL ; n <= 4*Gravedad::UMBRAL_ARBOL ; n *= 4 )
+	{
+		float errorExacto = ErrorArbol(n, 0.0f);
+		float errorTheta = ErrorArbol(n, Gravedad::THETA);
+		bool dentro = errorExacto <= n*FLT_EPSILON && errorTheta <= Gravedad::ERROR_ARBOL;
+		ok = ok && dentro;
+		printf("Arbol con %d atractores: theta 0 error %.3g (cota %.3g), theta %.2f error %.3g (cota %.3g) %s\n",
+			n, errorExacto, n*FLT_EPSILON, Gravedad::THETA, errorTheta, Gravedad::ERROR_ARBOL, dentro ? "ok" : "FALLO");
+	}
+
+	delete[] columnas;
+	return ok;
+}
+
+// Una partida sin dioses con n disparos por todo el sistema, con o sin la
+// rejilla. Devuelve los segundos que tardan los pasos y deja en restantes
+// los disparos que quedan tras cada uno.
+static double
+Rafaga(int n, int pasos, bool rejilla, int *restantes)
+{
+	Simulacion simulacion(1, NULL, NULL);
+	simulacion.SetRejillaActiva(rejilla);
+	Aleatorio aleatorio(1, FLUJO_RAFAGA);
+	for ( int i = 0 ; i < n ; ++i )
+	{
+		core::vector3df pos((aleatorio.Real()*2-1)*70, 0, (aleatorio.Real()*2-1)*70);
+		simulacion.CrearDisparo(pos, 10.0f, 1 + i%3, simulacion.GetDios(1 + i%2));
+	}
+
+	steady_clock::time_point inicio = steady_clock::now();
+	for ( int p = 0 ; p < pasos ; ++p )
+	{
+		simulacion.Paso();
+		restantes[p] = simulacion.GetNumDisparos();
+	}
+	return Segundos(inicio);
+}
+
+static bool
+CompararRafaga(int n, int pasos)
+{
+	int *conRejilla = new int[pasos];
+	int *todos = new int[pasos];
+
+	double segundosRejilla = Rafaga(n, pasos, true, conRejilla);
+	double segundosTodos = Rafaga(n, pasos, false, todos);
+
+	bool iguales = memcmp(conRejilla, todos, pasos*sizeof(int)) == 0;
+	printf("%d disparos, %d pasos: quedan %d %s\n", n, pasos, conRejilla[pasos-1], iguales ? "ok" : "FALLO");
+	printf("  rejilla         %.3f ms/paso\n", segundosRejilla*1000.0/pasos);
+	printf("  todos con todos %.3f ms/paso\n", segundosTodos*1000.0/pasos);
+
+	delete[] conRejilla;
+	delete[] todos;
+	return iguales;
+}
+
+// Tarea del pool: juega la partida m. Solo escribe en su resultado.
+static void
+JugarPartida(void *datos, int m)
+{
+	DatosPartidas *partidas = (DatosPartidas *)datos;
+	Aleatorio::Semilla semilla = partidas->semilla + m;
+
+	ControlIA izquierdo(semilla, FLUJO_IA_IZQUIERDO);
+	ControlIA derecho(semilla, FLUJO_IA_DERECHO);
+	Simulacion simulacion(semilla, &izquierdo, &derecho);
+
+	while ( simulacion.GetResultado() == Simulacion::EN_JUEGO && simulacion.GetTicks() < partidas->maxTicks )
+	{
+		simulacion.Paso();
+	}
+
+	ResultadoPartida &r = partidas->resultados[m];
+	r.semilla = semilla;
+	r.resultado = simulacion.GetResultado();
+	r.ticks = simulacion.GetTicks();
+	r.ticksResultado = simulacion.GetTicksResultado();
+	r.disparos = simulacion.GetDisparosCreados();
+	r.megaImpactos = simulacion.GetMegaImpactos();
+}
+
+static bool
+GuardarCSV(const char *fichero, const ResultadoPartida *resultados, int n)
+{
+	FILE *f = fopen(fichero, "w");
+	if ( f == NULL )
+	{
+		return false;
+	}
+
+	fprintf(f, "semilla,resultado,pasos,paso_final,disparos,mega_impactos\n");
+	for ( int m = 0 ; m < n ; ++m )
+	{
+		const ResultadoPartida &r = resultados[m];
+		fprintf(f, "%llu,%s,%u,%u,%d,%d\n", r.semilla, CLAVES_RESULTADO[r.resultado], r.ticks,
+			r.resultado != Simulacion::EN_JUEGO ? r.ticksResultado : r.ticks, r.disparos, r.megaImpactos);
+	}
+	return fclose(f) == 0;
+}
+
+// Una fila con los totales: partidas de cada resultado, fraccion que gano
+// cada dios, duracion media de las acabadas (vacia si no acabo ninguna) y
+// mega impactos por partida
+static bool
+GuardarResumen(const char *fichero, Aleatorio::Semilla semilla, int partidas, const int *cuenta,
+	unsigned long long ticksHastaFinal, long long megaImpactos)
+{
+	FILE *f = fopen(fichero, "w");
+	if ( f == NULL )
+	{
+		return false;
+	}
+
+	fprintf(f, "semilla,partidas");
+	for ( int r = 0 ; r < Simulacion::NUM_RESULTADOS ; ++r )
+	{
+		fprintf(f, ",%s", CLAVES_RESULTADO[r]);
+	}
+	fprintf(f, ",tasa_izquierdo,tasa_derecho,duracion_media,mega_impactos_por_partida\n");
+
+	fprintf(f, "%llu,%d", semilla, partidas);
+	for ( int r = 0 ; r < Simulacion::NUM_RESULTADOS ; ++r )
+	{
+		fprintf(f, ",%d", cuenta[r]);
+	}
+	fprintf(f, ",%.4f,%.4f,", (double)cuenta[Simulacion::GANA_IZQUIERDO] / partidas,
+		(double)cuenta[Simulacion::GANA_DERECHO] / partidas);
+	int acabadas = partidas - cuenta[Simulacion::EN_JUEGO];
+	if ( acabadas > 0 )
+	{
+		fprintf(f, "%.1f", (double)ticksHastaFinal / acabadas);
+	}
+	fprintf(f, ",%.4f\n", (double)megaImpactos / partidas);
+	return fclose(f) == 0;
+}
+
+int main(int argc, char **argv)
+{
+	Aleatorio::Semilla semilla = 1;
+	int partidas = 10;
+	unsigned int maxTicks = 60*60*10;
+	int hilos = 1;
+	const char *csv = NULL;
+	const char *resumen = NULL;
+	int rafaga = 0;
+	bool ticksIndicados = false;
+	bool verificar = false;
+	int barnesHut = 0;
+	float theta = Gravedad::THETA;
+	bool thetaIndicado = false;
+
+	for ( int i = 1 ; i < argc ; ++i )
+	{
+		if ( i+1 < argc && strcmp(argv[i], "-semilla") == 0 )
+		{
+			semilla = strtoull(argv[++i], NULL, 10);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-partidas") == 0 )
+		{
+			partidas = atoi(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-ticks") == 0 )
+		{
+			maxTicks = (unsigned int)strtoul(argv[++i], NULL, 10);
+			ticksIndicados = true;
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-hilos") == 0 )
+		{
+			hilos = atoi(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-csv") == 0 )
+		{
+			csv = argv[++i];
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-resumen") == 0 )
+		{
+			resumen = argv[++i];
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-rafaga") == 0 )
+		{
+			rafaga = atoi(argv[++i]);
+		}
+		else if ( strcmp(argv[i], "-verificar") == 0 )
+		{
+			verificar = true;
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-barneshut") == 0 )
+		{
+			barnesHut = atoi(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-theta") == 0 )
+		{
+			theta = (float)atof(argv[++i]);
+			thetaIndicado = true;
+		}
+		else
+		{
+			Uso();
+			return 1;
+		}
+	}
+
+	if ( partidas < 1 || maxTicks < 1 || rafaga < 0 || barnesHut < 0 || !(theta >= 0.0f) )
+	{
+		printf("Parametros fuera de rango\n");
+		return 1;
+	}
+
+	// -theta solo tiene sentido con -barneshut
+	if ( thetaIndicado && barnesHut == 0 )
+	{
+		Uso();
+		return 1;
+	}
+
+	if ( verificar )
+	{
+		return Verificar() ? 0 : 1;
+	}
+
+	if ( barnesHut > 0 )
+	{
+		BarnesHut(barnesHut, theta);
+		return 0;
+	}
+
+	if ( rafaga > 0 )
+	{
+		return CompararRafaga(rafaga, ticksIndicados ? (int)maxTicks : 10) ? 0 : 1;
+	}
+
+	ResultadoPartida *resultados = new ResultadoPartida[partidas];
+	DatosPartidas datos;
+	datos.semilla = semilla;
+	datos.maxTicks = maxTicks;
+	datos.resultados = resultados;
+
+	PoolHilos pool(hilos);
+	steady_clock::time_point inicio = steady_clock::now();
+	pool.Ejecutar(JugarPartida, &datos, partidas);
+	double segundos = Segundos(inicio);
+
+	int cuenta[Simulacion::NUM_RESULTADOS];
+	memset(cuenta, 0, sizeof(cuenta));
+	unsigned long long pasos = 0;
+	unsigned long long ticksHastaFinal = 0;
+	long long megaImpactos = 0;
+	for ( int m = 0 ; m < partidas ; ++m )
+	{
+		cuenta[resultados[m].resultado]++;
+		pasos += resultados[m].ticks;
+		megaImpactos += resultados[m].megaImpactos;
+		if ( resultados[m].resultado != Simulacion::EN_JUEGO )
+		{
+			ticksHastaFinal += resultados[m].ticksResultado;
+		}
+	}
+
+	int nucleos = pool.GetNumHilos();
+	printf("%d partidas desde la semilla %llu, %u pasos como mucho, %d hilos\n", partidas, semilla, maxTicks, nucleos);
+	for ( int r = 0 ; r < Simulacion::NUM_RESULTADOS ; ++r )
+	{
+		printf("  %-15s %6d (%5.1f%%)\n", NOMBRES_RESULTADO[r], cuenta[r], 100.0 * cuenta[r] / partidas);
+	}
+	int acabadas = partidas - cuenta[Simulacion::EN_JUEGO];
+	if ( acabadas > 0 )
+	{
+		printf("Duracion media de las acabadas: %.0f pasos\n", (double)ticksHastaFinal / acabadas);
+	}
+	printf("Mega impactos: %.3f por partida\n", (double)megaImpactos / partidas);
+	printf("Tiempo total: %.3f s, %llu pasos\n", segundos, pasos);
+	if ( segundos > 0.0 )
+	{
+		printf("Rendimiento: %.0f pasos/s, %.0f pasos/s por hilo (%.1f veces el tiempo real)\n",
+			pasos / segundos, pasos / segundos / nucleos, pasos / segundos / 60.0);
+	}
+
+	bool ok = true;
+	if ( csv != NULL && !GuardarCSV(csv, resultados, partidas) )
+	{
+		printf("No se pudo escribir %s\n", csv);
+		ok = false;
+	}
+	if ( resumen != NULL && !GuardarResumen(resumen, semilla, partidas, cuenta, ticksHastaFinal, megaImpactos) )
+	{
+		printf("No se pudo escribir %s\n", resumen);
+		ok = false;
+	}
+	delete[] resultados;
+
+	return ok ? 0 : 1;
+}
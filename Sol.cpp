@@ -1,25 +1,16 @@
 #include "Sol.h"
 
-#include "Partida.h"
-#include "SolNode.h"
-#include "Juego.h"
+#include "VistasPartida.h"
+#include "Aleatorio.h"
 
 #include <irrlicht.h>
 
-Sol::Sol(Partida *partida, core::vector3df pos) : pos(pos)
+Sol::Sol(core::vector3df pos, Aleatorio &aleatorio, FabricaVistas *vistas) : pos(pos)
 {
-	/*
-	nodo = new SolNode(
-		partida->GetNodo(),
-		Juego::GetInstance()->GetSceneManager(),
-		-1,
-		3.0f);
-		*/
-	nodo = new SolNode(
-		Juego::GetInstance()->GetSceneManager()->getRootSceneNode(),
-		Juego::GetInstance()->GetSceneManager(),
-		0,
-		1.0f);
+	if ( vistas )
+	{
+		vistas->CrearSol(aleatorio);
+	}
 		
 	masa=1000.0f;
 }
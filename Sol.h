@@ -3,19 +3,18 @@
 #include <irrlicht.h>
 using namespace irr;
 
-class Partida;
-class SolNode;
+class Aleatorio;
+class FabricaVistas;
 
 class Sol
 {
 private:
 	core::vector3df pos;
-	Partida * partida ;
-	SolNode * nodo;
 	float masa;
 
 public:
-	Sol(Partida *partida, core::vector3df pos);
+	// vistas puede ser NULL
+	Sol(core::vector3df pos, Aleatorio &aleatorio, FabricaVistas *vistas);
 	virtual ~Sol(void);
 
 	float GetCalorEmitido(core::vector3df pos);
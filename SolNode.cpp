@@ -2,216 +2,430 @@
 
 #include "Juego.h"
 #include "AtmosferaNode.h"
+#include "GeneradorTerreno.h"
+#include "CacheMallas.h"
+#include "ArchivoMapeado.h"
+#include "MosaicoAlturas.h"
+#include "ExportadorAlturas.h"
+#include "ImportadorAlturas.h"
 
 #include <cmath>
 
 #include <stdlib.h>
+#include <stdio.h>
 using namespace std;
 using namespace irr;
 
-SolNode::SolNode(scene::ISceneNode *parent, scene::ISceneManager *mgr, s32 id, float radio) 
-		: scene::ISceneNode(parent, mgr, id)
+SolNode::SolNode(scene::ISceneNode *parent, scene::ISceneManager *mgr, s32 id, float radio, Aleatorio &aleatorio, int ancho, int alto, int numHilos) 
+		: scene::ISceneNode(parent, mgr, id), parches(NULL), numParches(0), parchesX(0), parchesY(0), W(ancho), H(alto), archivo(NULL), lector(NULL), frame(0),
+		  lod(false), distanciaLOD(2.56f), presupuestoTriangulos(0), triangulosDibujados(0)
 	{
 
-		this->setRotation(core::vector3df(0,0,-110));
-		this->setPosition(core::vector3df(0,100,0));
-		this->setScale(core::vector3df(260,260,260));
-
-		this->addAnimator( mgr->createRotationAnimator(core::vector3df(0,0.3,0)));
-
-		material.AmbientColor = video::SColor::SColor(255,255,255,255);
-		material.BackfaceCulling = false;
-		material.DiffuseColor = video::SColor(255,0,192,0);
-		material.GouraudShading = true;
-		material.Lighting = true;
-		material.Wireframe = true;
-		material.ZBuffer = true;
-		material.ZWriteEnable = true;
-		material.Shininess = 0;
-		material.MaterialType = video::E_MATERIAL_TYPE::EMT_SOLID_2_LAYER;
-
-		material.Texture1 = Juego::GetInstance()->GetVideoDriver()->getTexture("data/Rocas.bmp");
-		material.Texture2 = Juego::GetInstance()->GetVideoDriver()->getTexture("data/Hierba.bmp");
+		InicializarNodo();
 
 		// -------------------------------------------------------------------
-		// Generamos los vertices
+		// Generamos el terreno, o lo sacamos de la cache
 		// -------------------------------------------------------------------
-
-		// Inicializamos los vertices
-		vertices = new video::S3DVertex[W*H];
-		for ( int x = 0 ; x < W ; ++x )
+		u32 inicio = Juego::GetInstance()->GetDevice()->getTimer()->getRealTime();
+
+		ClaveCache clave("SolNode", GeneradorTerreno::VERSION);
+		clave.Anadir(aleatorio);
+		clave.Anadir(W);
+		clave.Anadir(H);
+		clave.Anadir(NUM_BULTOS);
+		clave.Anadir(OPERADOR_ARCOTANGENTE);
+		clave.Anadir(OperadoresTerreno::GetNivel());
+		clave.Anadir(TAM_PARCHE);
+
+		CrearParches();
+		bool enCache = CargarParches(clave, aleatorio);
+		if ( !enCache )
 		{
-			for ( int y = 0 ; y < H ; ++y )
-			{
-				vertices[y*W+x] = video::S3DVertex((x-W/2)*0.01, 0.0, (y-H/2)*0.01, 0, 0, 0, video::SColor(255,255,255,255), x/10.0, y/10.0);
-			}
+			GeneradorTerreno generador(W, H);
+			generador.SetNumHilos(numHilos);
+			generador.Generar(aleatorio, NUM_BULTOS);
+
+			ConstruirParches(generador);
+			GuardarParches(clave, aleatorio);
 		}
+		CalcularCajas();
 
+		if ( Juego::GetInstance()->GetEnBenchmark() )
+		{
+			printf("SolNode %dx%d: %u ms (%s)\n", W, H,
+				Juego::GetInstance()->GetDevice()->getTimer()->getRealTime() - inicio,
+				enCache ? "cache" : "generado");
+		}
+	}
 
-		// Modificamos el terreno
+SolNode::SolNode(scene::ISceneNode *parent, scene::ISceneManager *mgr, s32 id, const char *ficheroMosaico)
+		: scene::ISceneNode(parent, mgr, id), parches(NULL), numParches(0), parchesX(0), parchesY(0), W(0), H(0), archivo(NULL), lector(NULL), frame(0),
+		  lod(false), distanciaLOD(2.56f), presupuestoTriangulos(0), triangulosDibujados(0)
+	{
+		InicializarNodo();
 
-		// Campo de potencial 
-		// [ y += mag / ( dist^(exp/2) ) ]
-		/*
-		for ( int i = 0 ; i < 1000 ; ++i )
+		lector = new LectorMosaico();
+		if ( !lector->Abrir(ficheroMosaico) )
 		{
-			float mag = (rand() % 100 - 50)/500.0f ;
-			float exp = (rand() % 20 +10 ) /100.0f ;
+			printf("SolNode: no se pudo abrir %s\n", ficheroMosaico);
+			delete lector;
+			lector = NULL;
+			return;
+		}
 
-			float x0 = rand() % W + 0.5f ;
-			float y0 = rand() % H + 0.5f ;
-			
-			for ( int x = 0 ; x < W ; ++x )
-			{
-				for ( int y = 0 ; y < H ; ++y )
-				{
-					float dist = pow( (x-x0)*(x-x0) + (y-y0)*(y-y0), exp);  
+		W = lector->GetAncho();
+		H = lector->GetAlto();
+		CrearParches();
+		CalcularCajasMosaico();
+	}
 
-					vertices[y*W+x].Pos.Y += mag/dist;
-				}
-			}
-		}
-		*/
+SolNode::SolNode(scene::ISceneNode *parent, scene::ISceneManager *mgr, s32 id, const char *ficheroAlturas,
+		Aleatorio &aleatorio, int ancho, int alto, float minimo, float maximo, int bultosDetalle, int numHilos)
+		: scene::ISceneNode(parent, mgr, id), parches(NULL), numParches(0), parchesX(0), parchesY(0), W(ancho), H(alto), archivo(NULL), lector(NULL), frame(0),
+		  lod(false), distanciaLOD(2.56f), presupuestoTriangulos(0), triangulosDibujados(0)
+	{
+		InicializarNodo();
+
+		u32 inicio = Juego::GetInstance()->GetDevice()->getTimer()->getRealTime();
 
-		// Paraboloide de revolucin 
-		// [ y += mag - (dist^2)/radio ] (Siempre y cuando mag > (dist^2)/radio )
-		/*
-		for ( int i = 0 ; i < 1000 ; ++i )
+		// Si no se puede importar el mapa queda plano, solo con el detalle
+		GeneradorTerreno generador(W, H);
+		generador.SetNumHilos(numHilos);
+		if ( !ImportadorAlturas::Cargar(ficheroAlturas, minimo, maximo, generador, SceneManager->getVideoDriver()) )
 		{
-			float mag = (rand()%100) / 4000.0f ;
-			float rad = (rand()%50000000 + 1000000) / 100.0f ;
+			printf("SolNode: no se pudo importar %s\n", ficheroAlturas);
+		}
+		generador.AnadirBultos(aleatorio, bultosDetalle);
 
-			float x0 = rand() % W + 0.5f ;
-			float y0 = rand() % H + 0.5f ;
+		CrearParches();
+		ConstruirParches(generador);
+		CalcularCajas();
 
-			for ( int x = 0 ; x < W ; ++x )
-			{
-				for ( int y = 0 ; y < H ; ++y )
-				{
-					float dist = pow( (x-x0)*(x-x0) + (y-y0)*(y-y0), 2 ) / rad ;
-					if ( dist < mag )
-					{
-						vertices[y*W+x].Pos.Y += mag - dist ;
-					}
-				}
-			}
+		if ( Juego::GetInstance()->GetEnBenchmark() )
+		{
+			printf("SolNode %dx%d: %u ms (importado)\n", W, H,
+				Juego::GetInstance()->GetDevice()->getTimer()->getRealTime() - inicio);
 		}
-		*/
+	}
 
-		// Arcotangente
-		// [ y += mag * atan(rad*k - dist*k)/PI + PI/2 ]
-		
-		float PI = 3.1416;
-		for ( int i = 0 ; i < 10 ; ++i )
-		{
-			float mag = (rand()%200 +300) / 4000.0f ;
-			float rad = (rand()%1000 + 1000) / 150.0f ;
-			float k = 1/rad ;
+void
+SolNode::InicializarNodo()
+{
+	this->setRotation(core::vector3df(0,0,-110));
+	this->setPosition(core::vector3df(0,100,0));
+	this->setScale(core::vector3df(260,260,260));
+
+	this->addAnimator( SceneManager->createRotationAnimator(core::vector3df(0,0.3,0)));
+
+	material.AmbientColor = video::SColor::SColor(255,255,255,255);
+	material.BackfaceCulling = false;
+	material.DiffuseColor = video::SColor(255,0,192,0);
+	material.GouraudShading = true;
+	material.Lighting = true;
+	material.Wireframe = true;
+	material.ZBuffer = true;
+	material.ZWriteEnable = true;
+	material.Shininess = 0;
+	material.MaterialType = video::E_MATERIAL_TYPE::EMT_SOLID_2_LAYER;
+
+	material.Texture1 = Juego::GetInstance()->GetVideoDriver()->getTexture("data/Rocas.bmp");
+	material.Texture2 = Juego::GetInstance()->GetVideoDriver()->getTexture("data/Hierba.bmp");
+}
 
-			float x0 = rand() % W + 0.5f ;
-			float y0 = rand() % H + 0.5f ;
+void
+SolNode::CrearParches()
+{
+	// Cada parche cubre TAM_PARCHE-1 celdas; el ultimo de cada fila o
+	// columna puede ser mas pequeno
+	int celdas = TAM_PARCHE-1;
+	parchesX = (W-1 + celdas-1) / celdas;
+	parchesY = (H-1 + celdas-1) / celdas;
+
+	numParches = parchesX*parchesY;
+	parches = new ParcheTerreno[numParches];
 
-			for ( int x = 0 ; x < W ; ++x )
+	int n = 0;
+	for ( int py = 0 ; py < parchesY ; ++py )
+	{
+		for ( int px = 0 ; px < parchesX ; ++px )
+		{
+			int ancho = core::min_(TAM_PARCHE, W-px*celdas);
+			int alto = core::min_(TAM_PARCHE, H-py*celdas);
+
+			ParcheTerreno &parche = parches[n++];
+			parche.vertices = NULL;
+			parche.indices = NULL;
+			parche.numVertices = ancho*alto;
+			parche.numTriangulos = (ancho-1)*(alto-1)*2;
+
+			parche.ancho = ancho;
+			parche.alto = alto;
+			parche.nivel = 0;
+			parche.visible = true;
+			parche.distancia = 0.0f;
+			parche.pasoIndices = 1;
+			for ( int b = 0 ; b < GeneradorTerreno::NUM_BORDES ; ++b )
 			{
-				for ( int y = 0 ; y < H ; ++y )
-				{
-					float dist = sqrt( (x-x0)*(x-x0) + (y-y0)*(y-y0) ) ;
+				parche.pasoVecinosIndices[b] = 1;
+			}
+			parche.ultimoFrame = 0;
 
-					vertices[y*W+x].Pos.Y += mag * atan(1 - dist*k)/PI + PI/2;
-				}
+			// El paso de cada nivel tiene que dividir las celdas del parche
+			parche.nivelMaximo = 0;
+			int paso = 2;
+			while ( paso < TAM_PARCHE && (ancho-1) % paso == 0 && (alto-1) % paso == 0 )
+			{
+				parche.nivelMaximo++;
+				paso *= 2;
 			}
 		}
-		
+	}
+}
 
-		
+void
+SolNode::ConstruirParches(const GeneradorTerreno &generador)
+{
+	int celdas = TAM_PARCHE-1;
+	for ( int i = 0 ; i < numParches ; ++i )
+	{
+		ParcheTerreno &parche = parches[i];
+		int x0 = (i % parchesX)*celdas;
+		int y0 = (i / parchesX)*celdas;
 
-		// Resituamos el terreno
-		float mean = 0.0f ;
-		for ( int i = 0 ; i < W*H ; ++i )
+		parche.vertices = new video::S3DVertex[parche.numVertices];
+		generador.ConstruirVertices(parche.vertices, x0, y0, parche.ancho, parche.alto);
+
+		parche.indices = new u16[GeneradorTerreno::NumIndices(parche.ancho, parche.alto)];
+		parche.numTriangulos = GeneradorTerreno::GenerarIndices(parche.indices, parche.ancho, parche.alto);
+	}
+}
+
+bool
+SolNode::CargarParches(const ClaveCache &clave, Aleatorio &aleatorio)
+{
+	CacheMallas::Malla *mallas = new CacheMallas::Malla[numParches];
+	Aleatorio::Semilla estadoAleatorio;
+	archivo = CacheMallas::Cargar(clave, mallas, numParches, estadoAleatorio);
+
+	// Las mallas tienen que tener exactamente la forma de los parches
+	for ( int i = 0 ; archivo && i < numParches ; ++i )
+	{
+		if ( mallas[i].numVertices != parches[i].numVertices ||
+			mallas[i].numIndices != GeneradorTerreno::NumIndices(parches[i].ancho, parches[i].alto) )
 		{
-			mean += vertices[i].Pos.Y;
+			delete archivo;
+			archivo = NULL;
 		}
-		mean /= W*H ;
+	}
+
+	// Los parches apuntan al fichero mapeado. Los indices se reescriben con
+	// el LOD, pero el mapeado es de copia al escribir y el fichero no cambia.
+	for ( int i = 0 ; archivo && i < numParches ; ++i )
+	{
+		parches[i].vertices = mallas[i].vertices;
+		parches[i].indices = mallas[i].indices;
+		parches[i].numTriangulos = mallas[i].numIndices / 3;
+	}
+	if ( archivo != NULL )
+	{
+		aleatorio.SetEstado(estadoAleatorio);
+	}
+
+	delete [] mallas;
+	return archivo != NULL;
+}
 
-		for ( int i = 0 ; i < W*H ; ++i )
+void
+SolNode::GuardarParches(const ClaveCache &clave, const Aleatorio &aleatorio)
+{
+	CacheMallas::Malla *mallas = new CacheMallas::Malla[numParches];
+	for ( int i = 0 ; i < numParches ; ++i )
+	{
+		mallas[i].vertices = parches[i].vertices;
+		mallas[i].indices = parches[i].indices;
+		mallas[i].numVertices = parches[i].numVertices;
+		mallas[i].numIndices = parches[i].numTriangulos*3;
+	}
+	CacheMallas::Guardar(clave, mallas, numParches, aleatorio.GetEstado());
+	delete [] mallas;
+}
+
+void
+SolNode::CalcularCajas()
+{
+	for ( int i = 0 ; i < numParches ; ++i )
+	{
+		ParcheTerreno &parche = parches[i];
+		parche.box.reset(parche.vertices[0].Pos);
+		for ( int v = 1 ; v < parche.numVertices ; ++v )
 		{
-			vertices[i].Pos.Y -= mean ;
+			parche.box.addInternalPoint(parche.vertices[v].Pos);
 		}
-		
+	}
 
-		// -------------------------------------------------------------------
-		// Generamos los triangulos
-		// -------------------------------------------------------------------
+	// -------------------------------------------------------------------
+	// Calculamos el bounding box
+	// -------------------------------------------------------------------
+	box = parches[0].box;
+	for ( int i = 1 ; i < numParches ; ++i )
+	{
+		box.addInternalBox(parches[i].box);
+	}
+}
 
-		indices = new u16[(W-1)*(H-1)*2*3];
-		int nTrig = 0 ;
-		for ( int x = 0 ; x < W-1 ; ++x )
+void
+SolNode::CalcularCajasMosaico()
+{
+	// Las cajas salen del rango de alturas de los mosaicos que cubre cada
+	// parche, que esta en el indice: no hace falta leer ninguna altura
+	int celdas = TAM_PARCHE-1;
+	int tam = lector->GetTamMosaico();
+	for ( int i = 0 ; i < numParches ; ++i )
+	{
+		ParcheTerreno &parche = parches[i];
+		int x0 = (i % parchesX)*celdas;
+		int y0 = (i / parchesX)*celdas;
+		int x1 = x0 + parche.ancho-1;
+		int y1 = y0 + parche.alto-1;
+
+		f32 minimo = lector->GetMinimo(x0/tam, y0/tam);
+		f32 maximo = lector->GetMaximo(x0/tam, y0/tam);
+		for ( int my = y0/tam ; my <= y1/tam ; ++my )
 		{
-			for ( int y = 0 ; y < H-1 ; ++y )
+			for ( int mx = x0/tam ; mx <= x1/tam ; ++mx )
 			{
+				minimo = core::min_(minimo, lector->GetMinimo(mx, my));
+				maximo = core::max_(maximo, lector->GetMaximo(mx, my));
+			}
+		}
 
-				indices[nTrig*3+0] = (y  )*W + (x  );
-				indices[nTrig*3+1] = (y+1)*W + (x+1);
-				indices[nTrig*3+2] = (y+1)*W + (x  );
+		parche.box.reset(core::vector3df((x0-W/2)*GeneradorTerreno::PASO, minimo, (y0-H/2)*GeneradorTerreno::PASO));
+		parche.box.addInternalPoint(core::vector3df((x1-W/2)*GeneradorTerreno::PASO, maximo, (y1-H/2)*GeneradorTerreno::PASO));
+	}
 
-				nTrig++;
+	box = parches[0].box;
+	for ( int i = 1 ; i < numParches ; ++i )
+	{
+		box.addInternalBox(parches[i].box);
+	}
+}
 
-				indices[nTrig*3+0] = (y  )*W + (x  );
-				indices[nTrig*3+1] = (y  )*W + (x+1);
-				indices[nTrig*3+2] = (y+1)*W + (x+1);				
+void
+SolNode::CargarParcheMosaico(int i)
+{
+	ParcheTerreno &parche = parches[i];
+	int celdas = TAM_PARCHE-1;
+	int x0 = (i % parchesX)*celdas;
+	int y0 = (i / parchesX)*celdas;
+
+	// Leemos tambien la fila y la columna vecinas de cada lado, que hacen
+	// falta para las normales del borde
+	int vx0 = core::max_(x0-1, 0);
+	int vy0 = core::max_(y0-1, 0);
+	int vx1 = core::min_(x0+parche.ancho+1, W);
+	int vy1 = core::min_(y0+parche.alto+1, H);
+	int anchoVentana = vx1-vx0;
+
+	float *ventana = new float[anchoVentana*(vy1-vy0)];
+	lector->LeerVentana(ventana, vx0, vy0, anchoVentana, vy1-vy0);
+
+	parche.vertices = new video::S3DVertex[parche.numVertices];
+	GeneradorTerreno::ConstruirVertices(parche.vertices, &ventana[(y0-vy0)*anchoVentana + x0-vx0], anchoVentana,
+		W, H, x0, y0, parche.ancho, parche.alto);
+	delete [] ventana;
+
+	parche.indices = new u16[GeneradorTerreno::NumIndices(parche.ancho, parche.alto)];
+	parche.numTriangulos = GeneradorTerreno::GenerarIndices(parche.indices, parche.ancho, parche.alto);
+	parche.pasoIndices = 1;
+	for ( int b = 0 ; b < GeneradorTerreno::NUM_BORDES ; ++b )
+	{
+		parche.pasoVecinosIndices[b] = 1;
+	}
+}
 
-				nTrig++;
-			}
-		}
+void
+SolNode::LiberarParche(int i)
+{
+	delete [] parches[i].vertices;
+	delete [] parches[i].indices;
+	parches[i].vertices = NULL;
+	parches[i].indices = NULL;
+	parches[i].buffer.Liberar();
+}
 
-		// -------------------------------------------------------------------
-		// Calculamos las normales
-		// -------------------------------------------------------------------
-		for ( int i = 0 ; i < nTrig ; ++i )
-		{
-			core::triangle3df t;
-			t.set(
-				vertices[ indices[i*3 + 0] ].Pos,
-				vertices[ indices[i*3 + 1] ].Pos,
-				vertices[ indices[i*3 + 2] ].Pos);
+// Las filas del terreno de un SolNode, para el exportador
+class FuenteSolNode : public FuenteAlturas
+{
+private:
+	const SolNode &nodo;
 
-			core::vector3df n = -t.getNormal();
+public:
+	FuenteSolNode(const SolNode &nodo) : nodo(nodo)
+	{
+	}
 
-			vertices[indices[i*3 + 0]].Normal += n ;
-			vertices[indices[i*3 + 1]].Normal += n ;
-			vertices[indices[i*3 + 2]].Normal += n ;
-		}
+	virtual int GetAncho() const
+	{
+		return nodo.GetAncho();
+	}
 
-		for ( int i = 0 ; i < W*H ; ++i )
-		{
-			vertices[i].Normal.normalize();
-		}
+	virtual int GetAlto() const
+	{
+		return nodo.GetAlto();
+	}
 
-		// -------------------------------------------------------------------
-		// Calculamos el valor alpha (mapea la hierba)
-		// -------------------------------------------------------------------
-		for ( int i = 0 ; i < W*H ; ++i )
-		{
-			float ny;
-			ny = vertices[i].Normal.Y ;
-			//vertices[i].Color = video::SColor(255, 128*(1.0-ny), 255-128*(1.0-ny), 128*(1.0-ny));
-			vertices[i].Color = video::SColor(255*ny, 255, 255, 255);
-			//vertices[i].Color = video::SColor(255, 255, 255, 255);
-		}
+	virtual void LeerFila(int y, float *fila) const
+	{
+		nodo.LeerFilaAlturas(y, fila);
+	}
+};
 
+void
+SolNode::LeerFilaAlturas(int y, float *fila) const
+{
+	if ( lector )
+	{
+		lector->LeerVentana(fila, 0, y, W, 1);
+		return;
+	}
 
-		// -------------------------------------------------------------------
-		// Calculamos el bounding box
-		// -------------------------------------------------------------------
-		box.reset(vertices[0].Pos);
-		for (s32 i=0; i< W*H ; ++i)
+	// La fila compartida entre dos parches se lee del de abajo, y la columna
+	// compartida del de la izquierda
+	int celdas = TAM_PARCHE-1;
+	int py = core::min_(y / celdas, parchesY-1);
+	int j = y - py*celdas;
+	for ( int px = 0 ; px < parchesX ; ++px )
+	{
+		const ParcheTerreno &parche = parches[py*parchesX + px];
+		const video::S3DVertex *v = &parche.vertices[j*parche.ancho];
+		for ( int i = 0 ; i < parche.ancho ; ++i )
 		{
-			box.addInternalPoint(vertices[i].Pos);
+			fila[px*celdas + i] = v[i].Pos.Y;
 		}
 	}
+}
+
+bool
+SolNode::ExportarAlturas(const char *fichero)
+{
+	FuenteSolNode fuente(*this);
+	return ExportadorAlturas::Exportar(fichero, ExportadorAlturas::FormatoDeFichero(fichero), fuente,
+		SceneManager->getVideoDriver());
+}
 
 SolNode::~SolNode(void)
 {
+	// Si vienen de la cache los vertices e indices son del fichero mapeado
+	if ( archivo == NULL )
+	{
+		for ( int i = 0 ; i < numParches ; ++i )
+		{
+			LiberarParche(i);
+		}
+	}
+	delete archivo;
+	delete lector;
+	delete [] parches;
 }
 
 void 
@@ -225,11 +439,181 @@ SolNode::OnPreRender()
 	ISceneNode::OnPreRender();
 }
 
+static inline f32
+Acotar(f32 valor, f32 minimo, f32 maximo)
+{
+	return core::min_(core::max_(valor, minimo), maximo);
+}
+
+void
+SolNode::ActualizarLOD()
+{
+	scene::ICameraSceneNode *camara = SceneManager->getActiveCamera();
+	frame++;
+
+	// Posicion de la camara en coordenadas del terreno
+	core::vector3df ojo;
+	core::matrix4 inversa;
+	bool hayOjo = camara && AbsoluteTransformation.getInverse(inversa);
+	if ( hayOjo )
+	{
+		ojo = camara->getAbsolutePosition();
+		inversa.transformVect(ojo);
+	}
+
+	core::aabbox3d<f32> vista;
+	if ( camara )
+	{
+		vista = camara->getViewFrustrum()->getBoundingBox();
+	}
+
+	// Nivel de cada parche segun la distancia
+	int total = 0;
+	for ( int i = 0 ; i < numParches ; ++i )
+	{
+		ParcheTerreno &parche = parches[i];
+
+		parche.visible = true;
+		if ( camara && numParches > 1 )
+		{
+			core::aabbox3d<f32> caja = parche.box;
+			AbsoluteTransformation.transformBoxEx(caja);
+			parche.visible = caja.intersectsWithBox(vista);
+		}
+
+		if ( lector )
+		{
+			if ( parche.visible )
+			{
+				if ( parche.vertices == NULL )
+				{
+					CargarParcheMosaico(i);
+				}
+				parche.ultimoFrame = frame;
+			}
+			else if ( parche.vertices && frame - parche.ultimoFrame > FRAMES_DESCARGA )
+			{
+				LiberarParche(i);
+			}
+		}
+
+		parche.nivel = 0;
+		parche.distancia = 0.0f;
+		if ( lod && hayOjo )
+		{
+			// Distancia al punto de la caja mas cercano
+			core::vector3df cercano(
+				Acotar(ojo.X, parche.box.MinEdge.X, parche.box.MaxEdge.X),
+				Acotar(ojo.Y, parche.box.MinEdge.Y, parche.box.MaxEdge.Y),
+				Acotar(ojo.Z, parche.box.MinEdge.Z, parche.box.MaxEdge.Z));
+			parche.distancia = (f32)ojo.getDistanceFrom(cercano);
+
+			f32 limite = distanciaLOD;
+			while ( parche.nivel < parche.nivelMaximo && parche.distancia > limite )
+			{
+				parche.nivel++;
+				limite *= 2.0f;
+			}
+		}
+
+		if ( parche.visible )
+		{
+			int paso = 1 << parche.nivel;
+			total += ((parche.ancho-1)/paso) * ((parche.alto-1)/paso) * 2;
+		}
+	}
+
+	// Ajustamos al presupuesto bajando de nivel los parches mas lejanos
+	while ( lod && presupuestoTriangulos > 0 && total > presupuestoTriangulos )
+	{
+		int elegido = -1;
+		for ( int i = 0 ; i < numParches ; ++i )
+		{
+			if ( parches[i].visible && parches[i].nivel < parches[i].nivelMaximo &&
+				(elegido < 0 || parches[i].distancia > parches[elegido].distancia) )
+			{
+				elegido = i;
+			}
+		}
+		if ( elegido < 0 )
+		{
+			break;
+		}
+
+		ParcheTerreno &parche = parches[elegido];
+		int paso = 1 << parche.nivel;
+		int antes = ((parche.ancho-1)/paso) * ((parche.alto-1)/paso) * 2;
+		parche.nivel++;
+		paso *= 2;
+		total -= antes - ((parche.ancho-1)/paso) * ((parche.alto-1)/paso) * 2;
+
+		// Para no volver a elegirlo antes que a otros igual de lejanos
+		parche.distancia *= 0.5f;
+	}
+
+	for ( int i = 0 ; i < numParches ; ++i )
+	{
+		if ( parches[i].visible )
+		{
+			ActualizarIndices(i);
+		}
+	}
+}
+
+void
+SolNode::ActualizarIndices(int i)
+{
+	ParcheTerreno &parche = parches[i];
+	int px = i % parchesX;
+	int py = i / parchesX;
+
+	// Paso de los vecinos; sin vecino el borde va con el paso propio
+	int paso = 1 << parche.nivel;
+	int pasoVecino[GeneradorTerreno::NUM_BORDES];
+	pasoVecino[GeneradorTerreno::BORDE_IZQUIERDO] = px > 0 ? 1 << parches[i-1].nivel : paso;
+	pasoVecino[GeneradorTerreno::BORDE_DERECHO] = px < parchesX-1 ? 1 << parches[i+1].nivel : paso;
+	pasoVecino[GeneradorTerreno::BORDE_INFERIOR] = py > 0 ? 1 << parches[i-parchesX].nivel : paso;
+	pasoVecino[GeneradorTerreno::BORDE_SUPERIOR] = py < parchesY-1 ? 1 << parches[i+parchesX].nivel : paso;
+
+	// Solo regeneramos los indices si ha cambiado algo
+	bool igual = parche.pasoIndices == paso;
+	for ( int b = 0 ; b < GeneradorTerreno::NUM_BORDES ; ++b )
+	{
+		igual = igual && parche.pasoVecinosIndices[b] == pasoVecino[b];
+	}
+	if ( igual )
+	{
+		return;
+	}
+
+	parche.numTriangulos = GeneradorTerreno::GenerarIndicesLOD(parche.indices, parche.ancho, parche.alto, paso, pasoVecino);
+	parche.buffer.MarcarIndices();
+	parche.pasoIndices = paso;
+	for ( int b = 0 ; b < GeneradorTerreno::NUM_BORDES ; ++b )
+	{
+		parche.pasoVecinosIndices[b] = pasoVecino[b];
+	}
+}
+
 void 
 SolNode::render()
 {
 	video::IVideoDriver* driver = SceneManager->getVideoDriver();
 	driver->setMaterial(material);
 	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
-	driver->drawIndexedTriangleList(&vertices[0], W*H, &indices[0], (W-1)*(H-1)*2);	
+
+	ActualizarLOD();
+
+	triangulosDibujados = 0;
+	for ( int i = 0 ; i < numParches ; ++i )
+	{
+		if ( !parches[i].visible )
+		{
+			continue;
+		}
+
+		parches[i].buffer.Dibujar(driver, parches[i].vertices, parches[i].numVertices,
+			parches[i].indices, parches[i].numTriangulos);
+		triangulosDibujados += parches[i].numTriangulos;
+	}
 }
@@ -1,24 +1,158 @@
 #pragma once
 #include <irrlicht.h>
 
+#include "BufferEstatico.h"
+
+class GeneradorTerreno;
+class Aleatorio;
+class ArchivoMapeado;
+class ClaveCache;
+class LectorMosaico;
+
 class SolNode :
 	public irr::scene::ISceneNode
 {
 private:
+	// Trozo del terreno que cabe en indices de 16 bits. Los parches vecinos
+	// comparten la fila o columna de vertices del borde, asi que no hay grietas.
+	struct ParcheTerreno
+	{
+		irr::video::S3DVertex *vertices;
+		irr::u16 *indices;
+		int numVertices;
+		int numTriangulos;
+		irr::core::aabbox3d<irr::f32> box;
+
+		// Geomipmapping: el nivel n dibuja uno de cada 2^n vertices
+		int ancho;
+		int alto;
+		int nivel;
+		int nivelMaximo;
+		bool visible;
+		irr::f32 distancia;
+
+		// Configuracion con la que se generaron los indices actuales
+		int pasoIndices;
+		int pasoVecinosIndices[4];
+
+		// Ultimo frame en que se vio (para liberar los de un mosaico)
+		int ultimoFrame;
+
+		// Copia en la tarjeta; los indices se vuelven a subir al cambiar de
+		// nivel
+		BufferEstatico buffer;
+	};
+
 	irr::core::aabbox3d<irr::f32> box;
-	irr::video::S3DVertex *vertices;
 	irr::video::SMaterial material;
-	irr::u16 *indices ;
-	static const int W = 100;
-	static const int H = 100;
+	ParcheTerreno *parches;
+	int numParches;
+	int parchesX;
+	int parchesY;
+	int W;
+	int H;
+
+	// Fichero de la cache con los vertices e indices de los parches, o NULL
+	// si se generaron y son nuestros
+	ArchivoMapeado *archivo;
+
+	// Mapa por mosaicos del que se construyen los parches al verse, o NULL
+	LectorMosaico *lector;
+	int frame;
+
+	bool lod;
+	irr::f32 distanciaLOD;
+	int presupuestoTriangulos;
+	int triangulosDibujados;
+
+	void InicializarNodo();
+	void CrearParches();
+	void ConstruirParches(const GeneradorTerreno &generador);
+	bool CargarParches(const ClaveCache &clave, Aleatorio &aleatorio);
+	void GuardarParches(const ClaveCache &clave, const Aleatorio &aleatorio);
+	void CalcularCajas();
+	void CalcularCajasMosaico();
+	void CargarParcheMosaico(int parche);
+	void LiberarParche(int parche);
+	void ActualizarLOD();
+	void ActualizarIndices(int parche);
 
 public:
-	SolNode(irr::scene::ISceneNode* parent, irr::scene::ISceneManager* mgr, irr::s32 id, float radio);
+	// Vertices por lado de cada parche (128 celdas): 129*129 < 65536
+	static const int TAM_PARCHE = 129;
+
+	// Bultos del terreno
+	static const int NUM_BULTOS = 10;
+
+	// Frames que un parche de un mosaico sigue cargado sin verse
+	static const int FRAMES_DESCARGA = 300;
+
+	// ancho x alto vertices del terreno, sin limite de tamano.
+	// El terreno sale de aleatorio; numHilos: hilos para generarlo (<= 0
+	// utiliza todos los nucleos). Si ya esta en CacheMallas no se genera.
+	SolNode(irr::scene::ISceneNode* parent, irr::scene::ISceneManager* mgr, irr::s32 id, float radio,
+		Aleatorio &aleatorio, int ancho = 100, int alto = 100, int numHilos = 0);
+
+	// Terreno de un fichero de EscritorMosaico. Abrirlo no lee las alturas:
+	// cada parche se construye la primera vez que entra en la vista, solo
+	// con los mosaicos que cubre, y se libera si deja de verse un tiempo.
+	SolNode(irr::scene::ISceneNode* parent, irr::scene::ISceneManager* mgr, irr::s32 id, const char *ficheroMosaico);
+
+	// Terreno de ancho x alto vertices importado de un mapa de alturas (.raw,
+	// .pgm o imagen, ver ImportadorAlturas) con alturas de minimo a maximo,
+	// y con bultosDetalle bultos de aleatorio por encima. No usa CacheMallas.
+	SolNode(irr::scene::ISceneNode* parent, irr::scene::ISceneManager* mgr, irr::s32 id, const char *ficheroAlturas,
+		Aleatorio &aleatorio, int ancho, int alto, float minimo, float maximo,
+		int bultosDetalle = NUM_BULTOS, int numHilos = 0);
 	virtual ~SolNode(void);
 
 	virtual void OnPreRender();
 	virtual void render();
 
+	// Modo LOD por parches (geomipmapping). Cada parche baja un nivel de
+	// detalle cada vez que su distancia a la camara supera distancia*2^n
+	// (en unidades del terreno, antes de escalar el nodo). Si el total pasa
+	// del presupuesto de triangulos por frame (0 = sin limite), se bajan
+	// primero los parches mas lejanos. Un parche solo tiene los niveles
+	// cuyo paso divide sus celdas: los terrenos de 2^k+1 vertices por lado
+	// los tienen todos, y uno de 100x100 ninguno.
+	void SetLOD(bool activo, irr::f32 distancia = 2.56f, int presupuesto = 0)
+	{
+		lod = activo;
+		distanciaLOD = distancia;
+		presupuestoTriangulos = presupuesto;
+	}
+
+	bool GetLOD() const
+	{
+		return lod;
+	}
+
+	// Triangulos enviados en el ultimo frame
+	int GetTriangulosDibujados() const
+	{
+		return triangulosDibujados;
+	}
+
+	// Vertices por lado del terreno completo
+	int GetAncho() const
+	{
+		return W;
+	}
+
+	int GetAlto() const
+	{
+		return H;
+	}
+
+	// Alturas de la fila y del terreno (W floats), sacadas de los parches o
+	// del mosaico, sin reconstruir la rejilla completa
+	void LeerFilaAlturas(int y, float *fila) const;
+
+	// Exporta las alturas con ExportadorAlturas, en el formato que indique la
+	// extension (.raw, .pgm o .png)
+	bool ExportarAlturas(const char *fichero);
+
 	virtual const irr::core::aabbox3d<irr::f32>& getBoundingBox() const
 	{
 		return box;
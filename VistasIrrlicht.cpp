@@ -0,0 +1,173 @@
+#include "VistasIrrlicht.h"
+
+#include "Juego.h"
+#include "PlanetaNode.h"
+#include "DisparoNode.h"
+#include "PoolNodosDisparo.h"
+#include "SolNode.h"
+#include "Aleatorio.h"
+
+using namespace irr;
+
+VistaPlanetaIrrlicht::VistaPlanetaIrrlicht(Aleatorio &aleatorio)
+{
+	nodo = new PlanetaNode(
+		Juego::GetInstance()->GetSceneManager()->getRootSceneNode(), 
+		Juego::GetInstance()->GetSceneManager(), 
+		0, 
+		core::vector3df::vector3d(),
+		aleatorio,
+		NULL,
+		Juego::GetInstance()->GetMallaCubo() ? PlanetaNode::MALLA_CUBO : PlanetaNode::MALLA_UV);
+
+	nodo->setRotation(core::vector3df(30.0f, 0.0f, 90.0f));
+	nodo->setScale(core::vector3df(2.0,2.0,2.0));
+	nodo->SetAlturaMar(0.5f);
+
+	scene::ISceneNodeAnimator* anim = 
+		Juego::GetInstance()->GetSceneManager()->createRotationAnimator(core::vector3df(0.0f, -0.2f, 0.0f));
+
+	nodo->addAnimator(anim);
+
+	anim->drop();
+}
+
+VistaPlanetaIrrlicht::~VistaPlanetaIrrlicht(void)
+{
+	nodo->remove();
+	nodo->drop();
+}
+
+void
+VistaPlanetaIrrlicht::SetPosicion(core::vector3df pos)
+{
+	nodo->setPosition(pos);
+}
+
+void
+VistaPlanetaIrrlicht::SetAlturaMar(float agua)
+{
+	nodo->SetAlturaMar(agua);
+}
+
+void
+VistaPlanetaIrrlicht::SetColorTerreno(video::SColor c)
+{
+	nodo->SetColorTerreno(c);
+}
+
+void
+VistaPlanetaIrrlicht::SetColorAtmosfera(video::SColor c)
+{
+	nodo->SetColorAtmosfera(c);
+}
+
+void
+VistaPlanetaIrrlicht::Actualizar()
+{
+	nodo->Actualizar();
+}
+
+void
+VistaPlanetaIrrlicht::Interpolar(float alpha)
+{
+	nodo->Interpolar(alpha);
+}
+
+VistaDiosIrrlicht::VistaDiosIrrlicht(core::vector3df pos, bool izquierda)
+{
+	video::SMaterial material;
+	material.Texture1 = Juego::GetInstance()->GetVideoDriver()->getTexture("data/faerie2.bmp");
+	material.Lighting = true;
+
+	scene::IAnimatedMesh* faerie = Juego::GetInstance()->GetSceneManager()->getMesh("data/faerie.md2");
+
+	nodo = Juego::GetInstance()->GetSceneManager()->addAnimatedMeshSceneNode(faerie);
+	nodo->setPosition(pos);
+	float sc=0.15f;
+	nodo->setScale(core::vector3df(sc, sc, sc));
+	if(izquierda)
+		nodo->setRotation(core::vector3df(0.0, -90.0f, -90.0));
+	else
+		nodo->setRotation(core::vector3df(0.0, 90.0f, -90.0));
+	nodo->getMaterial(0) = material;
+	//nodo->setMD2Animation(scene::EMAT_STAND);
+	nodo->setFrameLoop(1, 300);
+	nodo->setAnimationSpeed(80);
+}
+
+VistaDiosIrrlicht::~VistaDiosIrrlicht(void)
+{
+	nodo->remove();
+}
+
+void
+VistaDiosIrrlicht::SetPosicion(core::vector3df pos)
+{
+	nodo->setPosition(pos);
+}
+
+VistaDisparoIrrlicht::VistaDisparoIrrlicht(PoolNodosDisparo &pool, core::vector3df pos, float radio, int tipo)
+{
+	nodo = pool.Obtener(tipo, radio, pos);
+}
+
+VistaDisparoIrrlicht::~VistaDisparoIrrlicht(void)
+{
+}
+
+void
+VistaDisparoIrrlicht::Destruir(bool mega)
+{
+	// El nodo sigue en la escena hasta que acaba la explosion y luego vuelve
+	// al pool
+	nodo->Destruir(mega);
+	delete this;
+}
+
+void
+VistaDisparoIrrlicht::SetPosicion(core::vector3df pos)
+{
+	nodo->SetPosicion(pos);
+}
+
+FabricaVistasIrrlicht::FabricaVistasIrrlicht(void)
+{
+	disparos = new PoolNodosDisparo(Juego::GetInstance()->GetSceneManager());
+}
+
+FabricaVistasIrrlicht::~FabricaVistasIrrlicht(void)
+{
+	delete disparos;
+}
+
+VistaPlaneta *
+FabricaVistasIrrlicht::CrearPlaneta(Aleatorio &aleatorio)
+{
+	return new VistaPlanetaIrrlicht(aleatorio);
+}
+
+VistaDios *
+FabricaVistasIrrlicht::CrearDios(core::vector3df pos, bool izquierda)
+{
+	return new VistaDiosIrrlicht(pos, izquierda);
+}
+
+VistaDisparo *
+FabricaVistasIrrlicht::CrearDisparo(core::vector3df pos, float radio, int tipo)
+{
+	return new VistaDisparoIrrlicht(*disparos, pos, radio, tipo);
+}
+
+void
+FabricaVistasIrrlicht::CrearSol(Aleatorio &aleatorio)
+{
+	// La escena se queda con el nodo
+	SolNode *nodo = new SolNode(
+		Juego::GetInstance()->GetSceneManager()->getRootSceneNode(),
+		Juego::GetInstance()->GetSceneManager(),
+		0,
+		1.0f,
+		aleatorio);
+	nodo->drop();
+}
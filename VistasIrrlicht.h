@@ -0,0 +1,76 @@
+#pragma once
+
+#include "VistasPartida.h"
+
+#include <irrlicht.h>
+using namespace irr;
+
+class PlanetaNode;
+class DisparoNode;
+class PoolNodosDisparo;
+
+// Las vistas de la partida con nodos de la escena de Juego
+
+class VistaPlanetaIrrlicht : public VistaPlaneta
+{
+private:
+	PlanetaNode *nodo;
+
+public:
+	VistaPlanetaIrrlicht(Aleatorio &aleatorio);
+	virtual ~VistaPlanetaIrrlicht(void);
+
+	virtual void SetPosicion(core::vector3df pos);
+	virtual void SetAlturaMar(float agua);
+	virtual void SetColorTerreno(video::SColor c);
+	virtual void SetColorAtmosfera(video::SColor c);
+	virtual void Actualizar();
+	virtual void Interpolar(float alpha);
+};
+
+class VistaDiosIrrlicht : public VistaDios
+{
+private:
+	scene::IAnimatedMeshSceneNode *nodo;
+
+public:
+	VistaDiosIrrlicht(core::vector3df pos, bool izquierda);
+	virtual ~VistaDiosIrrlicht(void);
+
+	virtual void SetPosicion(core::vector3df pos);
+};
+
+class VistaDisparoIrrlicht : public VistaDisparo
+{
+private:
+	DisparoNode *nodo;
+
+protected:
+	virtual ~VistaDisparoIrrlicht(void);
+
+public:
+	VistaDisparoIrrlicht(PoolNodosDisparo &pool, core::vector3df pos, float radio, int tipo);
+
+	virtual void Destruir(bool mega);
+	virtual void SetPosicion(core::vector3df pos);
+};
+
+class FabricaVistasIrrlicht : public FabricaVistas
+{
+private:
+	// Los nodos de los disparos de esta partida
+	PoolNodosDisparo *disparos;
+
+	// No se copia
+	FabricaVistasIrrlicht(const FabricaVistasIrrlicht &);
+	FabricaVistasIrrlicht &operator=(const FabricaVistasIrrlicht &);
+
+public:
+	FabricaVistasIrrlicht(void);
+	virtual ~FabricaVistasIrrlicht(void);
+
+	virtual VistaPlaneta *CrearPlaneta(Aleatorio &aleatorio);
+	virtual VistaDios *CrearDios(core::vector3df pos, bool izquierda);
+	virtual VistaDisparo *CrearDisparo(core::vector3df pos, float radio, int tipo);
+	virtual void CrearSol(Aleatorio &aleatorio);
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <irrlicht.h>
+using namespace irr;
+
+class Aleatorio;
+class Planeta;
+
+// Lo que se ve de cada objeto de una Simulacion. La logica (Planeta, Dios,
+// PoolDisparos, Sol) solo habla con estas interfaces, asi que la simulacion se
+// compila y se ejecuta sin Irrlicht ni ventana: sin FabricaVistas los
+// objetos no tienen vista. VistasIrrlicht las implementa con nodos de
+// escena.
+
+class VistaPlaneta
+{
+public:
+	virtual ~VistaPlaneta(void)
+	{
+	}
+
+	virtual void SetPosicion(core::vector3df pos) = 0;
+	virtual void SetAlturaMar(float agua) = 0;
+	virtual void SetColorTerreno(video::SColor c) = 0;
+	virtual void SetColorAtmosfera(video::SColor c) = 0;
+
+	// Un paso de la simulacion de lo que se anima solo (mar, atmosfera)
+	virtual void Actualizar() = 0;
+	virtual void Interpolar(float alpha) = 0;
+};
+
+class VistaDios
+{
+public:
+	virtual ~VistaDios(void)
+	{
+	}
+
+	virtual void SetPosicion(core::vector3df pos) = 0;
+};
+
+class VistaDisparo
+{
+public:
+	// Se borra sola al acabar su explosion
+	virtual void Destruir(bool mega) = 0;
+
+	virtual void SetPosicion(core::vector3df pos) = 0;
+
+protected:
+	virtual ~VistaDisparo(void)
+	{
+	}
+};
+
+class FabricaVistas
+{
+public:
+	virtual ~FabricaVistas(void)
+	{
+	}
+
+	virtual VistaPlaneta *CrearPlaneta(Aleatorio &aleatorio) = 0;
+	virtual VistaDios *CrearDios(core::vector3df pos, bool izquierda) = 0;
+	virtual VistaDisparo *CrearDisparo(core::vector3df pos, float radio, int tipo) = 0;
+
+	// El sol no cambia: su vista es solo de la fabrica
+	virtual void CrearSol(Aleatorio &aleatorio) = 0;
+};
+
+// Avisos de la simulacion a la pantalla que la muestra (camara, mensajes)
+class ObservadorSimulacion
+{
+public:
+	virtual ~ObservadorSimulacion(void)
+	{
+	}
+
+	// Un mega disparo va a dar en planeta (tipo del disparo)
+	virtual void MegaImpactoAnunciado(Planeta *planeta, int tipo) = 0;
+
+	// El mega disparo anunciado surte efecto
+	virtual void MegaImpactoProducido() = 0;
+
+	// Vuelta al juego normal tras una secuencia
+	virtual void FinSecuencia() = 0;
+
+	// resultado: Simulacion::RESULTADO
+	virtual void FinPartida(int resultado) = 0;
+};
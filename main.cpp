@@ -5,6 +5,9 @@
 #include <math.h>
 #include <time.h>
 #include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 using namespace irr;
 
@@ -27,12 +30,97 @@ ISceneNode class and has to override some methods.
 
 #include "Juego.h"
 
+static void
+Uso(const char *programa)
+{
+	printf("Uso: %s [-benchmark [frames]] [-semilla N] [-hz N] [-velocidad X]\n", programa);
+	printf("           [-fps N] [-malla uv|cubo]\n");
+}
+
 /*
 That's it. The Scene node is done. Now we simply have to start
 the engine, create the scene node and a camera, and look at the result.
 */
-int main()
+int main(int argc, char **argv)
 {
+	// -benchmark [frames]: compara el dibujado inmediato con BufferEstatico
+	// y los nodos de disparo creados cada vez con los de PoolNodosDisparo.
+	// Va primero; las demas opciones valen tambien con el.
+	bool benchmark = false;
+	int frames = 500;
+	int primera = 1;
+	if ( argc > 1 && strcmp(argv[1], "-benchmark") == 0 )
+	{
+		benchmark = true;
+		primera = 2;
+		if ( argc > 2 && argv[2][0] != '-' )
+		{
+			frames = atoi(argv[2]);
+			primera = 3;
+		}
+	}
+
+	// -hz N: pasos de simulacion por segundo; -velocidad X: segundos de
+	// juego por segundo real; -fps N: frames por segundo como mucho;
+	// -malla uv|cubo: malla de los planetas; -semilla N: semilla de la
+	// sesion (la hora por defecto)
+	float hz = (float)Juego::HZ_SIMULACION;
+	float velocidad = 1.0f;
+	float fps = 0.0f;
+	bool mallaCubo = false;
+	for ( int i = primera ; i < argc ; ++i )
+	{
+		if ( i+1 < argc && strcmp(argv[i], "-semilla") == 0 )
+		{
+			Juego::SetSemillaSesion(strtoull(argv[++i], NULL, 10));
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-hz") == 0 )
+		{
+			hz = (float)atof(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-velocidad") == 0 )
+		{
+			velocidad = (float)atof(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-fps") == 0 )
+		{
+			fps = (float)atof(argv[++i]);
+		}
+		else if ( i+1 < argc && strcmp(argv[i], "-malla") == 0 )
+		{
+			++i;
+			if ( strcmp(argv[i], "uv") != 0 && strcmp(argv[i], "cubo") != 0 )
+			{
+				printf("Malla desconocida: %s\n", argv[i]);
+				return 1;
+			}
+			mallaCubo = strcmp(argv[i], "cubo") == 0;
+		}
+		else
+		{
+			// Opcion desconocida, o sin su valor
+			Uso(argv[0]);
+			return 1;
+		}
+	}
+
+	// Sin pasos por segundo o sin tiempo de juego la simulacion no avanza
+	if ( !(hz > 0.0f) || !(velocidad > 0.0f) || !(fps >= 0.0f) || frames < 0 )
+	{
+		printf("Parametros fuera de rango\n");
+		return 1;
+	}
+
+	Juego::GetInstance()->SetFrecuenciaSimulacion(hz);
+	Juego::GetInstance()->SetEscalaTiempo(velocidad);
+	Juego::GetInstance()->SetFPSMaximos(fps);
+	Juego::GetInstance()->SetMallaCubo(mallaCubo);
+
+	if ( benchmark )
+	{
+		Juego::GetInstance()->Benchmark(frames);
+		return 0;
+	}
 	Juego::GetInstance()->Run();
 	return 0;
 }